@@ -0,0 +1,431 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# Copyright (c) 2019, German Aerospace Center (DLR)
+#
+# This file is part of the development version of FRASER.
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+#
+# Authors:
+# - 2019, Annika Ofenloch (DLR RY-AVS)
+
+"""Scaling benchmarks of a synthetic federation on one Linux host.
+
+  generate  Write a hosts-config file with N synthetic models
+            (models/synthetic_model) and a dependency topology:
+              chain       model i depends on model i-1
+              star        model 0 depends on all others, all others on 0
+              all-to-all  every model depends on every other model
+  run       Run every combination of the given model counts and topologies
+            and write the results to a JSON file (ticks/s, events/s,
+            latency percentiles and startup time per scenario)
+  compare   Print the ratios of the scenarios of two result files
+
+The simulation runs in the time-stepped mode as fast as possible (speed
+factor), every tick each model publishes PUBLISH-RATE events, every received
+event costs HANDLER-COST ns and is answered by FAN-OUT events. The latency is
+measured from publishing to receiving an event (monotonic clock).
+
+The models have to be built before (make build, or --build).
+"""
+
+import argparse
+import json
+import os
+import platform
+import shutil
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+import xml.etree.ElementTree as ET
+
+REPO_PATH = os.path.abspath(os.path.join(os.path.dirname(__file__), '..', '..'))
+MODELS = ['configuration_server', 'simulation_model', 'synthetic_model']
+TOPOLOGIES = ['chain', 'star', 'all-to-all']
+
+
+def binary(model):
+    return os.path.join(REPO_PATH, 'models', model, 'build', 'bin', model)
+
+
+def build():
+    idl_path = os.path.join(REPO_PATH, 'resources', 'idl')
+    subprocess.check_call(['flatc', '-o', idl_path, '--cpp',
+                           os.path.join(idl_path, 'configuration.fbs'),
+                           '--gen-mutable', '--gen-object-api'])
+    for model in MODELS:
+        model_path = os.path.join(REPO_PATH, 'models', model)
+        model_idl_path = os.path.join(model_path, 'resources', 'idl')
+        if model != 'configuration_server':
+            if not os.path.isdir(model_idl_path):
+                os.makedirs(model_idl_path)
+            subprocess.check_call(['flatc', '-o', model_idl_path, '--cpp',
+                                   os.path.join(idl_path, 'event.fbs'),
+                                   '--gen-mutable', '--gen-object-api'])
+        subprocess.check_call(['make', '-C', model_path,
+                               '-j%d' % (os.cpu_count() or 1)])
+
+
+def dependencies(index, num_models, topology):
+    others = [i for i in range(num_models) if i != index]
+    if topology == 'chain':
+        return [index - 1] if index > 0 else []
+    if topology == 'star':
+        return others if index == 0 else [0]
+    return others
+
+
+def generate(file_name, num_models, topology, parameters, min_port=6000):
+    root = ET.Element('root')
+    hosts = ET.SubElement(root, 'Hosts', minPort=str(min_port),
+                          maxPort=str(min_port + 2 * num_models + 16))
+    host = ET.SubElement(hosts, 'Host', id='host_0')
+    ET.SubElement(host, 'Description').text = 'Benchmark host'
+    ET.SubElement(host, 'Address').text = 'localhost'
+
+    models = ET.SubElement(root, 'Models', configPath='configuration',
+                           logLevel='error', statsInterval='0')
+    for model_id, persist in [('configuration_server', None),
+                              ('simulation_model', 'true')]:
+        model = ET.SubElement(models, 'Model', id=model_id,
+                              path='../models/' + model_id)
+        if persist:
+            model.set('persist', persist)
+        ET.SubElement(model, 'HostReference', hostID='host_0')
+
+    for index in range(num_models):
+        model = ET.SubElement(models, 'Model', id='synthetic_%d' % index,
+                              path='../models/synthetic_model')
+        ET.SubElement(model, 'HostReference', hostID='host_0')
+        references = dependencies(index, num_models, topology)
+        if references:
+            element = ET.SubElement(model, 'Dependencies')
+            for reference in references:
+                ET.SubElement(element, 'ModelReference',
+                              modelID='synthetic_%d' % reference)
+        for name in sorted(parameters):
+            ET.SubElement(model, 'Parameter', name=name,
+                          value=str(parameters[name]))
+
+    indent(root)
+    ET.ElementTree(root).write(file_name, xml_declaration=True,
+                               encoding='utf-8')
+
+
+def indent(element, level=0):
+    padding = '\n' + '\t' * level
+    if len(element):
+        element.text = padding + '\t'
+        for child in element:
+            indent(child, level + 1)
+        child.tail = padding
+    if level and not (element.tail or '').strip():
+        element.tail = padding
+
+
+class Federation(object):
+    """Processes of one simulation run (stopped in reverse order)."""
+
+    def __init__(self, work_path):
+        self.work_path = work_path
+        self.processes = []
+
+    def start(self, name, arguments):
+        log = open(os.path.join(self.work_path, name + '.log'), 'a')
+        process = subprocess.Popen(arguments, cwd=self.work_path,
+                                   stdout=log, stderr=subprocess.STDOUT)
+        self.processes.append(process)
+        return process
+
+    def stop(self, timeout):
+        deadline = time.time() + timeout
+        for process in reversed(self.processes):
+            if process.poll() is None:
+                try:
+                    process.wait(max(0.1, deadline - time.time()))
+                except subprocess.TimeoutExpired:
+                    process.send_signal(signal.SIGINT)
+        for process in self.processes:
+            try:
+                process.wait(5)
+            except subprocess.TimeoutExpired:
+                process.kill()
+        self.processes = []
+
+
+def run_federation(work_path, config_file, num_models, sim_arguments,
+                   timeout):
+    federation = Federation(work_path)
+    try:
+        federation.start('configuration_server', [
+            binary('configuration_server'), '--config-file', config_file])
+        time.sleep(0.5)
+
+        launched = time.monotonic()
+        for index in range(num_models):
+            federation.start('synthetic_%d' % index, [
+                binary('synthetic_model'), '-n', 'synthetic_%d' % index])
+        simulation = federation.start(
+            'simulation_model', [binary('simulation_model')] + sim_arguments)
+
+        try:
+            simulation.wait(timeout)
+        except subprocess.TimeoutExpired:
+            sys.stderr.write('Timeout, see the logs in %s\n' % work_path)
+            return None
+        return launched
+    finally:
+        # The configuration server does not stop by itself
+        if federation.processes:
+            federation.processes[0].send_signal(signal.SIGINT)
+        federation.stop(5)
+
+
+def merge_latencies(results):
+    buckets = {}
+    for result in results:
+        for upper_bound, count in result['latency']['buckets']:
+            buckets[upper_bound] = buckets.get(upper_bound, 0) + count
+    return sorted(buckets.items())
+
+
+def percentile(buckets, percent):
+    total = sum(count for _, count in buckets)
+    if total == 0:
+        return 0
+    rank = max(1, int(percent / 100.0 * total + 0.5))
+    seen = 0
+    for upper_bound, count in buckets:
+        seen += count
+        if seen >= rank:
+            return upper_bound
+    return buckets[-1][0]
+
+
+def evaluate(results, launched):
+    ticks = min(r['ticks'] for r in results)
+    begin = min(r['first_tick_ns'] for r in results if r['ticks'] > 0)
+    end = max(r['last_tick_ns'] for r in results)
+    duration = max(end - begin, 1) / 1e9
+    received = sum(r['received'] for r in results)
+    buckets = merge_latencies(results)
+    count = sum(c for _, c in buckets)
+    return {
+        'ticks': ticks,
+        'duration_s': round(duration, 6),
+        'startup_s': round(max(r['ready_ns'] for r in results) / 1e9
+                           - launched, 6),
+        'ticks_per_s': round(max(ticks - 1, 0) / duration, 1),
+        'events_per_s': round(received / duration, 1),
+        'published': sum(r['published'] for r in results),
+        'received': received,
+        'received_bytes': sum(r['received_bytes'] for r in results),
+        'latency_us': {
+            'mean': round(sum(r['latency']['sum_ns'] for r in results)
+                          / max(count, 1) / 1e3, 3),
+            'p50': percentile(buckets, 50) / 1e3,
+            'p90': percentile(buckets, 90) / 1e3,
+            'p99': percentile(buckets, 99) / 1e3,
+            'max': max(r['latency']['max_ns'] for r in results) / 1e3}}
+
+
+def run_scenario(work_path, num_models, topology, args):
+    results_path = os.path.join(work_path, 'results') + os.sep
+    config_path = os.path.join(work_path, 'configuration') + os.sep
+    for path in [results_path, config_path]:
+        os.makedirs(path)
+
+    parameters = {'handlerCost': args.handler_cost, 'fanOut': args.fan_out,
+                  'payloadSize': args.payload_size,
+                  'publishRate': args.publish_rate,
+                  'resultsPath': results_path}
+    config_file = os.path.join(work_path, 'hosts-config.xml')
+    generate(config_file, num_models, topology, parameters, args.min_port)
+
+    overrides = ['--mode', 'time-stepped',
+                 '--sim-time', str(args.ticks * args.sim_time_step),
+                 '--sim-time-step', str(args.sim_time_step),
+                 '--speed-factor', str(args.speed_factor)]
+
+    # Configuration file of the simulation model (same as make
+    # create-default-configs)
+    if run_federation(work_path, config_file, num_models,
+                      ['--create-config-files', config_path] + overrides,
+                      args.timeout) is None:
+        return None
+    for file_name in os.listdir(results_path):
+        os.remove(os.path.join(results_path, file_name))
+
+    launched = run_federation(work_path, config_file, num_models,
+                              ['--load-config', config_path] + overrides,
+                              args.timeout)
+    if launched is None:
+        return None
+
+    results = []
+    for index in range(num_models):
+        file_name = os.path.join(results_path, 'synthetic_%d.json' % index)
+        if not os.path.exists(file_name):
+            sys.stderr.write('No results of synthetic_%d (see %s)\n'
+                             % (index, work_path))
+            return None
+        with open(file_name) as result_file:
+            results.append(json.load(result_file))
+    return evaluate(results, launched)
+
+
+def git_commit():
+    try:
+        return subprocess.check_output(
+            ['git', 'rev-parse', '--short', 'HEAD'], cwd=REPO_PATH,
+            stderr=subprocess.DEVNULL).decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        return ''
+
+
+def run(args):
+    if args.build:
+        build()
+    for model in MODELS:
+        if not os.access(binary(model), os.X_OK):
+            sys.exit('%s is not built (make build or --build)' % model)
+
+    report = {
+        'version': 1,
+        'machine': {'hostname': platform.node(), 'cpus': os.cpu_count(),
+                    'platform': platform.platform(), 'commit': git_commit()},
+        'settings': {'ticks': args.ticks, 'simTimeStep': args.sim_time_step,
+                     'speedFactor': args.speed_factor,
+                     'handlerCost': args.handler_cost,
+                     'fanOut': args.fan_out,
+                     'payloadSize': args.payload_size,
+                     'publishRate': args.publish_rate},
+        'scenarios': []}
+
+    for topology in args.topology:
+        for num_models in args.models:
+            name = '%s-%d' % (topology, num_models)
+            work_path = tempfile.mkdtemp(prefix='fraser-bench-%s-' % name)
+            print('%-20s ...' % name, end='', flush=True)
+
+            result = run_scenario(work_path, num_models, topology, args)
+            if result is None:
+                print(' failed')
+                continue
+            if not args.keep:
+                shutil.rmtree(work_path)
+
+            result.update({'name': name, 'topology': topology,
+                           'models': num_models})
+            report['scenarios'].append(result)
+            print(' %10.1f ticks/s %12.1f events/s  p50 %8.1f us  p99 %8.1f '
+                  'us  startup %.2f s' % (
+                      result['ticks_per_s'], result['events_per_s'],
+                      result['latency_us']['p50'],
+                      result['latency_us']['p99'], result['startup_s']))
+
+    with open(args.output, 'w') as output:
+        json.dump(report, output, indent=2, sort_keys=True)
+    print('Results written to %s' % args.output)
+
+
+def compare(args):
+    with open(args.baseline) as baseline_file:
+        baseline = json.load(baseline_file)
+    with open(args.current) as current_file:
+        current = json.load(current_file)
+
+    if baseline['settings'] != current['settings']:
+        print('Warning: The settings of the benchmarks differ')
+
+    scenarios = dict((s['name'], s) for s in baseline['scenarios'])
+    print('%-20s %12s %12s %12s %12s' % (
+        'scenario', 'ticks/s', 'events/s', 'p50', 'p99'))
+    for scenario in current['scenarios']:
+        base = scenarios.get(scenario['name'])
+        if base is None:
+            continue
+        ratios = []
+        for value, base_value in [
+                (scenario['ticks_per_s'], base['ticks_per_s']),
+                (scenario['events_per_s'], base['events_per_s']),
+                (scenario['latency_us']['p50'], base['latency_us']['p50']),
+                (scenario['latency_us']['p99'], base['latency_us']['p99'])]:
+            ratios.append('%11.2fx' % (value / base_value)
+                          if base_value else '%12s' % '-')
+        print('%-20s %s' % (scenario['name'], ' '.join(ratios)))
+
+
+def add_parameters(parser):
+    parser.add_argument('--handler-cost', type=int, default=0,
+                        help='busy time per received event in ns')
+    parser.add_argument('--fan-out', type=int, default=0,
+                        help='events published per received event')
+    parser.add_argument('--payload-size', type=int, default=64,
+                        help='bytes of the event data')
+    parser.add_argument('--publish-rate', type=int, default=1,
+                        help='events published per tick and model')
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawTextHelpFormatter)
+    subparsers = parser.add_subparsers(dest='command')
+    subparsers.required = True
+
+    generate_parser = subparsers.add_parser('generate')
+    generate_parser.add_argument('-o', '--output', required=True,
+                                 help='hosts-config file')
+    generate_parser.add_argument('--models', type=int, default=4)
+    generate_parser.add_argument('--topology', choices=TOPOLOGIES,
+                                 default='chain')
+    generate_parser.add_argument('--results-path', default='',
+                                 help='folder of the result files')
+    generate_parser.add_argument('--min-port', type=int, default=6000)
+    add_parameters(generate_parser)
+
+    run_parser = subparsers.add_parser('run')
+    run_parser.add_argument('-o', '--output', default='federation.json',
+                            help='result file (default: %(default)s)')
+    run_parser.add_argument('--models', type=int, nargs='+',
+                            default=[2, 4, 8])
+    run_parser.add_argument('--topology', choices=TOPOLOGIES, nargs='+',
+                            default=TOPOLOGIES)
+    run_parser.add_argument('--ticks', type=int, default=1000)
+    run_parser.add_argument('--sim-time-step', type=int, default=100)
+    run_parser.add_argument('--speed-factor', type=float, default=1e9,
+                            help='default: no wait time between the ticks')
+    run_parser.add_argument('--timeout', type=float, default=300,
+                            help='seconds per simulation run')
+    run_parser.add_argument('--min-port', type=int, default=6000)
+    run_parser.add_argument('--build', action='store_true',
+                            help='generate the flatbuffers and build the '
+                            'models before')
+    run_parser.add_argument('--keep', action='store_true',
+                            help='keep the working folders (logs)')
+    add_parameters(run_parser)
+
+    compare_parser = subparsers.add_parser('compare')
+    compare_parser.add_argument('baseline')
+    compare_parser.add_argument('current')
+
+    args = parser.parse_args()
+    if args.command == 'generate':
+        generate(args.output, args.models, args.topology, {
+            'handlerCost': args.handler_cost, 'fanOut': args.fan_out,
+            'payloadSize': args.payload_size,
+            'publishRate': args.publish_rate,
+            'resultsPath': args.results_path}, args.min_port)
+    elif args.command == 'run':
+        run(args)
+    else:
+        compare(args)
+
+
+if __name__ == '__main__':
+    main()
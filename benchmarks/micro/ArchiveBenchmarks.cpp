@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/xml_iarchive.hpp>
+#include <boost/archive/xml_oarchive.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include "Benchmark.h"
+#include "data-types/Event.h"
+#include "data-types/EventSet.h"
+#include "data-types/Field.h"
+#include "reflection/FieldRegistry.h"
+
+// Savepoints (XML archives) and snapshots of the time warp engine (binary
+// archives) of the event set of the event queue and of the fields of a
+// model (boost archives and FieldRegistry): one iteration is a round trip
+// (serializing and deserializing the whole set)
+namespace
+{
+// Fields of the simulation model
+struct ModelFields
+{
+	Field<uint64_t> simTime
+	{ "SimTime", 5000 };
+	Field<uint32_t> simTimeStep
+	{ "SimTimeStep", 100 };
+	Field<uint64_t> currentSimTime
+	{ "CurrentSimTime", 1200 };
+	Field<double> speedFactor
+	{ "SpeedFactor", 1.0 };
+	Field<bool> conservativeMode
+	{ "ConservativeMode", false };
+	Field<bool> optimisticMode
+	{ "OptimisticMode", true };
+	FieldRegistry fields
+	{ simTime, simTimeStep, currentSimTime, speedFactor, conservativeMode,
+			optimisticMode };
+};
+
+// Hand-written serialize of the models (before the registry)
+struct HandWrittenFields: ModelFields
+{
+	template<typename Archive>
+	void serialize(Archive& archive, const unsigned int)
+	{
+		archive & boost::serialization::make_nvp("SimTime", simTime);
+		archive & boost::serialization::make_nvp("SimTimeStep", simTimeStep);
+		archive
+				& boost::serialization::make_nvp("CurrentSimTime",
+						currentSimTime);
+		archive & boost::serialization::make_nvp("SpeedFactor", speedFactor);
+		archive
+				& boost::serialization::make_nvp("ConservativeMode",
+						conservativeMode);
+		archive
+				& boost::serialization::make_nvp("OptimisticMode",
+						optimisticMode);
+	}
+};
+
+struct RegisteredFields: ModelFields
+{
+	template<typename Archive>
+	void serialize(Archive& archive, const unsigned int)
+	{
+		fields.serialize(archive);
+	}
+};
+
+EventSet createEventSet(size_t size)
+{
+	EventSet eventSet;
+	eventSet.reserve(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		eventSet.push_back(
+				Event("Event_" + std::to_string(i % 16), i * 100, 100, -1,
+						Priority::NORMAL_PRIORITY));
+	}
+	return eventSet;
+}
+
+template<typename OArchive, typename IArchive, typename Data>
+uint64_t roundTrip(const char* name, const Data& source, Data& restored,
+		uint64_t iterations)
+{
+	uint64_t bytes = 0;
+	for (uint64_t i = 0; i < iterations; i++)
+	{
+		std::ostringstream oss;
+		{
+			OArchive oa(oss, boost::archive::no_header);
+			oa << boost::serialization::make_nvp(name, source);
+		}
+		std::string data = oss.str();
+		bytes += data.size();
+
+		std::istringstream iss(data);
+		{
+			IArchive ia(iss, boost::archive::no_header);
+			ia >> boost::serialization::make_nvp(name, restored);
+		}
+		micro::keep(restored);
+	}
+	return bytes;
+}
+
+template<typename OArchive, typename IArchive>
+uint64_t roundTrip(const EventSet& eventSet, uint64_t iterations)
+{
+	EventSet restored;
+	return roundTrip<OArchive, IArchive>("EventSet", eventSet, restored,
+			iterations);
+}
+
+// Snapshot of the time warp engine (see Model1::takeSnapshot)
+BENCHMARK("archive/fields_registry_binary_round_trip", [](uint64_t iterations)
+{
+	ModelFields source;
+	ModelFields restored;
+	uint64_t bytes = 0;
+	for (uint64_t i = 0; i < iterations; i++)
+	{
+		std::string data;
+		source.fields.writeBinary(data);
+		bytes += data.size();
+
+		restored.fields.readBinary(data.data(), data.size());
+		micro::keep(restored);
+	}
+	return bytes;
+});
+
+BENCHMARK("archive/fields_boost_binary_round_trip", [](uint64_t iterations)
+{
+	HandWrittenFields source;
+	HandWrittenFields restored;
+	return roundTrip<boost::archive::binary_oarchive,
+	boost::archive::binary_iarchive>("FieldSet", source, restored,
+			iterations);
+});
+
+// Savepoint files
+BENCHMARK("archive/fields_registry_xml_round_trip", [](uint64_t iterations)
+{
+	RegisteredFields source;
+	RegisteredFields restored;
+	return roundTrip<boost::archive::xml_oarchive,
+	boost::archive::xml_iarchive>("FieldSet", source, restored,
+			iterations);
+});
+
+BENCHMARK("archive/fields_boost_xml_round_trip", [](uint64_t iterations)
+{
+	HandWrittenFields source;
+	HandWrittenFields restored;
+	return roundTrip<boost::archive::xml_oarchive,
+	boost::archive::xml_iarchive>("FieldSet", source, restored,
+			iterations);
+});
+
+void registerArchiveBenchmarks()
+{
+	for (size_t size : { size_t(16), size_t(256), size_t(4096) })
+	{
+		std::string suffix = "/" + std::to_string(size);
+		auto eventSet = std::make_shared<EventSet>(createEventSet(size));
+
+		micro::Registration("archive/xml_round_trip" + suffix,
+				[eventSet](uint64_t iterations)
+				{
+					return roundTrip<boost::archive::xml_oarchive,
+					boost::archive::xml_iarchive>(*eventSet, iterations);
+				});
+
+		micro::Registration("archive/binary_round_trip" + suffix,
+				[eventSet](uint64_t iterations)
+				{
+					return roundTrip<boost::archive::binary_oarchive,
+					boost::archive::binary_iarchive>(*eventSet, iterations);
+				});
+	}
+}
+
+bool registered = (registerArchiveBenchmarks(), true);
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef MICRO_BENCHMARK_H_
+#define MICRO_BENCHMARK_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Minimal benchmark registry of the micro benchmarks (no external
+// dependencies). A benchmark runs a function with a number of iterations
+// and returns the number of processed bytes (0 if not applicable). The
+// iterations are doubled until a batch takes at least the minimum time,
+// the result is the median of the repetitions.
+namespace micro
+{
+
+typedef std::function<uint64_t(uint64_t iterations)> Function;
+
+struct Result
+{
+	std::string name;
+	uint64_t iterations;
+	double nsPerOp; // Median of the repetitions
+	double minNsPerOp;
+	double maxNsPerOp;
+	double bytesPerOp;
+};
+
+inline std::vector<std::pair<std::string, Function>>& getRegistry()
+{
+	static std::vector<std::pair<std::string, Function>> registry;
+	return registry;
+}
+
+// Registers a benchmark during the static initialization
+struct Registration
+{
+	Registration(const std::string& name, Function function)
+	{
+		getRegistry().emplace_back(name, function);
+	}
+};
+
+// Prevents that the compiler removes the computation of the value
+template<typename T>
+inline void keep(const T& value)
+{
+	asm volatile("" : : "g"(&value) : "memory");
+}
+
+inline double measureBatch(const Function& function, uint64_t iterations,
+		uint64_t& bytes)
+{
+	auto begin = std::chrono::steady_clock::now();
+	bytes = function(iterations);
+	auto end = std::chrono::steady_clock::now();
+	return double(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+}
+
+inline Result run(const std::string& name, const Function& function,
+		double minTimeNs, unsigned repetitions)
+{
+	// Warm-up and calibration of the iterations
+	uint64_t iterations = 1;
+	uint64_t bytes = 0;
+	while (measureBatch(function, iterations, bytes) < minTimeNs
+			&& iterations < (uint64_t(1) << 40))
+	{
+		iterations *= 2;
+	}
+
+	std::vector<double> nsPerOp;
+	for (unsigned i = 0; i < std::max(repetitions, 1u); i++)
+	{
+		nsPerOp.push_back(
+				measureBatch(function, iterations, bytes) / double(iterations));
+	}
+	std::sort(nsPerOp.begin(), nsPerOp.end());
+
+	Result result;
+	result.name = name;
+	result.iterations = iterations;
+	result.nsPerOp = nsPerOp[nsPerOp.size() / 2];
+	result.minNsPerOp = nsPerOp.front();
+	result.maxNsPerOp = nsPerOp.back();
+	result.bytesPerOp = double(bytes) / double(iterations);
+	return result;
+}
+
+}
+
+#define MICRO_CONCAT_(a, b) a##b
+#define MICRO_CONCAT(a, b) MICRO_CONCAT_(a, b)
+
+// BENCHMARK("group/name", [](uint64_t iterations) { ...; return bytes; });
+#define BENCHMARK(name, ...) \
+	static micro::Registration MICRO_CONCAT(benchmark_, __LINE__)(name, __VA_ARGS__)
+
+#endif /* MICRO_BENCHMARK_H_ */
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include <string>
+#include <vector>
+#include <flatbuffers/flatbuffers.h>
+#include <flatbuffers/flexbuffers.h>
+
+#include "Benchmark.h"
+#include "utilities/EventNameTable.h"
+
+#include "resources/idl/event_generated.h"
+
+// Encoding and decoding of the events (same encoding as the publisher:
+// flatbuffer event with the payload as flexbuffer string)
+namespace
+{
+void buildEvent(flatbuffers::FlatBufferBuilder& builder,
+		flexbuffers::Builder& flexBuilder, const std::string* payload)
+{
+	builder.Clear();
+	auto name = builder.CreateString("SubsequentEvent");
+
+	flatbuffers::Offset<flatbuffers::Vector<uint8_t>> eventData;
+	if (payload != nullptr)
+	{
+		flexBuilder.Clear();
+		flexBuilder.String(*payload);
+		flexBuilder.Finish();
+		eventData = builder.CreateVector(flexBuilder.GetBuffer());
+	}
+
+	event::EventBuilder eventBuilder(builder);
+	eventBuilder.add_name(name);
+	eventBuilder.add_timestamp(1000);
+	if (payload != nullptr)
+	{
+		eventBuilder.add_event_data(eventData);
+	}
+	builder.Finish(eventBuilder.Finish());
+}
+
+void registerEventBenchmarks()
+{
+	for (size_t payloadSize : { size_t(0), size_t(64), size_t(1024), size_t(
+			16384) })
+	{
+		std::string suffix =
+				payloadSize == 0 ?
+						"/no_payload" :
+						"/payload_" + std::to_string(payloadSize);
+
+		micro::Registration("event/build" + suffix,
+				[payloadSize](uint64_t iterations)
+				{
+					flatbuffers::FlatBufferBuilder builder;
+					flexbuffers::Builder flexBuilder;
+					std::string payload(payloadSize, 'x');
+					uint64_t bytes = 0;
+					for (uint64_t i = 0; i < iterations; i++)
+					{
+						buildEvent(builder, flexBuilder,
+								payloadSize > 0 ? &payload : nullptr);
+						bytes += builder.GetSize();
+						micro::keep(builder.GetBufferPointer());
+					}
+					return bytes;
+				});
+
+		micro::Registration("event/decode" + suffix,
+				[payloadSize](uint64_t iterations)
+				{
+					flatbuffers::FlatBufferBuilder builder;
+					flexbuffers::Builder flexBuilder;
+					std::string payload(payloadSize, 'x');
+					buildEvent(builder, flexBuilder,
+							payloadSize > 0 ? &payload : nullptr);
+					auto buffer = builder.GetBufferPointer();
+
+					uint64_t sum = 0;
+					for (uint64_t i = 0; i < iterations; i++)
+					{
+						auto receivedEvent = event::GetEvent(buffer);
+						sum += receivedEvent->name()->size()
+						+ receivedEvent->timestamp();
+						if (receivedEvent->event_data() != nullptr)
+						{
+							sum += receivedEvent->event_data_flexbuffer_root().AsString().length();
+						}
+						micro::keep(sum);
+					}
+					return iterations * builder.GetSize();
+				});
+	}
+
+	// Interned event names (lookup of every received event)
+	micro::Registration("event/name_lookup", [](uint64_t iterations)
+	{
+		std::vector<std::string> eventNames =
+		{	"SimTimeChanged", "SimTimeHorizon", "End", "LoadState",
+			"SaveState", "NullMessage", "AntiMessage", "SubsequentEvent"};
+
+		EventNameTable<size_t> names(0);
+		for (size_t i = 0; i < eventNames.size(); i++)
+		{
+			names.add(eventNames[i], i + 1);
+		}
+
+		uint64_t sum = 0;
+		for (uint64_t i = 0; i < iterations; i++)
+		{
+			sum += names.lookup(eventNames[i % eventNames.size()]);
+			micro::keep(sum);
+		}
+		return uint64_t(0);
+	});
+}
+
+bool registered = (registerEventBenchmarks(), true);
+}
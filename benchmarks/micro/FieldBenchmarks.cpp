@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include "Benchmark.h"
+#include "data-types/Field.h"
+#include "reflection/FieldRegistry.h"
+
+// Access of the model fields (e.g. the current simulation time)
+namespace
+{
+BENCHMARK("field/get_uint64", [](uint64_t iterations)
+{
+	Field<uint64_t> field("CurrentSimTime", 42);
+	uint64_t sum = 0;
+	for (uint64_t i = 0; i < iterations; i++)
+	{
+		micro::keep(field);
+		sum += field.getValue();
+	}
+	micro::keep(sum);
+	return uint64_t(0);
+});
+
+BENCHMARK("field/set_uint64", [](uint64_t iterations)
+{
+	Field<uint64_t> field("CurrentSimTime", 0);
+	for (uint64_t i = 0; i < iterations; i++)
+	{
+		field.setValue(i);
+		micro::keep(field);
+	}
+	return uint64_t(0);
+});
+
+BENCHMARK("field/increment_uint32", [](uint64_t iterations)
+{
+	Field<uint32_t> field("Counter", 0);
+	for (uint64_t i = 0; i < iterations; i++)
+	{
+		field.setValue(field.getValue() + 1);
+		micro::keep(field);
+	}
+	return uint64_t(0);
+});
+
+BENCHMARK("field/set_double", [](uint64_t iterations)
+{
+	Field<double> field("SpeedFactor", 1.0);
+	for (uint64_t i = 0; i < iterations; i++)
+	{
+		field.setValue(double(i) * 0.5);
+		micro::keep(field);
+	}
+	return uint64_t(0);
+});
+
+// Lookup by name (e.g. parameters) and change tracking of the registry
+BENCHMARK("field/registry_get_by_name", [](uint64_t iterations)
+{
+	Field<uint64_t> simTime("SimTime", 5000);
+	Field<uint32_t> simTimeStep("SimTimeStep", 100);
+	Field<uint64_t> currentSimTime("CurrentSimTime", 42);
+	Field<double> speedFactor("SpeedFactor", 1.0);
+	FieldRegistry fields
+	{ simTime, simTimeStep, currentSimTime, speedFactor };
+
+	uint64_t sum = 0;
+	for (uint64_t i = 0; i < iterations; i++)
+	{
+		double value = 0;
+		fields.getValue("SpeedFactor", value);
+		sum += uint64_t(value);
+	}
+	micro::keep(sum);
+	return uint64_t(0);
+});
+
+BENCHMARK("field/registry_has_changes", [](uint64_t iterations)
+{
+	Field<uint64_t> simTime("SimTime", 5000);
+	Field<uint32_t> simTimeStep("SimTimeStep", 100);
+	Field<uint64_t> currentSimTime("CurrentSimTime", 42);
+	Field<double> speedFactor("SpeedFactor", 1.0);
+	FieldRegistry fields
+	{ simTime, simTimeStep, currentSimTime, speedFactor };
+
+	uint64_t changes = 0;
+	for (uint64_t i = 0; i < iterations; i++)
+	{
+		currentSimTime.setValue(42 + (i & 1));
+		changes += fields.hasChanges();
+	}
+	micro::keep(changes);
+	return uint64_t(0);
+});
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include <random>
+#include <string>
+
+#include "Benchmark.h"
+#include "data-types/Event.h"
+#include "data-types/EventSet.h"
+#include "scheduler/Scheduler.h"
+
+// Event set and scheduler of the event queue: scheduling of injected
+// events, rescheduling of periodic events and publishing of due events
+// (see models/event_queue_1)
+namespace
+{
+EventSet createEventSet(size_t size)
+{
+	std::mt19937_64 random(size);
+	EventSet eventSet;
+	eventSet.reserve(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		eventSet.push_back(
+				Event("Event_" + std::to_string(i % 16), random() % 1000000,
+						100, -1, Priority::NORMAL_PRIORITY));
+	}
+	return eventSet;
+}
+
+void registerQueueBenchmarks()
+{
+	for (size_t size : { size_t(16), size_t(256), size_t(4096), size_t(65536) })
+	{
+		std::string suffix = "/" + std::to_string(size);
+
+		// Unsorted set (e.g. after an injection batch)
+		micro::Registration("queue/schedule" + suffix,
+				[size](uint64_t iterations)
+				{
+					Scheduler scheduler;
+					EventSet unsorted = createEventSet(size);
+					EventSet eventSet;
+					for (uint64_t i = 0; i < iterations; i++)
+					{
+						eventSet = unsorted;
+						scheduler.scheduleEvents(eventSet);
+						micro::keep(eventSet.back());
+					}
+					return uint64_t(0);
+				});
+
+		// Single injected event (inserted into a scheduled set)
+		micro::Registration("queue/insert" + suffix,
+				[size](uint64_t iterations)
+				{
+					Scheduler scheduler;
+					EventSet eventSet = createEventSet(size);
+					scheduler.scheduleEvents(eventSet);
+					for (uint64_t i = 0; i < iterations; i++)
+					{
+						eventSet.push_back(
+								Event("Injected", (i * 7919) % 1000000, 0, 0,
+										Priority::NORMAL_PRIORITY));
+						scheduler.scheduleEvents(eventSet);
+						eventSet.pop_back();
+					}
+					return uint64_t(0);
+				});
+
+		// Periodic event (next timestamp of the earliest event)
+		micro::Registration("queue/reschedule" + suffix,
+				[size](uint64_t iterations)
+				{
+					Scheduler scheduler;
+					EventSet eventSet = createEventSet(size);
+					scheduler.scheduleEvents(eventSet);
+					for (uint64_t i = 0; i < iterations; i++)
+					{
+						auto& nextEvent = eventSet.back();
+						nextEvent.setTimestamp(
+								nextEvent.getTimestamp() + nextEvent.getPeriod());
+						scheduler.scheduleEvents(eventSet);
+						micro::keep(eventSet.back());
+					}
+					return uint64_t(0);
+				});
+
+		// Due events in the order of their timestamps (one iteration
+		// publishes the whole set, the copy of the set is included)
+		micro::Registration("queue/pop_all" + suffix,
+				[size](uint64_t iterations)
+				{
+					Scheduler scheduler;
+					EventSet sorted = createEventSet(size);
+					scheduler.scheduleEvents(sorted);
+					EventSet eventSet;
+					for (uint64_t i = 0; i < iterations; i++)
+					{
+						eventSet = sorted;
+						uint64_t sum = 0;
+						while (!eventSet.empty())
+						{
+							sum += eventSet.back().getTimestamp();
+							eventSet.pop_back();
+						}
+						micro::keep(sum);
+					}
+					return uint64_t(0);
+				});
+	}
+}
+
+bool registered = (registerQueueBenchmarks(), true);
+}
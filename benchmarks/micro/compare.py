@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# Copyright (c) 2019, German Aerospace Center (DLR)
+#
+# This file is part of the development version of FRASER.
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+#
+# Authors:
+# - 2019, Annika Ofenloch (DLR RY-AVS)
+
+"""Compares two result files of the micro benchmarks (fraser-micro --json).
+
+Prints the time per operation of both files and their ratio. Benchmarks,
+which are slower than the threshold, are marked as regressions (exit code 1),
+e.g. for a comparison of two versions in a CI job.
+"""
+
+import argparse
+import json
+import sys
+
+
+def read_results(file_name):
+    with open(file_name) as result_file:
+        results = json.load(result_file)
+    return dict((b['name'], b) for b in results['benchmarks'])
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawTextHelpFormatter)
+    parser.add_argument('baseline')
+    parser.add_argument('current')
+    parser.add_argument('--threshold', type=float, default=10.0,
+                        help='tolerated slowdown in percent '
+                        '(default: %(default)s)')
+    args = parser.parse_args()
+
+    baseline = read_results(args.baseline)
+    current = read_results(args.current)
+
+    regressions = 0
+    print('%-36s %14s %14s %9s' % ('benchmark', 'baseline ns', 'current ns',
+                                   'ratio'))
+    for name in sorted(current):
+        if name not in baseline:
+            print('%-36s %14s %14.1f %9s' % (
+                name, '-', current[name]['ns_per_op'], 'new'))
+            continue
+
+        base = baseline[name]['ns_per_op']
+        value = current[name]['ns_per_op']
+        ratio = value / base if base > 0 else 1.0
+        marker = ''
+        if ratio > 1.0 + args.threshold / 100.0:
+            marker = '  REGRESSION'
+            regressions += 1
+        print('%-36s %14.1f %14.1f %8.2fx%s' % (name, base, value, ratio,
+                                                marker))
+
+    for name in sorted(set(baseline) - set(current)):
+        print('%-36s %14.1f %14s %9s' % (name, baseline[name]['ns_per_op'],
+                                         '-', 'removed'))
+
+    if regressions:
+        print('%d regression(s) above %.0f%%' % (regressions, args.threshold))
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
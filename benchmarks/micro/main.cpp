@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+
+void printHelp()
+{
+	std::cout << "<< Help >>" << std::endl;
+	std::cout << "fraser-micro [--filter TEXT] [--min-time MS] "
+			<< "[--repetitions N] [--json FILE] [--list]" << std::endl;
+	std::cout << "--filter TEXT >> Run only the benchmarks containing TEXT "
+			<< "(repeatable)" << std::endl;
+	std::cout << "--min-time MS >> Minimum time of a measurement "
+			<< "(default: 100)" << std::endl;
+	std::cout << "--repetitions N >> Measurements per benchmark, the median "
+			<< "is reported (default: 5)" << std::endl;
+	std::cout << "--json FILE >> Write the results as JSON "
+			<< "(see benchmarks/micro/compare.py)" << std::endl;
+	std::cout << "--list >> Print the names of the benchmarks" << std::endl;
+}
+
+bool matches(const std::string& name, const std::vector<std::string>& filters)
+{
+	if (filters.empty())
+	{
+		return true;
+	}
+
+	for (auto& filter : filters)
+	{
+		if (name.find(filter) != std::string::npos)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool writeJson(const std::string& filePath,
+		const std::vector<micro::Result>& results, double minTimeMs,
+		unsigned repetitions)
+{
+	std::FILE* file = std::fopen(filePath.c_str(), "w");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	std::fprintf(file,
+			"{\n  \"version\": 1,\n  \"context\": {\"compiler\": \"%s\", \"min_time_ms\": %g, \"repetitions\": %u},\n  \"benchmarks\": [",
+			__VERSION__, minTimeMs, repetitions);
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		auto& result = results[i];
+		std::fprintf(file,
+				"%s\n    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.3f, \"min_ns_per_op\": %.3f, \"max_ns_per_op\": %.3f, \"bytes_per_op\": %.1f}",
+				i == 0 ? "" : ",", result.name.c_str(),
+				(unsigned long long) result.iterations, result.nsPerOp,
+				result.minNsPerOp, result.maxNsPerOp, result.bytesPerOp);
+	}
+	std::fprintf(file, "\n  ]\n}\n");
+
+	return std::fclose(file) == 0;
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> filters;
+	double minTimeMs = 100;
+	unsigned repetitions = 5;
+	std::string jsonFile;
+	bool list = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string option = static_cast<std::string>(argv[i]);
+		try
+		{
+			if (option == "--filter" && i + 1 < argc)
+			{
+				filters.push_back(argv[++i]);
+			} else if (option == "--min-time" && i + 1 < argc)
+			{
+				minTimeMs = std::stod(argv[++i]);
+			} else if (option == "--repetitions" && i + 1 < argc)
+			{
+				repetitions = unsigned(std::stoul(argv[++i]));
+			} else if (option == "--json" && i + 1 < argc)
+			{
+				jsonFile = argv[++i];
+			} else if (option == "--list")
+			{
+				list = true;
+			} else if (option == "--help")
+			{
+				printHelp();
+				return 0;
+			} else
+			{
+				std::cout << " Invalid argument/s: --help" << std::endl;
+				return 1;
+			}
+		} catch (std::exception& e)
+		{
+			std::cout << " Invalid argument/s: --help" << std::endl;
+			return 1;
+		}
+	}
+
+	std::vector<micro::Result> results;
+	for (auto& benchmark : micro::getRegistry())
+	{
+		if (!matches(benchmark.first, filters))
+		{
+			continue;
+		}
+
+		if (list)
+		{
+			std::cout << benchmark.first << std::endl;
+			continue;
+		}
+
+		results.push_back(
+				micro::run(benchmark.first, benchmark.second,
+						minTimeMs * 1e6, repetitions));
+
+		auto& result = results.back();
+		std::printf("%-36s %14.1f ns/op  (min %.1f, max %.1f)", result.name.c_str(),
+				result.nsPerOp, result.minNsPerOp, result.maxNsPerOp);
+		if (result.bytesPerOp > 0)
+		{
+			std::printf("  %10.1f MB/s",
+					result.bytesPerOp / result.nsPerOp * 1e3);
+		}
+		std::printf("\n");
+		std::fflush(stdout);
+	}
+
+	if (!jsonFile.empty() && !writeJson(jsonFile, results, minTimeMs, repetitions))
+	{
+		std::cerr << "Could not write " << jsonFile << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -3,16 +3,17 @@ SRCS ?=
 PROG ?=
 BINDIR ?=
 OBJDIR ?=
+DEFINES ?=
 
 CC=gcc
 CXX=g++
 RM=rm -f
-INCLUDES = -I../../ -I../ -I/usr/local/include -I../../fraser/src -I../../fraser -I../../models -I../../../cpp
-CXXFLAGS := -std=c++1y -g -Wall -DBOOST_LOG_DYN_LINK ${INCLUDES} 
+INCLUDES = -I../../ -I../ -I/usr/local/include -I../../fraser/src -I../../fraser -I../../src -I../../models -I../../../cpp
+CXXFLAGS := -std=c++1y -g -Wall -DBOOST_LOG_DYN_LINK ${DEFINES} ${INCLUDES} 
 LDFLAGS = -L/usr/local/lib -L/usr/lib/x86_64-linux-gnu 
 
  
-LIBS= -lzmq -lboost_log_setup -lboost_log -lboost_filesystem -lboost_serialization -lboost_system -lboost_thread -lpugixml -lpthread
+LIBS= -lzmq -lboost_log_setup -lboost_log -lboost_filesystem -lboost_serialization -lboost_system -lboost_thread -lpugixml -lz -lpthread
 
 vpath %.cpp $(dir $(SRCS))
 
@@ -13,11 +13,23 @@
 
 #include "ConfigurationServer.h"
 
+#include <algorithm>
+#include <chrono>
+#include <set>
+#include <stdexcept>
+
 #define FRONTEND_PORT std::string("5570")
+#define BACKEND_ENDPOINT std::string("inproc://configuration-workers")
+#define CONTROL_ENDPOINT std::string("inproc://configuration-control")
+
+// Workers check every WORKER_TIMEOUT milliseconds if the server stopped
+#define WORKER_TIMEOUT 100
 
-ConfigurationServer::ConfigurationServer(std::string modelsConfigFilePath) :
+ConfigurationServer::ConfigurationServer(std::string modelsConfigFilePath,
+		unsigned int numWorkers) :
 		mModelsConfigFilePath(modelsConfigFilePath), mCtx(1), mFrontend(mCtx,
-		ZMQ_ROUTER)
+		ZMQ_ROUTER), mBackend(mCtx, ZMQ_DEALER), mController(mCtx, ZMQ_PAIR), mNumWorkers(
+				numWorkers)
 {
 
 	registerInterruptSignal();
@@ -25,10 +37,19 @@ ConfigurationServer::ConfigurationServer(std::string modelsConfigFilePath) :
 
 	if (mRun)
 	{
-		mModelNames = getModelNames();
+		setModelNames();
+		setModelDependencies();
 		setMinAndMaxPort();
-		setModelPortNumbers();
 		setModelIPAddresses();
+		setModelLogLevels();
+		setModelMetrics();
+		setModelTracing();
+		setModelParameters();
+		setModelSynchronization();
+		setModelSavepoints();
+		setModelBranches();
+		setModelPortNumbers();
+		setGlobalKeys();
 
 		try
 		{
@@ -44,6 +65,17 @@ ConfigurationServer::ConfigurationServer(std::string modelsConfigFilePath) :
 
 ConfigurationServer::~ConfigurationServer()
 {
+	mRun = false;
+	for (auto& worker : mWorkers)
+	{
+		if (worker.joinable())
+		{
+			worker.join();
+		}
+	}
+
+	mController.close();
+	mBackend.close();
 	mFrontend.close();
 }
 
@@ -59,6 +91,12 @@ bool ConfigurationServer::prepare()
 	} else
 	{
 		mRootNode = mDocument.document_element();
+
+		std::ifstream configFile(mModelsConfigFilePath, std::ios::binary);
+		std::stringstream content;
+		content << configFile.rdbuf();
+		mConfigurationVersion = Hash::fnv1a(content.str());
+
 		return true;
 	}
 }
@@ -69,165 +107,851 @@ void ConfigurationServer::setMinAndMaxPort()
 	mMaxPort = mRootNode.child("Hosts").attribute("maxPort").as_int();
 }
 
-bool ConfigurationServer::setModelPortNumbers()
+int ConfigurationServer::allocatePort(const std::string& hostAddress)
 {
-	int portCnt = mMinPort;
+	auto& releasedPorts = mReleasedPorts[hostAddress];
+	if (!releasedPorts.empty())
+	{
+		int port = releasedPorts.back();
+		releasedPorts.pop_back();
+		return port;
+	}
 
+	// Each host has its own range of ports
+	auto nextPort = mNextPorts.find(hostAddress);
+	if (nextPort == mNextPorts.end())
+	{
+		nextPort = mNextPorts.insert(std::make_pair(hostAddress, mMinPort)).first;
+	}
+
+	if (nextPort->second > mMaxPort)
+	{
+		return 0;
+	}
+	return nextPort->second++;
+}
+
+bool ConfigurationServer::setModelPortNumbers()
+{
 	for (auto name : mModelNames)
 	{
-		if (portCnt > mMaxPort)
+		int port = allocatePort(mModelInformation[name + "_ip"]);
+		if (port == 0)
 		{
 			throw "[Error] Exceeded max. port number --> Increase the interval";
 			return false;
 		}
 
-		mModelInformation[name + "_port"] = std::to_string(portCnt);
-		portCnt++;
+		mModelInformation[name + "_port"] = std::to_string(port);
+	}
+
+	// The synchronization socket is bound by the simulation model
+	int syncPort = allocatePort(mModelInformation["simulation_model_ip"]);
+	if (syncPort == 0)
+	{
+		throw "[Error] Exceeded max. port number --> Increase the interval";
+		return false;
 	}
+	mModelInformation["sim_sync_port"] = std::to_string(syncPort);
 
-	mModelInformation["sim_sync_port"] = std::to_string(portCnt);
+	// Tick reports of the models to the simulation model (stragglers)
+	int reportPort = allocatePort(mModelInformation["simulation_model_ip"]);
+	if (reportPort == 0)
+	{
+		throw "[Error] Exceeded max. port number --> Increase the interval";
+		return false;
+	}
+	mModelInformation["sim_report_port"] = std::to_string(reportPort);
+
+	// Models with an event injection endpoint get an additional port
+	for (auto name : mModelNames)
+	{
+		if (mModelNodes[name].attribute("injection").as_bool())
+		{
+			int port = allocatePort(mModelInformation[name + "_ip"]);
+			if (port == 0)
+			{
+				throw "[Error] Exceeded max. port number --> Increase the interval";
+				return false;
+			}
+
+			mModelInformation[name + "_injection_port"] = std::to_string(port);
+		}
+	}
 
 	return true;
 }
 
 void ConfigurationServer::setModelIPAddresses()
 {
-	std::string hostAddress = "";
+	std::map<std::string, std::string> hostAddresses;
+
+	std::string allHostsSearch = ".//Hosts/Host";
+	pugi::xpath_node_set xpathAllHosts = mRootNode.select_nodes(
+			allHostsSearch.c_str());
+
+	for (auto &hostNode : xpathAllHosts)
+	{
+		std::string hostID = hostNode.node().attribute("id").value();
+		if (hostAddresses.count(hostID) == 0)
+		{
+			hostAddresses[hostID] = hostNode.node().child("Address").text().get();
+		}
+	}
 
 	for (auto name : mModelNames)
 	{
-		// Search for the first matching entry with the given hint attribute
-		std::string specificModelSearch = ".//Models/Model[@id='" + name + "']";
+		std::string hostID = mModelNodes[name].child("HostReference").attribute(
+				"hostID").value();
 
-		pugi::xpath_node xpathSpecificModel = mRootNode.select_single_node(
-				specificModelSearch.c_str());
+		mModelInformation[name + "_ip"] = hostAddresses[hostID];
+	}
+}
 
-		if (xpathSpecificModel)
-		{
-			std::string hostID = xpathSpecificModel.node().child(
-					"HostReference").attribute("hostID").value();
+void ConfigurationServer::setModelLogLevels()
+{
+	// Default of all models (and of joining models)
+	std::string defaultLevel =
+			mRootNode.child("Models").attribute("logLevel").value();
+	LogSeverity severity;
 
-			std::string hostNameSearch = ".//Hosts/Host[@id='" + hostID
-					+ "']/Address";
+	if (!defaultLevel.empty() && !parseSeverity(defaultLevel, severity))
+	{
+		std::cerr << "Invalid log level: " << defaultLevel << std::endl;
+		defaultLevel = "";
+	}
+	mModelInformation["default_log_level"] = defaultLevel;
 
-			pugi::xpath_node xpath_hostName = mRootNode.select_single_node(
-					hostNameSearch.c_str());
+	for (auto name : mModelNames)
+	{
+		std::string level = mModelNodes[name].attribute("logLevel").value();
 
-			hostAddress = xpath_hostName.node().text().get();
-			mModelInformation[name + "_ip"] = hostAddress;
+		if (level.empty() || !parseSeverity(level, severity))
+		{
+			if (!level.empty())
+			{
+				std::cerr << "Invalid log level of " << name << ": " << level
+						<< std::endl;
+			}
+			level = defaultLevel;
 		}
-	}
 
+		mModelInformation[name + "_log_level"] = level;
+	}
 }
 
-int ConfigurationServer::getNumberOfModels()
+void ConfigurationServer::setModelMetrics()
 {
-	std::string allModelsSearch = ".//Models/Model";
-	pugi::xpath_node_set xpathAllModels = mRootNode.select_nodes(
-			allModelsSearch.c_str());
+	// Interval of the stats topic in milliseconds (0: disabled)
+	auto models = mRootNode.child("Models");
+	mModelInformation["stats_interval"] = std::to_string(
+			models.attribute("statsInterval").as_uint(1000));
 
-	return xpathAllModels.size();
+	// Folder of the Prometheus text files (empty: no files)
+	mModelInformation["metrics_path"] = models.attribute("metricsPath").value();
 }
 
-std::string ConfigurationServer::getModelInformation(std::string request)
+void ConfigurationServer::setModelTracing()
 {
-	return mModelInformation[request];
+	// Folder of the span files (empty: tracing disabled)
+	auto models = mRootNode.child("Models");
+	mModelInformation["trace_path"] = models.attribute("tracePath").value();
+
+	// Every n-th causal chain is traced
+	mModelInformation["trace_sampling"] = std::to_string(
+			models.attribute("traceSampling").as_uint(1));
+
+	// Flight recorder: records per model (0: disabled) and folder of the
+	// dumps (empty: working directory of the model)
+	mModelInformation["flight_recorder_size"] = std::to_string(
+			models.attribute("flightRecorderSize").as_uint(4096));
+	mModelInformation["flight_recorder_path"] = models.attribute(
+			"flightRecorderPath").value();
 }
 
-int ConfigurationServer::getNumberOfPersistModels()
+void ConfigurationServer::setModelParameters()
 {
-	std::string allModelsSearch = ".//Models/Model[@persist='true']";
-	auto xpathAllModels = mRootNode.select_nodes(allModelsSearch.c_str());
+	// Instances of an array share the parameters of the array
+	for (auto name : mModelNames)
+	{
+		for (auto parameter : mModelNodes[name].children("Parameter"))
+		{
+			std::string key = parameter.attribute("name").value();
+			if (!key.empty())
+			{
+				mModelInformation[name + "_param_" + key] =
+						parameter.attribute("value").value();
+			}
+		}
+	}
+}
 
-	return xpathAllModels.size();
+void ConfigurationServer::setModelSynchronization()
+{
+	// The models activate their synchronizers before the first horizon
+	// (empty: the mode of the simulation model configuration file)
+	std::string mode = mRootNode.child("Models").attribute("syncMode").value();
+	if (mode != "time-stepped" && mode != "conservative"
+			&& mode != "optimistic")
+	{
+		if (!mode.empty())
+		{
+			std::cerr << "Invalid synchronization mode: " << mode << std::endl;
+		}
+		mode = "";
+	}
+	mModelInformation["sync_mode"] = mode;
+}
+
+void ConfigurationServer::setModelSavepoints()
+{
+	// Reserved bytes per model in the savepoint container (0: one file
+	// per model in a savepoint directory)
+	auto models = mRootNode.child("Models");
+	mModelInformation["savepoint_region_size"] = std::to_string(
+			models.attribute("savepointRegionSize").as_ullong(16777216));
+
+	// Large states are decoded at their first use after a restore
+	mModelInformation["lazy_restore"] =
+			models.attribute("lazyRestore").as_bool(true) ? "1" : "0";
 }
 
-std::vector<std::string> ConfigurationServer::getModelNames()
+void ConfigurationServer::setModelBranches()
 {
-	std::vector<std::string> modelNames;
+	// The ports of branch N are shifted by N times the port range
+	mModelInformation["branch_port_range"] = std::to_string(
+			mMaxPort - mMinPort + 1);
+
+	// The i-th Branch element (1 ... N) sets the parameters of branch i
+	auto branches = mRootNode.child("Branches");
+	int numBranches = 0;
+	for (auto branch : branches.children("Branch"))
+	{
+		numBranches++;
+		for (auto parameter : branch.children("Parameter"))
+		{
+			std::string model = parameter.attribute("model").value();
+			std::string key = parameter.attribute("name").value();
+			if (key.empty())
+			{
+				continue;
+			}
+
+			// Instances of an array share the parameters of the array
+			for (auto name : mModelNames)
+			{
+				if (name == model
+						|| model == mModelNodes[name].attribute("id").value())
+				{
+					mModelInformation[name + "_branch_"
+							+ std::to_string(numBranches) + "_param_" + key] =
+							parameter.attribute("value").value();
+				}
+			}
+		}
+	}
 
+	mModelInformation["num_branches"] = std::to_string(numBranches);
+	mModelInformation["fork_time"] = branches.attribute("forkTime").value();
+}
+
+void ConfigurationServer::setModelNames()
+{
 	std::string allModelsSearch = ".//Models/Model";
 
 	pugi::xpath_node_set xpathAllModels = mRootNode.select_nodes(
 			allModelsSearch.c_str());
 
-	if (!xpathAllModels.empty())
+	for (auto &modelNode : xpathAllModels)
 	{
-		for (auto &modelNode : xpathAllModels)
+		std::string id = modelNode.node().attribute("id").value();
+
+		// Only the first matching entry counts
+		if (mModelArrays.count(id) > 0)
+		{
+			continue;
+		}
+
+		// Instance arrays (count="N") are expanded to id_0 ... id_N-1
+		int count = modelNode.node().attribute("count").as_int(0);
+
+		std::vector<std::string> instanceNames;
+		if (count > 0)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				instanceNames.push_back(id + "_" + std::to_string(i));
+			}
+		} else
 		{
-			modelNames.push_back(modelNode.node().attribute("id").value());
+			instanceNames.push_back(id);
 		}
+
+		for (auto& instanceName : instanceNames)
+		{
+			// Generated names must not shadow declared models (e.g. id_0)
+			if (mModelNodes.count(instanceName) > 0)
+			{
+				std::cerr << "Duplicate model name: " << instanceName
+						<< " (model " << id << ")" << std::endl;
+				throw "[Error] Duplicate model name --> Check the hosts-config file";
+			}
+
+			mModelNames.push_back(instanceName);
+			mModelNodes[instanceName] = modelNode.node();
+
+			if (modelNode.node().attribute("persist").as_bool())
+			{
+				mNumberOfPersistModels++;
+				mModelInformation[instanceName + "_persist"] = "1";
+			}
+		}
+
+		mModelArrays[id] = instanceNames;
 	}
-	return modelNames;
+
+	mNumberOfModels = mModelNames.size();
 }
 
-std::vector<std::string> ConfigurationServer::getModelDependencies(
-		std::string modelName)
+void ConfigurationServer::setModelDependencies()
 {
-	std::vector<std::string> modelDependencies;
-
-	// Search for the first matching entry with the given hint attribute
-	std::string specificModelSearch = ".//Models/Model[@id='" + modelName
-			+ "']";
+	for (auto name : mModelNames)
+	{
+		auto modelNode = mModelNodes[name];
 
-	pugi::xpath_node xpathModel = mRootNode.select_node(
-			specificModelSearch.c_str());
+		// Index of the instance within its array
+		std::string id = modelNode.attribute("id").value();
+		std::string index = "";
+		if (name != id)
+		{
+			index = name.substr(id.size() + 1);
+		}
 
-	if (xpathModel)
-	{
-		// Search for the first matching entry with the given hint attribute
 		std::string specificModelDependSearch = ".//Dependencies/ModelReference";
-		pugi::xpath_node_set xpathModelDepends = xpathModel.node().select_nodes(
+		pugi::xpath_node_set xpathModelDepends = modelNode.select_nodes(
 				specificModelDependSearch.c_str());
 
+		auto& modelDependencies = mModelDependencies[name];
 		for (auto &modelDepend : xpathModelDepends)
 		{
 			std::string modelID =
 					modelDepend.node().attribute("modelID").value();
-
-			modelDependencies.push_back(modelID);
+			std::string instances =
+					modelDepend.node().attribute("instances").value();
+
+			auto modelArray = mModelArrays.find(modelID);
+			if (modelArray == mModelArrays.end()
+					|| modelArray->second.front() == modelID)
+			{
+				// Single model (or unknown model)
+				modelDependencies.push_back(modelID);
+				continue;
+			}
+
+			// [instances]: "all" (default), "same" (same index) or "FIRST-LAST"
+			auto& instanceNames = modelArray->second;
+			if (instances.empty() || instances == "all")
+			{
+				modelDependencies.insert(modelDependencies.end(),
+						instanceNames.begin(), instanceNames.end());
+			} else if (instances == "same")
+			{
+				size_t instance = 0;
+				if (!index.empty() && parseIndex(index, instance)
+						&& instance < instanceNames.size())
+				{
+					modelDependencies.push_back(modelID + "_" + index);
+				}
+			} else
+			{
+				size_t separator = instances.find('-');
+				size_t first = 0;
+				size_t last = 0;
+				bool valid = parseIndex(instances.substr(0, separator), first);
+				last = first;
+				if (valid && separator != std::string::npos)
+				{
+					valid = parseIndex(instances.substr(separator + 1), last);
+				}
+
+				if (!valid || first > last)
+				{
+					std::cerr << "Invalid instances of " << name << " ("
+							<< modelID << "): " << instances << std::endl;
+					throw "[Error] Invalid instances --> Check the hosts-config file";
+				}
+
+				for (size_t i = first; i <= last && i < instanceNames.size();
+						i++)
+				{
+					modelDependencies.push_back(instanceNames[i]);
+				}
+			}
 		}
 	}
+}
+
+bool ConfigurationServer::parseIndex(const std::string& value, size_t& index)
+{
+	// std::stoul accepts leading whitespace, signs and trailing characters
+	if (value.empty()
+			|| value.find_first_not_of("0123456789") != std::string::npos)
+	{
+		return false;
+	}
+
+	try
+	{
+		index = std::stoul(value);
+	} catch (std::out_of_range&)
+	{
+		return false;
+	}
 
-	return modelDependencies;
+	return true;
 }
 
-void ConfigurationServer::run()
+void ConfigurationServer::setGlobalKeys()
 {
+	// Keys of a model start with its name (e.g. "model_1_port"), all other
+	// keys are part of every bundle
+	std::set<std::string> modelNames(mModelNames.begin(), mModelNames.end());
 
-	while (mRun)
+	mGlobalKeys.clear();
+	for (auto& information : mModelInformation)
 	{
-		std::string identity = s_recv(mFrontend);
-		std::string msg = s_recv(mFrontend);
+		const std::string& key = information.first;
+		bool modelKey = false;
+		for (size_t pos = key.find('_'); pos != std::string::npos && !modelKey;
+				pos = key.find('_', pos + 1))
+		{
+			modelKey = (modelNames.count(key.substr(0, pos)) > 0);
+		}
 
-		if (msg == "End")
+		if (!modelKey)
 		{
-			// Stop the configuration server
-			break;
+			mGlobalKeys.push_back(key);
 		}
+	}
+}
 
-		s_sendmore(mFrontend, identity);
-		if (msg == "total_num_models")
+bool ConfigurationServer::connectsToAllModels(const std::string& modelName)
+{
+	// The simulation model and the loggers subscribe to all models
+	return modelName == "simulation_model"
+			|| modelName.find("logger") != std::string::npos;
+}
+
+std::string ConfigurationServer::createModelBundle(
+		const std::string& modelName) const
+{
+	// All models connect to the simulation model
+	std::vector<std::string> entryModels;
+	if (connectsToAllModels(modelName))
+	{
+		entryModels = mModelNames;
+	} else
+	{
+		entryModels = getModelDependencies(modelName);
+		entryModels.push_back("simulation_model");
+		if (!modelName.empty())
 		{
-			s_send(mFrontend, std::to_string(getNumberOfModels()));
-		} else if (msg == "num_persist_models")
+			entryModels.push_back(modelName);
+		}
+	}
+	std::sort(entryModels.begin(), entryModels.end());
+	entryModels.erase(std::unique(entryModels.begin(), entryModels.end()),
+			entryModels.end());
+
+	// Entries of a model are the keys with its name as prefix (a key can
+	// match several prefixes, e.g. of model_1 and model_1_0)
+	typedef std::map<std::string, std::string>::const_iterator Information;
+	std::vector<Information> information;
+	for (auto& key : mGlobalKeys)
+	{
+		auto global = mModelInformation.find(key);
+		if (global != mModelInformation.end())
 		{
-			s_send(mFrontend, std::to_string(getNumberOfPersistModels()));
-		} else if (msg == "all_model_names")
+			information.push_back(global);
+		}
+	}
+	for (auto& entryModel : entryModels)
+	{
+		std::string prefix = entryModel + "_";
+		for (auto entry = mModelInformation.lower_bound(prefix);
+				entry != mModelInformation.end()
+						&& entry->first.compare(0, prefix.size(), prefix) == 0;
+				++entry)
 		{
-			v_send(mFrontend, getModelNames());
-		} else if (msg == "model_dependencies")
+			information.push_back(entry);
+		}
+	}
+	std::sort(information.begin(), information.end(),
+			[](const Information& left, const Information& right)
+			{
+				return left->first < right->first;
+			});
+	information.erase(std::unique(information.begin(), information.end()),
+			information.end());
+
+	flatbuffers::FlatBufferBuilder builder;
+
+	std::vector<flatbuffers::Offset<configuration::Entry>> entries;
+	entries.reserve(information.size());
+	for (auto& entry : information)
+	{
+		entries.push_back(
+				configuration::CreateEntry(builder,
+						builder.CreateString(entry->first),
+						builder.CreateString(entry->second)));
+	}
+
+	auto bundle = configuration::CreateModelBundle(builder,
+			builder.CreateString(modelName), mNumberOfModels,
+			mNumberOfPersistModels, builder.CreateVectorOfStrings(mModelNames),
+			builder.CreateVectorOfStrings(getModelDependencies(modelName)),
+			builder.CreateVectorOfSortedTables(&entries), getVersion(),
+			builder.CreateVectorOfStrings(entryModels));
+	builder.Finish(bundle);
+
+	return std::string(
+			reinterpret_cast<const char*>(builder.GetBufferPointer()),
+			builder.GetSize());
+}
+
+int ConfigurationServer::getNumberOfModels() const
+{
+	return mNumberOfModels;
+}
+
+std::string ConfigurationServer::getModelInformation(
+		const std::string& request) const
+{
+	auto information = mModelInformation.find(request);
+	if (information == mModelInformation.end())
+	{
+		return "";
+	}
+	return information->second;
+}
+
+int ConfigurationServer::getNumberOfPersistModels() const
+{
+	return mNumberOfPersistModels;
+}
+
+const std::vector<std::string>& ConfigurationServer::getModelNames() const
+{
+	return mModelNames;
+}
+
+std::vector<std::string> ConfigurationServer::getModelDependencies(
+		const std::string& modelName) const
+{
+	auto modelDependencies = mModelDependencies.find(modelName);
+	if (modelDependencies == mModelDependencies.end())
+	{
+		return std::vector<std::string>();
+	}
+	return modelDependencies->second;
+}
+
+std::string ConfigurationServer::getModelBundle(
+		const std::string& modelName) const
+{
+	// Models without an entry (e.g. external clients) get a bundle
+	// without dependencies
+	std::string bundleName = modelName;
+	if (mModelDependencies.find(modelName) == mModelDependencies.end())
+	{
+		bundleName = "";
+	}
+
+	// Serialized at the first request (the caller holds the shared lock of
+	// the tables)
+	std::lock_guard<std::mutex> lock(mBundlesMutex);
+	auto bundle = mModelBundles.find(bundleName);
+	if (bundle == mModelBundles.end())
+	{
+		bundle = mModelBundles.emplace(bundleName,
+				createModelBundle(bundleName)).first;
+	}
+	return bundle->second;
+}
+
+std::string ConfigurationServer::getServerStatistics() const
+{
+	return "workers=" + std::to_string(mNumWorkers) + " "
+			+ mLatencyStatistics.getSummary();
+}
+
+std::string ConfigurationServer::getConfigurationVersion() const
+{
+	return Hash::toHex(getVersion());
+}
+
+uint64_t ConfigurationServer::getVersion() const
+{
+	// Joined or left models change the version as well (cached bundles
+	// of the clients are invalid afterwards)
+	if (mMembershipEpoch == 0)
+	{
+		return mConfigurationVersion;
+	}
+
+	return Hash::fnv1a(reinterpret_cast<const char*>(&mMembershipEpoch),
+			sizeof(mMembershipEpoch), mConfigurationVersion);
+}
+
+uint64_t ConfigurationServer::getMembershipEpoch() const
+{
+	return mMembershipEpoch;
+}
+
+std::string ConfigurationServer::registerModel(const std::string& modelName,
+		const std::string& address, bool persist,
+		const std::vector<std::string>& dependencies)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mTablesMutex);
+
+	if (modelName.empty()
+			|| std::find(mModelNames.begin(), mModelNames.end(), modelName)
+					!= mModelNames.end())
+	{
+		return "";
+	}
+
+	int port = allocatePort(address);
+	if (port == 0)
+	{
+		return "";
+	}
+
+	mModelNames.push_back(modelName);
+	mNumberOfModels = mModelNames.size();
+	mModelInformation[modelName + "_port"] = std::to_string(port);
+	mModelInformation[modelName + "_ip"] = address;
+	mModelInformation[modelName + "_log_level"] =
+			mModelInformation["default_log_level"];
+	mModelDependencies[modelName] = dependencies;
+	mDynamicModels[modelName] = persist;
+	if (persist)
+	{
+		mNumberOfPersistModels++;
+		mModelInformation[modelName + "_persist"] = "1";
+	}
+	mMembershipEpoch++;
+
+	// Serialized again at their next request
+	mModelBundles.clear();
+
+	return std::to_string(port);
+}
+
+bool ConfigurationServer::deregisterModel(const std::string& modelName)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(mTablesMutex);
+
+	// Models of the hosts-config file are part of the initial barrier
+	auto dynamicModel = mDynamicModels.find(modelName);
+	if (dynamicModel == mDynamicModels.end())
+	{
+		return false;
+	}
+
+	if (dynamicModel->second)
+	{
+		mNumberOfPersistModels--;
+	}
+	mDynamicModels.erase(dynamicModel);
+
+	mReleasedPorts[mModelInformation[modelName + "_ip"]].push_back(
+			std::stoi(mModelInformation[modelName + "_port"]));
+
+	mModelNames.erase(
+			std::find(mModelNames.begin(), mModelNames.end(), modelName));
+	mNumberOfModels = mModelNames.size();
+	mModelInformation.erase(modelName + "_port");
+	mModelInformation.erase(modelName + "_ip");
+	mModelInformation.erase(modelName + "_log_level");
+	mModelInformation.erase(modelName + "_persist");
+	mModelDependencies.erase(modelName);
+	mMembershipEpoch++;
+
+	// Serialized again at their next request
+	mModelBundles.clear();
+
+	return true;
+}
+
+void ConfigurationServer::run()
+{
+	if (!mRun)
+	{
+		return;
+	}
+
+	zmq::socket_t control(mCtx, ZMQ_PAIR);
+	control.bind(CONTROL_ENDPOINT);
+	mController.connect(CONTROL_ENDPOINT);
+
+	mBackend.bind(BACKEND_ENDPOINT);
+
+	for (unsigned int i = 0; i < std::max(mNumWorkers, 1u); i++)
+	{
+		mWorkers.emplace_back(&ConfigurationServer::handleRequests, this);
+	}
+
+	try
+	{
+		// Returns after the TERMINATE command (End request)
+		zmq::proxy_steerable(mFrontend, mBackend, nullptr, control);
+	} catch (zmq::error_t& e)
+	{
+		mRun = false;
+		throw;
+	}
+
+	mRun = false;
+}
+
+void ConfigurationServer::handleRequests()
+{
+	zmq::socket_t worker(mCtx, ZMQ_DEALER);
+	worker.setsockopt(ZMQ_RCVTIMEO, WORKER_TIMEOUT);
+	worker.setsockopt(ZMQ_LINGER, 0);
+	worker.connect(BACKEND_ENDPOINT);
+
+	while (mRun && !interruptOccured)
+	{
+		zmq::message_t identityMessage;
+		try
 		{
-			std::string sought = "_dependencies";
-			v_send(mFrontend, getModelDependencies(identity));
-		} else
+			if (!worker.recv(&identityMessage))
+			{
+				continue;
+			}
+		} catch (zmq::error_t& e)
 		{
-			s_send(mFrontend, getModelInformation(msg));
+			break;
 		}
 
-		if (interruptOccured)
+		auto begin = std::chrono::steady_clock::now();
+
+		std::string identity(static_cast<const char*>(identityMessage.data()),
+				identityMessage.size());
+		std::string msg = s_recv(worker);
+
+		// Additional frames: e.g. the model name of the bundle request,
+		// because the requesting socket can not use it as identity
+		std::vector<std::string> arguments;
+		while (worker.getsockopt<int>(ZMQ_RCVMORE))
+		{
+			arguments.push_back(s_recv(worker));
+		}
+
+		if (msg == "End")
 		{
+			// Stop the configuration server
+			stopServer();
 			break;
 		}
+
+		answerRequest(worker, identity, msg, arguments);
+
+		mLatencyStatistics.record(
+				std::chrono::duration_cast<std::chrono::nanoseconds>(
+						std::chrono::steady_clock::now() - begin).count());
+	}
+
+	worker.close();
+}
+
+void ConfigurationServer::answerRequest(zmq::socket_t& socket,
+		const std::string& identity, const std::string& msg,
+		const std::vector<std::string>& arguments)
+{
+	std::string modelName = identity;
+	if (!arguments.empty())
+	{
+		modelName = arguments.front();
+	}
+
+	// Changes of the membership need the exclusive lock
+	if (msg == "register")
+	{
+		// Arguments: name, address, persist ("1" or "0"), dependencies
+		std::string address = "localhost";
+		bool persist = false;
+		std::vector<std::string> dependencies;
+		if (arguments.size() > 1)
+		{
+			address = arguments[1];
+		}
+		if (arguments.size() > 2)
+		{
+			persist = (arguments[2] == "1");
+		}
+		for (size_t i = 3; i < arguments.size(); i++)
+		{
+			dependencies.push_back(arguments[i]);
+		}
+
+		std::string port = registerModel(modelName, address, persist,
+				dependencies);
+
+		s_sendmore(socket, identity);
+		s_send(socket, port);
+		return;
+	} else if (msg == "deregister")
+	{
+		bool success = deregisterModel(modelName);
+
+		s_sendmore(socket, identity);
+		s_send(socket, success ? "OK" : "");
+		return;
+	}
+
+	std::shared_lock<std::shared_timed_mutex> lock(mTablesMutex);
+
+	s_sendmore(socket, identity);
+	if (msg == "total_num_models")
+	{
+		s_send(socket, std::to_string(getNumberOfModels()));
+	} else if (msg == "num_persist_models")
+	{
+		s_send(socket, std::to_string(getNumberOfPersistModels()));
+	} else if (msg == "all_model_names")
+	{
+		v_send(socket, getModelNames());
+	} else if (msg == "model_dependencies")
+	{
+		v_send(socket, getModelDependencies(identity));
+	} else if (msg == "model_bundle")
+	{
+		s_send(socket, getModelBundle(modelName));
+	} else if (msg == "membership_epoch")
+	{
+		s_send(socket, std::to_string(getMembershipEpoch()));
+	} else if (msg == "config_version")
+	{
+		s_send(socket, getConfigurationVersion());
+	} else if (msg == "server_stats")
+	{
+		s_send(socket, getServerStatistics());
+	} else
+	{
+		s_send(socket, getModelInformation(msg));
+	}
+}
+
+void ConfigurationServer::stopServer()
+{
+	std::lock_guard<std::mutex> lock(mControllerMutex);
+
+	if (mRun)
+	{
+		mRun = false;
+		s_send(mController, "TERMINATE");
 	}
 }
@@ -15,20 +15,38 @@
 #define CONFIGURATION_SERVER_CONFIGURATIONSERVER_H_
 
 #include <map>
+#include <fstream>
+#include <sstream>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
 #include <zmq.hpp>
 #include <pugixml.hpp>
 #include <string>
+#include <flatbuffers/flatbuffers.h>
 
 #include "communication/zhelpers.hpp"
 #include "interfaces/IModel.h"
+#include "logging/LogRecord.h"
+#include "metrics/LatencyStatistics.h"
+#include "utilities/Hash.h"
+
+#include "resources/idl/configuration_generated.h"
 
 //  This is our external configuration server, which deals with requests and sends the requested IP or Port back to the client.
-//  The server can handle one request at time.
+//  The frontend (ROUTER) forwards the requests to a pool of worker threads (inproc DEALER), which handle them concurrently.
+//  All answers are computed once after loading the hosts-config file (immutable tables shared by the workers).
+//  The "model_bundle" request returns all information of a model at once (see configuration.fbs): the global entries
+//  and the entries of the model, its dependencies and the simulation model (of all models for the simulation model and
+//  the loggers).
+//  Models can join ("register") and leave ("deregister") at runtime, every change increments the membership epoch.
 
 class ConfigurationServer: public virtual IModel
 {
 public:
-	ConfigurationServer(std::string modelsConfigFilePath);
+	ConfigurationServer(std::string modelsConfigFilePath,
+			unsigned int numWorkers = 4);
 	virtual ~ConfigurationServer();
 
 	// IModel
@@ -47,14 +65,30 @@ public:
 	}
 
 	// Request Methods
-	int getNumberOfModels();
-	int getNumberOfPersistModels();
-	std::vector<std::string> getModelNames();
-	std::string getModelInformation(std::string request);
-	std::vector<std::string> getModelDependencies(std::string modelName);
+	int getNumberOfModels() const;
+	int getNumberOfPersistModels() const;
+	const std::vector<std::string>& getModelNames() const;
+	std::string getModelInformation(const std::string& request) const;
+	std::vector<std::string> getModelDependencies(
+			const std::string& modelName) const;
+	std::string getModelBundle(const std::string& modelName) const;
+	std::string getServerStatistics() const;
+	std::string getConfigurationVersion() const;
+	uint64_t getMembershipEpoch() const;
+
+	// Dynamic membership: Returns the assigned port (empty on failure).
+	// Persistent models are part of the savepoint barriers.
+	std::string registerModel(const std::string& modelName,
+			const std::string& address, bool persist,
+			const std::vector<std::string>& dependencies);
+	bool deregisterModel(const std::string& modelName);
 
 	// Get informations from xml-file
 	void setMinAndMaxPort();
+	void setModelNames();
+	void setModelDependencies();
+	// Parses an instance index, returns false if it is not a number
+	static bool parseIndex(const std::string& value, size_t& index);
 
 	// Set Port numbers
 	bool setModelPortNumbers();
@@ -62,23 +96,105 @@ public:
 	// Set IP addresses
 	void setModelIPAddresses();
 
+	// Set log severity thresholds (attribute logLevel of Model or Models)
+	void setModelLogLevels();
+
+	// Set the metrics reports (attributes statsInterval and metricsPath of
+	// Models)
+	void setModelMetrics();
+
+	// Set the end-to-end tracing (attributes tracePath and traceSampling of
+	// Models)
+	void setModelTracing();
+
+	// Set the model parameters (Parameter elements of Model)
+	void setModelParameters();
+
+	// Set the synchronization mode of all models (attribute syncMode of
+	// Models)
+	void setModelSynchronization();
+
+	// Set the savepoint format and restore (attributes savepointRegionSize
+	// and lazyRestore of Models)
+	void setModelSavepoints();
+
+	// Set the what-if branches (element Branches: attribute forkTime and the
+	// Parameter elements of each Branch)
+	void setModelBranches();
+
+	// Collect the keys of all bundles (after all other tables are set), the
+	// bundles are serialized at their first request
+	void setGlobalKeys();
+
 private:
+	// Worker thread: Handles requests until the server stops
+	void handleRequests();
+	void answerRequest(zmq::socket_t& socket, const std::string& identity,
+			const std::string& request,
+			const std::vector<std::string>& arguments);
+	void stopServer();
+
+	// Serializes the bundle of the model ("": unknown models)
+	std::string createModelBundle(const std::string& modelName) const;
+	static bool connectsToAllModels(const std::string& modelName);
+
+	// Hash of the hosts-config file and the membership epoch
+	uint64_t getVersion() const;
+
 	// IModel
 	std::string mName;
 	std::string mDescription;
 
 	zmq::context_t mCtx;
 	zmq::socket_t mFrontend;
+	zmq::socket_t mBackend;
+
+	// Terminates the proxy (shared by the workers)
+	zmq::socket_t mController;
+	std::mutex mControllerMutex;
+
+	unsigned int mNumWorkers;
+	std::vector<std::thread> mWorkers;
+	LatencyStatistics mLatencyStatistics;
 
 	pugi::xml_node mRootNode;
 	pugi::xml_document mDocument;
 
-	bool mRun = true;
+	std::atomic<bool> mRun
+	{ true };
 	int mMinPort = 0;
 	int mMaxPort = 0;
 
+	// Lookup tables (set in the constructor and changed only by joining or
+	// leaving models, which requires the exclusive lock)
+	mutable std::shared_timed_mutex mTablesMutex;
+	int mNumberOfModels = 0;
+	int mNumberOfPersistModels = 0;
 	std::vector<std::string> mModelNames;
 	std::map<std::string, std::string> mModelInformation;
+	std::map<std::string, std::vector<std::string>> mModelDependencies;
+	std::vector<std::string> mGlobalKeys;
+
+	// Serialized bundles (cleared on membership changes, since every bundle
+	// contains the model names and the version)
+	mutable std::map<std::string, std::string> mModelBundles;
+	mutable std::mutex mBundlesMutex;
+
+	// XML node of each model (instances of an array share the node)
+	std::map<std::string, pugi::xml_node> mModelNodes;
+	std::map<std::string, std::vector<std::string>> mModelArrays;
+
+	// Ports are assigned per host (address), starting at the min. port
+	int allocatePort(const std::string& hostAddress);
+	std::map<std::string, int> mNextPorts;
+	std::map<std::string, std::vector<int>> mReleasedPorts;
+
+	// Dynamic membership
+	uint64_t mMembershipEpoch = 0;
+	std::map<std::string, bool> mDynamicModels; // persist
+
+	// Hash of the hosts-config file, clients use it as key of their cache
+	uint64_t mConfigurationVersion = 0;
 	std::string mModelsConfigFilePath;
 };
 
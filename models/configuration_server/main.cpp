@@ -19,7 +19,14 @@ int main(int argc, char* argv[])
 	{
 		if (static_cast<std::string>(argv[1]) == "--config-file")
 		{
-			ConfigurationServer configServerModel(argv[2]);
+			// Number of worker threads (optional)
+			unsigned int numWorkers = 4;
+			if (argc > 4 && static_cast<std::string>(argv[3]) == "--workers")
+			{
+				numWorkers = std::stoul(argv[4]);
+			}
+
+			ConfigurationServer configServerModel(argv[2], numWorkers);
 			try
 			{
 				configServerModel.run();
@@ -40,6 +47,8 @@ int main(int argc, char* argv[])
 			std::cout << "<< Help >>" << std::endl;
 			std::cout << "--config-file CONFIG-PATH >> "
 					<< "Set path of models-configuration file" << std::endl;
+			std::cout << "--config-file CONFIG-PATH --workers NUM >> "
+					<< "Set number of worker threads (default: 4)" << std::endl;
 		} else
 		{
 			std::cout << " Invalid argument/s: --help" << std::endl;
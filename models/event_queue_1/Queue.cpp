@@ -13,15 +13,71 @@
 
 #include "Queue.h"
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
+
+// Upper bound of injection requests which are processed per simulation cycle
+#define MAX_INJECTION_REQUESTS_PER_CYCLE 16
 
 Queue::Queue(std::string name, std::string description) :
-		mName(name), mDescription(description), mCtx(1), mSubscriber(mCtx), mPublisher(
-				mCtx), mDealer(mCtx, mName), mReceivedEvent(NULL), mCurrentSimTime(
-				-1)
+		mName(name), mDescription(description), mEventNames(EventID::UNKNOWN), mCtx(
+				1), mMetrics(mName), mTracer(mName), mTimeline(mName), mFlightRecorder(
+				mName), mSubscriber(mCtx), mPublisher(mCtx, mMetrics, mTracer), mDealer(
+				mCtx, mName), mTickReporter(mCtx, mName), mInjector(mCtx,
+				ZMQ_ROUTER), mInjectionEnabled(false), mScheduledEvents(
+				"scheduled_events"), mInjectionSequence(0), mReceivedEvent(
+				NULL), mCurrentSimTime(-1)
 {
+	mEventNames.add("SimTimeChanged", EventID::SIM_TIME_CHANGED);
+	mEventNames.add("SimTimeHorizon", EventID::SIM_TIME_HORIZON);
+	mEventNames.add("TimeWarpHorizon", EventID::TIME_WARP_HORIZON);
+	mEventNames.add("GvtRequest", EventID::GVT_REQUEST);
+	mEventNames.add("End", EventID::END);
+	mEventNames.add("LoadState", EventID::LOAD_STATE);
+	mEventNames.add("SaveState", EventID::SAVE_STATE);
+	mEventNames.add("Fork", EventID::FORK);
+
+	// Messages below the threshold are not published
+	mLogLevel.apply(mName, mDealer.getLogLevel(mName));
+
+	// Metrics: stats topic and Prometheus text file (METRICS-PATH/NAME.prom)
+	mMetrics.addGauge(mScheduledEvents);
+	mMetrics.setAllocationMonitor(mAllocationMonitor);
+	mMetrics.setReportInterval(mDealer.getStatsInterval());
+	std::string metricsPath = mDealer.getMetricsPath();
+	if (!metricsPath.empty())
+	{
+		mMetrics.setPrometheusFile(metricsPath + mName + ".prom");
+	}
+
+	// End-to-end tracing: The events of the queue are the roots of the
+	// traced chains (TRACE-PATH/NAME.spans)
+	mTracer.setSampling(mDealer.getTraceSampling());
+	std::string tracePath = mDealer.getTracePath();
+	if (!tracePath.empty() && !mTracer.open(tracePath + mName + ".spans"))
+	{
+		std::cerr << mName << ": Could not open the span file in "
+				<< tracePath << std::endl;
+	}
+
+	// Timeline of the handlers and published events
+	// (TRACE-PATH/NAME.trace.json, see Timeline)
+	if (!tracePath.empty())
+	{
+		mTimeline.enable();
+		mTimelineFile = tracePath + mName + ".trace.json";
+	}
 
 	registerInterruptSignal();
+
+	// Flight recorder of the latest events, dumped on interrupts, crashes
+	// and critical simulation cycles (FLIGHT-RECORDER-PATH/NAME.flight)
+	mFlightRecorder.enable(mDealer.getFlightRecorderSize(),
+			mDealer.getFlightRecorderPath() + mName + ".flight");
+	mFlightRecorder.installSignalHandlers();
+	mPublisher.setFlightRecorder(mFlightRecorder);
+
 	mRun = prepare();
 	init();
 }
@@ -37,11 +93,32 @@ bool Queue::prepare()
 {
 	mSubscriber.setOwnershipName(mName);
 
+	if (mDealer.getSyncMode() == "conservative")
+	{
+		mSynchronizer.activate();
+	}
+
 	if (!mPublisher.bindSocket(mDealer.getPortNumFrom(mName)))
 	{
 		return false;
 	}
 
+	// Injection endpoint (only if enabled in the hosts-config file)
+	std::string injectionPort = mDealer.getInjectionPort(mName);
+	if (!injectionPort.empty())
+	{
+		try
+		{
+			mInjector.bind("tcp://*:" + injectionPort);
+		} catch (zmq::error_t& e)
+		{
+			std::cerr << mName << ": Could not bind injection endpoint"
+					<< std::endl;
+			return false;
+		}
+		mInjectionEnabled = true;
+	}
+
 	if (!mSubscriber.connectToPub(mDealer.getIPFrom("simulation_model"),
 			mDealer.getPortNumFrom("simulation_model")))
 	{
@@ -57,10 +134,17 @@ bool Queue::prepare()
 		}
 	}
 
-	mSubscriber.subscribeTo("SimTimeChanged");
-	mSubscriber.subscribeTo("End");
-	mSubscriber.subscribeTo("LoadState");
-	mSubscriber.subscribeTo("SaveState");
+	for (auto& eventName : mEventNames.getNames())
+	{
+		mSubscriber.subscribeTo(eventName);
+	}
+
+	// Tick reports to the simulation model (critical path)
+	if (!mTickReporter.connect(mDealer.getIPFrom("simulation_model"),
+			mDealer.getReportPort()))
+	{
+		return false;
+	}
 
 	// Synchronization
 	if (!mSubscriber.prepareSubSynchronization(
@@ -85,40 +169,301 @@ void Queue::run()
 		if (mSubscriber.receiveEvent())
 		{
 			handleEvent();
+			mScheduledEvents.set(mEventSet.size() + mInjectedEvents.size());
+		}
+
+		if (mMetrics.isReportDue())
+		{
+			publishMetrics();
 		}
 	}
 }
 
-void Queue::updateEvents()
+void Queue::publishMetrics()
 {
-	if (mEventSet.back().getRepeat() != 0)
+	mPublisher.publishEvent("Stats", mCurrentSimTime, mMetrics.getSummary());
+	mMetrics.writePrometheusFile();
+}
+
+// Moves the repeated events of the published range (the last numPublished
+// events) to their next timestamp and removes the others
+template<typename Events, typename EventOf>
+static bool rescheduleEvents(Events& events, size_t numPublished,
+		uint64_t currentSimTime, EventOf eventOf)
+{
+	auto firstDue = events.end() - numPublished;
+	auto kept = firstDue;
+	for (auto entry = firstDue; entry != events.end(); ++entry)
 	{
-		int timestamp = mCurrentSimTime + mEventSet.back().getPeriod();
-		mEventSet.back().setTimestamp(timestamp);
+		Event& event = eventOf(*entry);
+		if (event.getRepeat() == 0)
+		{
+			continue;
+		}
+
+		event.setTimestamp(currentSimTime + event.getPeriod());
+		if (event.getRepeat() != -1)
+		{
+			event.setRepeat(event.getRepeat() - 1);
+		}
 
-		if (mEventSet.back().getRepeat() != -1)
+		if (kept != entry)
 		{
-			mEventSet.back().setRepeat(mEventSet.back().getRepeat() - 1);
+			*kept = std::move(*entry);
 		}
+		++kept;
+	}
+	bool rescheduled = (kept != firstDue);
+	events.erase(kept, events.end());
+	return rescheduled;
+}
 
+void Queue::updateEvents()
+{
+	// Sorted once per cycle instead of once per published event
+	if (rescheduleEvents(mEventSet, mNumDueEvents, mCurrentSimTime,
+			[](Event& event) -> Event&
+			{
+				return event;
+			}))
+	{
 		mScheduler.scheduleEvents(mEventSet);
+	}
+	mNumDueEvents = 0;
+
+	if (rescheduleEvents(mInjectedEvents, mNumDueInjectedEvents,
+			mCurrentSimTime, [](InjectedEvent& injected) -> Event&
+			{
+				return injected.event;
+			}))
+	{
+		scheduleInjectedEvents();
+	}
+	mNumDueInjectedEvents = 0;
+}
+
+void Queue::scheduleInjectedEvents()
+{
+	// Next event at the back: high priority events first, then in the order
+	// of their injection
+	std::sort(mInjectedEvents.begin(), mInjectedEvents.end(),
+			[](const InjectedEvent& left, const InjectedEvent& right)
+			{
+				if (left.event.getTimestamp() != right.event.getTimestamp())
+				{
+					return left.event.getTimestamp()
+							> right.event.getTimestamp();
+				}
+				if (left.event.getPriority() != right.event.getPriority())
+				{
+					return left.event.getPriority() < right.event.getPriority();
+				}
+				return left.sequence > right.sequence;
+			});
+}
+
+bool Queue::getNextEventTime(uint64_t& timestamp) const
+{
+	if (mEventSet.empty() && mInjectedEvents.empty())
+	{
+		return false;
+	}
+
+	timestamp = std::numeric_limits<uint64_t>::max();
+	if (!mEventSet.empty())
+	{
+		timestamp = mEventSet.back().getTimestamp();
+	}
+	if (!mInjectedEvents.empty())
+	{
+		timestamp = std::min(timestamp,
+				mInjectedEvents.back().event.getTimestamp());
+	}
+	return true;
+}
+
+void Queue::handleInjectionRequests()
+{
+	if (!mInjectionEnabled)
+	{
+		return;
+	}
+
+	for (int i = 0; i < MAX_INJECTION_REQUESTS_PER_CYCLE; i++)
+	{
+		zmq::message_t identity;
+		if (!mInjector.recv(&identity, ZMQ_DONTWAIT))
+		{
+			// No pending requests
+			break;
+		}
+
+		// REQ clients send an additional empty delimiter frame
+		zmq::message_t request;
+		mInjector.recv(&request);
+		bool hasDelimiter = (request.size() == 0 && request.more());
+		if (hasDelimiter)
+		{
+			mInjector.recv(&request);
+		}
 
+		std::string identityStr(static_cast<char*>(identity.data()),
+				identity.size());
+
+		s_sendmore(mInjector, identityStr);
+		if (hasDelimiter)
+		{
+			s_sendmore(mInjector, "");
+		}
+
+		handleEventBatch(identityStr, request);
+	}
+}
+
+void Queue::handleEventBatch(const std::string& identity,
+		const zmq::message_t& request)
+{
+	ScopedLatency handlerLatency(
+			mMetrics.recordReceived("EventBatch", request.size()));
+
+	uint64_t batchID = 0;
+	uint32_t accepted = 0;
+	uint32_t rejected = 0;
+	uint64_t firstSequence = mInjectionSequence;
+
+	// The request is untrusted: The root offset is only read after the whole
+	// buffer was verified (EventBatch is not the root type of the schema)
+	auto buffer = static_cast<const uint8_t*>(request.data());
+	flatbuffers::Verifier verifier(buffer, request.size());
+	if (request.size() >= sizeof(flatbuffers::uoffset_t)
+			&& verifier.VerifyBuffer<event::EventBatch>(nullptr))
+	{
+		auto batch = flatbuffers::GetRoot<event::EventBatch>(buffer);
+		batchID = batch->batch_id();
+
+		if (batch->events() != nullptr)
+		{
+			mInjectedEvents.reserve(
+					mInjectedEvents.size() + batch->events()->size());
+
+			for (auto injectedEvent : *batch->events())
+			{
+				// Repeated events without period would be published endlessly
+				// in the same simulation cycle
+				if (injectedEvent->name() == nullptr
+						|| (injectedEvent->repeat() != 0
+								&& injectedEvent->period() == 0))
+				{
+					rejected++;
+					continue;
+				}
+
+				// Events without timestamp (or from the past) are published
+				// in the current simulation cycle
+				uint64_t timestamp = injectedEvent->timestamp();
+				if (timestamp < mCurrentSimTime
+						|| timestamp == std::numeric_limits<uint64_t>::max())
+				{
+					timestamp = mCurrentSimTime;
+				}
+
+				InjectedEvent injected;
+				injected.event = Event(injectedEvent->name()->str(), timestamp,
+						injectedEvent->period(), injectedEvent->repeat(),
+						static_cast<Priority>(injectedEvent->priority()));
+				injected.sequence = mInjectionSequence + accepted;
+
+				if (injectedEvent->event_data() != nullptr)
+				{
+					auto dataRef = injectedEvent->event_data_flexbuffer_root();
+					if (dataRef.IsString())
+					{
+						injected.hasPayload = true;
+						injected.payload = dataRef.ToString();
+					}
+				}
+				mInjectedEvents.push_back(std::move(injected));
+
+				accepted++;
+			}
+		}
+
+		// Sort once per batch instead of once per injected event
+		if (accepted > 0)
+		{
+			scheduleInjectedEvents();
+		}
 	} else
 	{
-		mEventSet.pop_back();
+		publishLog(LogSeverity::WARNING, mCurrentSimTime, mName,
+				": Received invalid event batch from ", identity);
 	}
+
+	mInjectionSequence += accepted;
+
+	mAckBuilder.Clear();
+	mAckBuilder.Finish(
+			event::CreateEventBatchAck(mAckBuilder, batchID, firstSequence,
+					accepted, rejected));
+
+	zmq::message_t reply(mAckBuilder.GetBufferPointer(), mAckBuilder.GetSize());
+	mInjector.send(reply);
+
+	// Log
+	publishLog(LogSeverity::INFO, mCurrentSimTime, mName, " injected ",
+			accepted, " events (batch ", batchID, ", rejected ", rejected, ")");
 }
 
 void Queue::handleEvent()
 {
+	ScopedAllocationCycle allocationCycle(mAllocationMonitor);
+
 	auto eventBuffer = mSubscriber.getEventBuffer();
 
 	auto receivedEvent = event::GetEvent(eventBuffer);
-	std::string eventName = receivedEvent->name()->str();
+	auto eventName = receivedEvent->name();
+	auto eventID = mEventNames.lookup(eventName);
+
+	// Metrics: payload bytes and duration of the handler
+	boost::string_view name =
+			eventName != nullptr ?
+					boost::string_view(eventName->c_str(), eventName->size()) :
+					boost::string_view();
+	size_t payloadSize = name.size()
+			+ (receivedEvent->event_data() != nullptr ?
+					receivedEvent->event_data()->size() : 0);
+	ScopedLatency handlerLatency(mMetrics.recordReceived(name, payloadSize));
+	ScopedFlightRecord flightRecord(mFlightRecorder, name,
+			receivedEvent->timestamp(), payloadSize);
+	ScopedSpan handlerSpan(mTimeline, Timeline::Kind::HANDLER, name,
+			receivedEvent->timestamp());
+
+	// GVT requests are repeated with the same timestamp until the GVT
+	// advances, hence they are not part of the simulation cycles
+	if (eventID == EventID::GVT_REQUEST)
+	{
+		// All events up to the current simulation time are published, but
+		// the events published since the last report could be in transit
+		uint64_t reportTime = std::min(mCurrentSimTime + 1, mMinSentTimestamp);
+		mMinSentTimestamp = std::numeric_limits<uint64_t>::max();
+		mPublisher.publishEvent("LvtReport", reportTime, mName);
+		return;
+	}
+
 	mCurrentSimTime = receivedEvent->timestamp();
 	mRun = !foundCriticalSimCycle(mCurrentSimTime);
+	if (!mRun)
+	{
+		mFlightRecorder.dump(FlightRecorder::CRITICAL_SIM_CYCLE);
+	}
 
-	if (eventName == "SaveState")
+	// Lazy restore: the events are decoded before their first use
+	if (mPendingState.isPending() && eventID != EventID::LOAD_STATE)
+	{
+		restorePendingState();
+	}
+
+	if (eventID == EventID::SAVE_STATE)
 	{
 		if (receivedEvent->event_data() != nullptr)
 		{
@@ -126,10 +471,10 @@ void Queue::handleEvent()
 			if (dataRef.IsString())
 			{
 				std::string configPath = dataRef.ToString();
-				saveState(configPath + mName + ".config");
+				saveState(configPath);
 			}
 		}
-	} else if (eventName == "LoadState")
+	} else if (eventID == EventID::LOAD_STATE)
 	{
 		if (receivedEvent->event_data() != nullptr)
 		{
@@ -137,87 +482,287 @@ void Queue::handleEvent()
 			if (dataRef.IsString())
 			{
 				std::string configPath = dataRef.ToString();
-				loadState(configPath + mName + ".config");
+				loadState(configPath);
 			}
 		}
-	} else if (eventName == "SimTimeChanged")
+	} else if (eventID == EventID::FORK)
 	{
-		// Send new Flit every clock cycle
-		if (!mEventSet.empty())
+		if (receivedEvent->event_data() != nullptr)
 		{
-			auto nextEvent = mEventSet.back();
-
-			if (mCurrentSimTime >= nextEvent.getTimestamp())
+			auto dataRef = receivedEvent->event_data_flexbuffer_root();
+			if (dataRef.IsString())
 			{
-				nextEvent.setCurrentSimTime(mCurrentSimTime);
+				forkBranches(std::atoi(dataRef.ToString().c_str()));
+			}
+		}
+	} else if (eventID == EventID::SIM_TIME_CHANGED)
+	{
+		mTickReporter.beginTick();
+		handleInjectionRequests();
+		publishDueEvents();
 
-				mPublisher.publishEvent(nextEvent.getName(), mCurrentSimTime);
+		mTickReporter.report(mCurrentSimTime);
 
-				// Log
-				mPublisher.publishEvent("LogInfo", mCurrentSimTime,
-						mName + " published " + nextEvent.getName());
+	} else if (eventID == EventID::SIM_TIME_HORIZON)
+	{
+		mTickReporter.beginTick();
+		mSynchronizer.setHorizon(mCurrentSimTime);
+		mCurrentSimTime = mSynchronizer.getLocalTime();
 
-				this->updateEvents();
-			}
+		handleInjectionRequests();
+
+		// Jump from event to event instead of stepping through all time steps
+		uint64_t nextEventTime;
+		while (getNextEventTime(nextEventTime)
+				&& nextEventTime <= mSynchronizer.getSafeTime())
+		{
+			mCurrentSimTime = nextEventTime;
+			publishDueEvents();
+
+			mPublisher.publishEvent("NullMessage", mCurrentSimTime, mName);
+		}
+
+		mSynchronizer.advanceLocalTime();
+		mCurrentSimTime = mSynchronizer.getLocalTime();
+		mPublisher.publishEvent("NullMessage", mSynchronizer.getPromise(),
+				mName);
+
+		if (mSynchronizer.reachedHorizon())
+		{
+			// The simulation model waits until all models reached the horizon
+			mTickReporter.report(mSynchronizer.getHorizon());
+			ScopedSpan syncSpan(mTimeline, Timeline::Kind::SYNC,
+					"HorizonSync", mSynchronizer.getHorizon());
+			mRun = mSubscriber.synchronizeSub();
+		}
+
+	} else if (eventID == EventID::TIME_WARP_HORIZON)
+	{
+		// Optimistic execution: The queue cannot receive stragglers, hence it
+		// publishes all events up to the horizon and never rolls back
+		uint64_t horizon = mCurrentSimTime;
+		mTickReporter.beginTick();
+		handleInjectionRequests();
+
+		// Jump from event to event instead of stepping through all time steps
+		uint64_t nextEventTime;
+		while (getNextEventTime(nextEventTime) && nextEventTime <= horizon)
+		{
+			mCurrentSimTime = nextEventTime;
+			publishDueEvents();
 		}
-	} else if (eventName == "End")
+
+		// Reported to the GVT computation
+		mCurrentSimTime = horizon;
+		mTickReporter.report(horizon);
+
+	} else if (eventID == EventID::END)
 	{
 		// Log
-		mPublisher.publishEvent("LogInfo", mCurrentSimTime,
-				mName + " received " + eventName);
+		publishLog(LogSeverity::INFO, mCurrentSimTime, mName, " received End");
+
+		publishLog(LogSeverity::INFO, mCurrentSimTime, mName, ": ",
+				mAllocationMonitor.getSummary());
 
+		publishMetrics();
+		if (mTimeline.isEnabled())
+		{
+			mTimeline.writeChromeTrace(mTimelineFile);
+		}
 		mRun = false;
 	}
 }
 
+void Queue::publishDueEvents()
+{
+	// Send all events which are due in this clock cycle: the ends of the
+	// sorted sets (each event at most once, even if it is rescheduled to this
+	// cycle)
+	mNumDueEvents = std::find_if(mEventSet.rbegin(), mEventSet.rend(),
+			[this](const Event& event)
+			{
+				return event.getTimestamp() > mCurrentSimTime;
+			}) - mEventSet.rbegin();
+	mNumDueInjectedEvents = std::find_if(mInjectedEvents.rbegin(),
+			mInjectedEvents.rend(), [this](const InjectedEvent& injected)
+			{
+				return injected.event.getTimestamp() > mCurrentSimTime;
+			}) - mInjectedEvents.rbegin();
+
+	for (auto event = mEventSet.rbegin();
+			event != mEventSet.rbegin() + mNumDueEvents; ++event)
+	{
+		publishEvent(*event, nullptr);
+	}
+
+	// Injected events after the configured events of the same cycle
+	for (auto injected = mInjectedEvents.rbegin();
+			injected != mInjectedEvents.rbegin() + mNumDueInjectedEvents;
+			++injected)
+	{
+		publishEvent(injected->event,
+				injected->hasPayload ? &injected->payload : nullptr);
+	}
+
+	// Rescheduled or removed at once
+	this->updateEvents();
+}
+
+void Queue::publishEvent(Event& event, const std::string* payload)
+{
+	event.setCurrentSimTime(mCurrentSimTime);
+
+	// Root of a causal chain (if traced)
+	mTracer.startTrace();
+
+	if (payload != nullptr)
+	{
+		mPublisher.publishEvent(event.getName(), mCurrentSimTime, *payload);
+
+		// The queue does not receive its own events
+		if (event.getName() == "SetLogLevel")
+		{
+			mLogLevel.apply(mName, *payload);
+		}
+	} else
+	{
+		mPublisher.publishEvent(event.getName(), mCurrentSimTime);
+	}
+
+	mTracer.endTrace();
+	mTimeline.mark(Timeline::Kind::PUBLISH, event.getName(), mCurrentSimTime);
+	mMinSentTimestamp = std::min(mMinSentTimestamp, mCurrentSimTime);
+
+	// Log
+	publishLog(LogSeverity::INFO, mCurrentSimTime, mName, " published ",
+			event.getName());
+}
+
+void Queue::forkBranches(int numBranches)
+{
+	// The simulation model forks after all models received the event
+	{
+		ScopedSpan syncSpan(mTimeline, Timeline::Kind::SYNC, "ForkSync",
+				mCurrentSimTime);
+		mRun = mSubscriber.synchronizeSub();
+	}
+
+	BranchFork::forkBranches(*this, numBranches, mName, mDescription);
+}
+
+void Queue::adoptBranch(Queue& parent, int branch)
+{
+	// The events of the forked instance are not used by the child anymore
+	mEventSet = std::move(parent.mEventSet);
+	mInjectedEvents = std::move(parent.mInjectedEvents);
+	mInjectionSequence = parent.mInjectionSequence;
+	mCurrentSimTime = parent.mCurrentSimTime;
+	mSynchronizer = parent.mSynchronizer;
+
+	mScheduler.scheduleEvents(mEventSet);
+	scheduleInjectedEvents();
+}
+
 void Queue::saveState(std::string filePath)
 {
 	// Store states
-	std::ofstream ofs(filePath);
-	boost::archive::xml_oarchive oa(ofs, boost::archive::no_header);
-
-	try
+	SavepointWriter writer(filePath, mName);
 	{
-		oa << boost::serialization::make_nvp("EventSet", mEventSet);
+		boost::archive::xml_oarchive oa(writer.getStream(),
+				boost::archive::no_header);
+		try
+		{
+			serialize(oa, 0);
 
-	} catch (boost::archive::archive_exception& ex)
+		} catch (boost::archive::archive_exception& ex)
+		{
+			// Log
+			publishLog(LogSeverity::ERROR, mCurrentSimTime, mName,
+					": Archive Exception during serializing");
+			throw ex.what();
+		}
+	}
+
+	// The other models continue (savepoint barrier)
+	if (!writer.commit())
 	{
 		// Log
-		mPublisher.publishEvent("LogError", mCurrentSimTime,
-				mName + ": Archive Exception during serializing");
-		throw ex.what();
+		publishLog(LogSeverity::ERROR, mCurrentSimTime, mName,
+				" could not write its state to ", filePath);
 	}
 
 	// Log
-	mPublisher.publishEvent("LogInfo", mCurrentSimTime,
-			mName + " stored its state");
+	publishLog(LogSeverity::INFO, mCurrentSimTime, mName, " stored its state");
 
+	ScopedSpan syncSpan(mTimeline, Timeline::Kind::SYNC, "SavepointSync",
+			mCurrentSimTime);
 	mRun = mSubscriber.synchronizeSub();
 }
 
 void Queue::loadState(std::string filePath)
 {
-	// Restore states
-	std::ifstream ifs(filePath);
-	boost::archive::xml_iarchive ia(ifs, boost::archive::no_header);
+	// Only the container index is read before the barrier
+	if (mDealer.getLazyRestore() && mPendingState.open(filePath, mName))
+	{
+		// Log
+		publishLog(LogSeverity::INFO, mCurrentSimTime, mName,
+				" mapped its state");
+	} else
+	{
+		mPendingState.close();
+
+		// Restore states
+		SavepointReader reader(filePath, mName);
+		{
+			boost::archive::xml_iarchive ia(reader.getStream(),
+					boost::archive::no_header);
+			try
+			{
+				serialize(ia, 0);
+
+			} catch (boost::archive::archive_exception& ex)
+			{
+				// Log
+				publishLog(LogSeverity::ERROR, mCurrentSimTime, mName,
+						": Archive Exception during deserializing");
+				throw ex.what();
+			}
+		}
 
+		// Log
+		publishLog(LogSeverity::INFO, mCurrentSimTime, mName,
+				" restored its state");
+
+		mScheduler.scheduleEvents(mEventSet);
+		scheduleInjectedEvents();
+	}
+
+	ScopedSpan syncSpan(mTimeline, Timeline::Kind::SYNC, "SavepointSync",
+			mCurrentSimTime);
+	mRun = mSubscriber.synchronizeSub();
+}
+
+void Queue::restorePendingState()
+{
 	try
 	{
-		ia >> boost::serialization::make_nvp("EventSet", mEventSet);
+		mPendingState.load([this](boost::archive::xml_iarchive& ia)
+		{
+			serialize(ia, 0);
+		});
 
 	} catch (boost::archive::archive_exception& ex)
 	{
 		// Log
-		mPublisher.publishEvent("LogError", mCurrentSimTime,
-				mName + ": Archive Exception during deserializing");
+		publishLog(LogSeverity::ERROR, mCurrentSimTime, mName,
+				": Archive Exception during deserializing");
 		throw ex.what();
 	}
 
 	// Log
-	mPublisher.publishEvent("LogInfo", mCurrentSimTime,
-			mName + " restored its state");
+	publishLog(LogSeverity::INFO, mCurrentSimTime, mName,
+			" restored its state");
 
 	mScheduler.scheduleEvents(mEventSet);
-
-	mRun = mSubscriber.synchronizeSub();
+	scheduleInjectedEvents();
 }
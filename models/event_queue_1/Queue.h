@@ -16,21 +16,37 @@
 
 #include <fstream>
 #include <functional>
+#include <limits>
+#include <boost/serialization/string.hpp>
 #include <boost/serialization/vector.hpp>
 #include <boost/archive/xml_iarchive.hpp>
 #include <boost/archive/xml_oarchive.hpp>
 #include <zmq.hpp>
 
-#include "communication/Dealer.h"
+#include "branching/BranchFork.h"
+#include "configuration/ConfigurationDealer.h"
 #include "communication/Publisher.h"
 #include "communication/Subscriber.h"
 #include "communication/zhelpers.hpp"
 #include "interfaces/IModel.h"
 #include "interfaces/IPersist.h"
 #include "interfaces/IQueue.h"
+#include "logging/LogLevel.h"
 #include "scheduler/Scheduler.h"
 #include "data-types/Event.h"
 #include "data-types/EventSet.h"
+#include "metrics/AllocationCounter.h"
+#include "metrics/ModelMetrics.h"
+#include "metrics/TickReporter.h"
+#include "pdes/ConservativeSynchronizer.h"
+#include "persistence/LazySavepointState.h"
+#include "persistence/SavepointStream.h"
+#include "tracing/FlightRecorder.h"
+#include "tracing/Timeline.h"
+#include "tracing/Tracer.h"
+#include "tracing/TracingPublisher.h"
+#include "utilities/EventNameTable.h"
+#include "utilities/MessageBuffer.h"
 
 #include "resources/idl/event_generated.h"
 
@@ -60,29 +76,127 @@ public:
 	virtual void saveState(std::string filePath) override;
 	virtual void loadState(std::string filePath) override;
 
+	// Continues the forked queue as the given branch (see BranchFork)
+	void adoptBranch(Queue& parent, int branch);
+
 private:
 	void handleEvent();
 
+	// Publishes all due events, then updates them at once (updateEvents)
+	void publishDueEvents();
+	void publishEvent(Event& event, const std::string* payload);
+	size_t mNumDueEvents = 0;
+	size_t mNumDueInjectedEvents = 0;
+
+	// Timestamp of the next configured or injected event (false if none)
+	bool getNextEventTime(uint64_t& timestamp) const;
+
+	// What-if branches: forks after the barrier of the Fork event
+	void forkBranches(int numBranches);
+
+	// Decodes the mapped state of the last restore
+	void restorePendingState();
+
+	// Event injection (ROUTER): External clients send an EventBatch and
+	// receive an EventBatchAck with the sequence numbers of the accepted events.
+	// Pending requests are processed at the beginning of each simulation cycle.
+	void handleInjectionRequests();
+	void handleEventBatch(const std::string& identity,
+			const zmq::message_t& request);
+
 	// IQueue
 	virtual void updateEvents() override;
 
 	EventSet mEventSet;
+	LazySavepointState mPendingState;
 
 	std::string mName;
 	std::string mDescription;
 
+	// Interned names of the subscribed events
+	enum class EventID
+	{
+		UNKNOWN,
+		SIM_TIME_CHANGED,
+		SIM_TIME_HORIZON,
+		TIME_WARP_HORIZON,
+		GVT_REQUEST,
+		END,
+		LOAD_STATE,
+		SAVE_STATE,
+		FORK
+	};
+	EventNameTable<EventID> mEventNames;
+
+	// Conservative execution: The queue has no input channels and publishes
+	// its events at their timestamps, hence it does not need a lookahead.
+	ConservativeSynchronizer<EventID> mSynchronizer;
+
 	friend class boost::serialization::access;
 	template<typename Archive>
 	void serialize(Archive& archive, const unsigned int)
 	{
 		archive & boost::serialization::make_nvp("EventSet", mEventSet);
+		archive
+				& boost::serialization::make_nvp("InjectedEvents",
+						mInjectedEvents);
 	}
 
 	// Subscriber & Publisher
 	zmq::context_t mCtx;
+	ModelMetrics mMetrics;
+	Tracer mTracer;
+	Timeline mTimeline;
+	std::string mTimelineFile;
+	FlightRecorder mFlightRecorder;
 	Subscriber mSubscriber;
-	Publisher mPublisher;
-	Dealer mDealer;
+	TracingPublisher mPublisher;
+	ConfigurationDealer mDealer;
+	TickReporter mTickReporter;
+	zmq::socket_t mInjector;
+	bool mInjectionEnabled;
+
+	// Stats topic and Prometheus text file
+	void publishMetrics();
+	Gauge mScheduledEvents;
+
+	// Injected events own their sequence number and payload (the events
+	// have no payload field). They are sorted like the event set (next event
+	// at the back), a repeated event keeps its payload for every publication.
+	struct InjectedEvent
+	{
+		Event event;
+		uint64_t sequence = 0;
+		bool hasPayload = false;
+		std::string payload;
+
+		template<typename Archive>
+		void serialize(Archive& archive, const unsigned int)
+		{
+			archive & boost::serialization::make_nvp("Event", event);
+			archive & boost::serialization::make_nvp("Sequence", sequence);
+			archive & boost::serialization::make_nvp("HasPayload", hasPayload);
+			archive & boost::serialization::make_nvp("Payload", payload);
+		}
+	};
+	std::vector<InjectedEvent> mInjectedEvents;
+	void scheduleInjectedEvents();
+	flatbuffers::FlatBufferBuilder mAckBuilder;
+	uint64_t mInjectionSequence;
+
+	// Hot path: reused log message and allocation statistics
+	LogLevel mLogLevel;
+	MessageBuffer mLogMessage;
+	AllocationMonitor mAllocationMonitor;
+
+	// Log messages of the model (see ::publishLog)
+	template<typename ... Parts>
+	void publishLog(LogSeverity severity, uint64_t simTime,
+			const Parts&... parts)
+	{
+		::publishLog(mPublisher, mLogLevel, mLogMessage, severity, simTime,
+				parts...);
+	}
 
 	bool mRun;
 	const event::Event* mReceivedEvent;
@@ -91,6 +205,10 @@ private:
 
 	Scheduler mScheduler;
 	uint64_t mCurrentSimTime;
+
+	// Lowest timestamp of the events published since the last GVT report
+	// (see TimeWarpEngine::getReportTime)
+	uint64_t mMinSentTimestamp = std::numeric_limits<uint64_t>::max();
 };
 
 #endif /* EVENT_QUEUE_1_QUEUE_H_ */
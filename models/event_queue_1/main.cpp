@@ -41,6 +41,7 @@ int main(int argc, char* argv[])
 				std::cerr << modelName + ": Interrupt received: Exit"
 						<< std::endl;
 			}
+			BranchFork::waitForBranches();
 		}
 	} else if (argc > 1)
 	{
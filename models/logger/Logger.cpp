@@ -11,6 +11,8 @@
  * - 2019, Annika Ofenloch (DLR RY-AVS)
  */
 
+#include <algorithm>
+#include <ctime>
 #include <iostream>
 #include "Logger.h"
 #include "ColorFormatter.h"
@@ -20,11 +22,29 @@ namespace sinks = boost::log::sinks;
 namespace keywords = boost::log::keywords;
 
 Logger::Logger(std::string name, std::string description,
-		std::string logFilePath) :
-		mName(name), mDescription(description), mCtx(1), mSubscriber(mCtx), mDealer(
-				mCtx, mName), mCurrentSimTime(0), mDebugMode("DebugMode",
-				false), mLogFilesPath(logFilePath)
+		LoggerSettings settings) :
+		mName(name), mDescription(description), mEventNames(EventID::UNKNOWN), mShardIndex(
+				0), mNumShards(1), mCtx(1), mSubscriber(mCtx), mDealer(mCtx,
+				mName), mConsoleOutput(false), mCurrentSimTime(0), mDebugMode(
+				"DebugMode", false), mFlushInterval("FlushInterval", 100), mSettings(
+				settings)
 {
+	mEventNames.add("LoadState", EventID::LOAD_STATE);
+	mEventNames.add("SaveState", EventID::SAVE_STATE);
+	mEventNames.add("LogTrace", EventID::LOG_TRACE);
+	mEventNames.add("LogDebug", EventID::LOG_DEBUG);
+	mEventNames.add("LogInfo", EventID::LOG_INFO);
+	mEventNames.add("LogWarning", EventID::LOG_WARNING);
+	mEventNames.add("LogError", EventID::LOG_ERROR);
+	mEventNames.add("LogFatal", EventID::LOG_FATAL);
+	mEventNames.add("SimTimeHorizon", EventID::SIM_TIME_HORIZON);
+	mEventNames.add("ModelJoined", EventID::MODEL_JOINED);
+	mEventNames.add("Stats", EventID::STATS);
+	mEventNames.add("StragglerSummary", EventID::STATS);
+	mEventNames.add("Fork", EventID::FORK);
+	mEventNames.add("EndLogger", EventID::END_LOGGER);
+
+	setShard();
 
 	registerInterruptSignal();
 	mRun = prepare();
@@ -32,17 +52,62 @@ Logger::Logger(std::string name, std::string description,
 	logging::register_simple_formatter_factory<logging::trivial::severity_level,
 			char>("Severity");
 
-	logging::add_file_log(
-			keywords::file_name = mLogFilesPath + "%Y-%m-%d_%H-%M-%S.log",
-			keywords::format = "[%TimeStamp%] [%Severity%] %Message%",
-			keywords::auto_flush = true);
+	// Log file: LOG-FILES-PATH/%Y-%m-%d_%H-%M-%S.log (or .flog),
+	// the files of the logger instances start with the instance name
+	// (LOG-FILES-PATH/branch_N/... in the branches)
+	char timeStamp[32];
+	std::time_t now = std::time(nullptr);
+	std::tm localTime;
+	localtime_r(&now, &localTime);
+	std::strftime(timeStamp, sizeof(timeStamp), "%Y-%m-%d_%H-%M-%S",
+			&localTime);
+
+	std::string filePath = mDealer.getBranchPath(mSettings.logFilesPath)
+			+ (mName != "logger" ? mName + "_" : "") + timeStamp
+			+ (mSettings.binaryFormat ? ".flog" : ".log");
+
+	bool opened = false;
+	if (mSettings.binaryFormat)
+	{
+		opened = mLogWriter.openBinary(filePath, mSettings.compress);
+
+		// Messages of the models start with the model name
+		for (auto& modelName : mDealer.getAllModelNames())
+		{
+			mLogWriter.addSource(modelName);
+		}
+	} else
+	{
+		opened = mLogWriter.open(filePath);
+	}
+
+	if (!opened)
+	{
+		std::cerr << mName << ": Could not open the log file " << filePath
+				<< std::endl;
+	}
+
+	mLogWriter.setFlushInterval(mFlushInterval.getValue());
+	mLogWriter.setRecordHandler([this](const LogRecord& record)
+	{
+		logToConsole(record);
+	});
+	mLogWriter.start();
 
 	logging::add_common_attributes();
 }
 
+Logger::~Logger()
+{
+	// Writes the pending records
+	mLogWriter.stop();
+}
+
 void Logger::init()
 {
-	if (mDebugMode.getValue())
+	mLogWriter.setFlushInterval(mFlushInterval.getValue());
+
+	if (mDebugMode.getValue() && !mConsoleOutput)
 	{
 		typedef sinks::synchronous_sink<sinks::text_ostream_backend> text_sink;
 		boost::shared_ptr<text_sink> sink = boost::make_shared<text_sink>();
@@ -55,6 +120,43 @@ void Logger::init()
 		sink->set_formatter(&coloringFormatter);
 
 		logging::core::get()->add_sink(sink);
+		mConsoleOutput = true;
+	}
+}
+
+void Logger::log(LogSeverity severity, boost::string_view message)
+{
+	mLogWriter.push(severity, message, mCurrentSimTime);
+}
+
+void Logger::logToConsole(const LogRecord& record)
+{
+	// Called by the writer thread (the boost.log core is thread-safe)
+	if (!mConsoleOutput)
+	{
+		return;
+	}
+
+	switch (record.severity)
+	{
+	case LogSeverity::TRACE:
+		BOOST_LOG_TRIVIAL(trace)<< record.message;
+		break;
+	case LogSeverity::DEBUG:
+		BOOST_LOG_TRIVIAL(debug) << record.message;
+		break;
+	case LogSeverity::INFO:
+		BOOST_LOG_TRIVIAL(info) << record.message;
+		break;
+	case LogSeverity::WARNING:
+		BOOST_LOG_TRIVIAL(warning) << record.message;
+		break;
+	case LogSeverity::ERROR:
+		BOOST_LOG_TRIVIAL(error) << record.message;
+		break;
+	case LogSeverity::FATAL:
+		BOOST_LOG_TRIVIAL(fatal) << record.message;
+		break;
 	}
 }
 
@@ -62,28 +164,29 @@ bool Logger::prepare()
 {
 	mSubscriber.setOwnershipName(mName);
 
-	// Connect to all models but not to itself
+	// Connect to the sources of this instance (the simulation model also
+	// publishes the control events of the logger)
 	for (auto depModel : mDealer.getAllModelNames())
 	{
-		if (depModel != mName)
+		if (isLoggerInstance(depModel)
+				|| (!ownsSource(depModel) && depModel != "simulation_model"))
 		{
-			if (!mSubscriber.connectToPub(mDealer.getIPFrom(depModel),
-					mDealer.getPortNumFrom(depModel)))
-			{
-				return false;
-			}
+			continue;
+		}
+
+		if (!connectToModel(depModel))
+		{
+			return false;
 		}
 	}
 
-	mSubscriber.subscribeTo("LoadState");
-	mSubscriber.subscribeTo("SaveState");
-	mSubscriber.subscribeTo("LogTrace");
-	mSubscriber.subscribeTo("LogDebug");
-	mSubscriber.subscribeTo("LogInfo");
-	mSubscriber.subscribeTo("LogWarning");
-	mSubscriber.subscribeTo("LogError");
-	mSubscriber.subscribeTo("LogFatal");
-	mSubscriber.subscribeTo("EndLogger");
+	for (auto& eventName : mEventNames.getNames())
+	{
+		if (isSelectedSeverity(eventName))
+		{
+			mSubscriber.subscribeTo(eventName);
+		}
+	}
 
 	// Synchronization
 	if (!mSubscriber.prepareSubSynchronization(
@@ -101,6 +204,112 @@ bool Logger::prepare()
 	return true;
 }
 
+void Logger::setShard()
+{
+	for (auto& modelName : mDealer.getAllModelNames())
+	{
+		if (!isLoggerInstance(modelName))
+		{
+			mSourceModels.insert(modelName);
+		}
+	}
+
+	// Instances of the array "logger": logger_0 ... logger_N-1
+	size_t separator = mName.rfind('_');
+	if (separator == std::string::npos
+			|| mName.compare(0, separator, "logger") != 0)
+	{
+		return;
+	}
+
+	try
+	{
+		mShardIndex = std::stoul(mName.substr(separator + 1));
+	} catch (std::exception& e)
+	{
+		return;
+	}
+
+	mNumShards = 0;
+	for (auto& modelName : mDealer.getAllModelNames())
+	{
+		if (isLoggerInstance(modelName))
+		{
+			mNumShards++;
+		}
+	}
+
+	if (mShardIndex >= mNumShards)
+	{
+		mShardIndex = 0;
+		mNumShards = 1;
+	}
+}
+
+bool Logger::isLoggerInstance(const std::string& modelName) const
+{
+	return modelName == "logger" || modelName.compare(0, 7, "logger_") == 0;
+}
+
+bool Logger::ownsSource(const std::string& modelName) const
+{
+	if (!mSettings.sources.empty())
+	{
+		return std::find(mSettings.sources.begin(), mSettings.sources.end(),
+				modelName) != mSettings.sources.end();
+	}
+
+	// The messages of the simulation model belong to the first instance
+	if (modelName == "simulation_model")
+	{
+		return mShardIndex == 0;
+	}
+
+	return Hash::fnv1a(modelName) % mNumShards == mShardIndex;
+}
+
+bool Logger::ownsMessage(boost::string_view message) const
+{
+	if (mNumShards == 1 && mSettings.sources.empty())
+	{
+		return true;
+	}
+
+	// The messages of the models start with the model name, the others are
+	// published by the simulation model (which is connected to all instances)
+	auto source = mSourceModels.find(
+			message.substr(0, message.find_first_of(": ")));
+	if (source != mSourceModels.end())
+	{
+		return ownsSource(*source);
+	}
+	return ownsSource("simulation_model");
+}
+
+bool Logger::isSelectedSeverity(const std::string& eventName) const
+{
+	if (mSettings.severities.empty() || eventName.compare(0, 3, "Log") != 0)
+	{
+		return true;
+	}
+
+	// LogTrace ... LogFatal
+	std::string level = eventName.substr(3);
+	std::transform(level.begin(), level.end(), level.begin(), ::tolower);
+
+	LogSeverity severity;
+	return parseSeverity(level, severity)
+			&& std::find(mSettings.severities.begin(),
+					mSettings.severities.end(), severity)
+					!= mSettings.severities.end();
+}
+
+bool Logger::connectToModel(const std::string& modelName)
+{
+	return mSubscriber.connectToPub(mDealer.getIPFrom(modelName),
+			mDealer.getPortNumFrom(modelName));
+}
+
 void Logger::run()
 {
 	while (mRun)
@@ -117,7 +326,7 @@ void Logger::handleEvent()
 	auto eventBuffer = mSubscriber.getEventBuffer();
 
 	auto receivedEvent = event::GetEvent(eventBuffer);
-	std::string eventName = receivedEvent->name()->str();
+	auto eventID = mEventNames.lookup(receivedEvent->name());
 	mCurrentSimTime = receivedEvent->timestamp();
 //	mRun = !foundCriticalSimCycle(mCurrentSimTime);
 
@@ -127,64 +336,151 @@ void Logger::handleEvent()
 
 		if (dataRef.IsString())
 		{
-			auto dataString = dataRef.ToString();
+			// Refers to the received buffer (no copy)
+			auto dataString = dataRef.AsString();
 
-			if (eventName == "SaveState")
+			if (eventID == EventID::SAVE_STATE)
+			{
+				saveState(dataString.str());
+			} else if (eventID == EventID::LOAD_STATE)
+			{
+				loadState(dataString.str());
+			} else if (eventID == EventID::FORK)
 			{
-				saveState(dataString + mName + ".config");
-			} else if (eventName == "LoadState")
+				forkBranches(std::atoi(dataString.c_str()));
+			} else if (eventID == EventID::MODEL_JOINED)
 			{
-				loadState(dataString + mName + ".config");
+				// The bundle of the dealer does not know the joined model yet
+				mDealer.refresh();
+				mSourceModels.insert(dataString.str());
+				mLogWriter.addSource(dataString.str());
+
+				if (ownsSource(dataString.str()))
+				{
+					connectToModel(dataString.str());
+				}
 			} else
 			{
+				ScopedAllocationCycle allocationCycle(mAllocationMonitor);
+
+				// Refers to the received buffer until it is copied into the
+				// ring buffer of the writer
+				boost::string_view message(dataString.c_str(),
+						dataString.length());
 
-				if (eventName == "LogTrace")
+				if (!ownsMessage(message))
 				{
-					BOOST_LOG_TRIVIAL(trace)<< dataString.data();
+					// Written by another logger instance
+				} else if (eventID == EventID::LOG_TRACE)
+				{
+					log(LogSeverity::TRACE, message);
 
-				} else if (eventName == "LogDebug")
+				} else if (eventID == EventID::LOG_DEBUG)
 				{
-					BOOST_LOG_TRIVIAL(debug) << dataString.data();
+					log(LogSeverity::DEBUG, message);
 
-				} else if (eventName == "LogInfo")
+				} else if (eventID == EventID::LOG_INFO)
 				{
-					BOOST_LOG_TRIVIAL(info) << dataString.data();
+					log(LogSeverity::INFO, message);
 
-				} else if (eventName == "LogWarning")
+				} else if (eventID == EventID::LOG_WARNING)
 				{
-					BOOST_LOG_TRIVIAL(warning) << dataString.data();
+					log(LogSeverity::WARNING, message);
 
-				} else if (eventName == "LogError")
+				} else if (eventID == EventID::LOG_ERROR)
 				{
-					BOOST_LOG_TRIVIAL(error) << dataString.data();
+					log(LogSeverity::ERROR, message);
 
-				} else if (eventName == "LogFatal")
+				} else if (eventID == EventID::LOG_FATAL)
 				{
-					BOOST_LOG_TRIVIAL(fatal) << dataString.data();
+					log(LogSeverity::FATAL, message);
 
+				} else if (eventID == EventID::STATS)
+				{
+					// Metrics or stragglers: one record per line
+					while (!message.empty())
+					{
+						size_t end = std::min(message.find('\n'),
+								message.size());
+						log(LogSeverity::INFO, message.substr(0, end));
+						message.remove_prefix(
+								std::min(end + 1, message.size()));
+					}
 				}
 			}
 		}
-	} else if (eventName == "EndLogger")
+	} else if (eventID == EventID::SIM_TIME_HORIZON)
 	{
+		// The logger does not advance in time, but it is part of the
+		// barrier of the conservative execution
+		mRun = mSubscriber.synchronizeSub();
+	} else if (eventID == EventID::END_LOGGER)
+	{
+		log(LogSeverity::INFO, mName + ": " + mAllocationMonitor.getSummary());
+		log(LogSeverity::INFO, mName + ": " + mLogWriter.getSummary());
+
+		// Guaranteed flush of all received records
+		mLogWriter.stop();
+
 		mRun = false;
 	}
 }
 
+void Logger::forkBranches(int numBranches)
+{
+	// The records up to the fork are written once (by the parent)
+	mLogWriter.flush();
+	mRun = mSubscriber.synchronizeSub();
+
+	BranchFork::forkBranches(*this, numBranches, mName, mDescription,
+			mSettings);
+}
+
+void Logger::adoptBranch(Logger& parent, int)
+{
+	// The console sink of the parent is part of the forked logging core
+	mConsoleOutput = parent.mConsoleOutput.load();
+	mCurrentSimTime = parent.mCurrentSimTime;
+	mSourceModels = parent.mSourceModels;
+
+	// Joined models of the parent (see MODEL_JOINED)
+	for (auto& modelName : mSourceModels)
+	{
+		mLogWriter.addSource(modelName);
+	}
+
+	mDebugMode.setValue(parent.mDebugMode.getValue());
+	mFlushInterval.setValue(parent.mFlushInterval.getValue());
+	init();
+}
+
 void Logger::saveState(std::string filePath)
 {
+	// The log file is complete up to the savepoint
+	mLogWriter.flush();
+
 	// Store states
-	std::ofstream ofs(filePath);
-	boost::archive::xml_oarchive oa(ofs, boost::archive::no_header);
-	try
+	SavepointWriter writer(filePath, mName);
 	{
-		oa << boost::serialization::make_nvp("FieldSet", *this);
+		boost::archive::xml_oarchive oa(writer.getStream(),
+				boost::archive::no_header);
+		try
+		{
+			oa << boost::serialization::make_nvp("FieldSet", *this);
 
-	} catch (boost::archive::archive_exception& ex)
+		} catch (boost::archive::archive_exception& ex)
+		{
+			std::cerr << mName << "Archive exception during serialization"
+					<< std::endl;
+			throw ex.what();
+		}
+	}
+
+	// The other models continue (savepoint barrier)
+	if (!writer.commit())
 	{
-		std::cerr << mName << "Archive exception during serialization"
+		std::cerr << mName << " could not write its state to " << filePath
 				<< std::endl;
-		throw ex.what();
 	}
 
 	mRun = mSubscriber.synchronizeSub();
@@ -193,17 +489,20 @@ void Logger::saveState(std::string filePath)
 void Logger::loadState(std::string filePath)
 {
 	// Restore states
-	std::ifstream ifs(filePath);
-	boost::archive::xml_iarchive ia(ifs, boost::archive::no_header);
-	try
+	SavepointReader reader(filePath, mName);
 	{
-		ia >> boost::serialization::make_nvp("FieldSet", *this);
+		boost::archive::xml_iarchive ia(reader.getStream(),
+				boost::archive::no_header);
+		try
+		{
+			ia >> boost::serialization::make_nvp("FieldSet", *this);
 
-	} catch (boost::archive::archive_exception& ex)
-	{
-		std::cerr << mName << "Archive exception during deserialization"
-				<< std::endl;
-		throw ex.what();
+		} catch (boost::archive::archive_exception& ex)
+		{
+			std::cerr << mName << "Archive exception during deserialization"
+					<< std::endl;
+			throw ex.what();
+		}
 	}
 
 	init();
@@ -27,26 +27,51 @@
 #include <boost/log/sinks/text_ostream_backend.hpp>
 
 #include <boost/serialization/serialization.hpp>
+#include <boost/serialization/version.hpp>
 #include <boost/archive/xml_oarchive.hpp>
 #include <boost/archive/xml_iarchive.hpp>
 
+#include <atomic>
+#include <set>
+#include <vector>
 #include <zmq.hpp>
 
 #include "communication/zhelpers.hpp"
 #include "communication/Subscriber.h"
 #include "communication/Publisher.h"
-#include "communication/Dealer.h"
+#include "branching/BranchFork.h"
+#include "configuration/ConfigurationDealer.h"
 #include "interfaces/IModel.h"
 #include "interfaces/IPersist.h"
 #include "data-types/Field.h"
+#include "logging/AsyncLogWriter.h"
+#include "metrics/AllocationCounter.h"
+#include "persistence/SavepointStream.h"
+#include "utilities/EventNameTable.h"
+#include "utilities/Hash.h"
 
 #include "resources/idl/event_generated.h"
 
+// Output and shard of a logger instance
+struct LoggerSettings
+{
+	std::string logFilesPath;
+	bool binaryFormat = false;
+	bool compress = false;
+
+	// Source models of the logger instance. If empty, the source models are
+	// distributed among the logger instances (array "logger") by their name
+	std::vector<std::string> sources;
+
+	// Severities of the logger instance (empty: all)
+	std::vector<LogSeverity> severities;
+};
+
 class Logger: public virtual IModel, public virtual IPersist
 {
 public:
-	Logger(std::string name, std::string description, std::string logFilePath);
-	virtual ~Logger() = default;
+	Logger(std::string name, std::string description, LoggerSettings settings);
+	virtual ~Logger();
 
 	// IModel
 	virtual void init() override;
@@ -66,31 +91,87 @@ public:
 	virtual void saveState(std::string filename) override;
 	virtual void loadState(std::string filename) override;
 
+	// Continues the forked logger as the given branch (see BranchFork)
+	void adoptBranch(Logger& parent, int branch);
+
 private:
 	// IModel
 	std::string mName;
 	std::string mDescription;
 
+	// Interned names of the subscribed events
+	enum class EventID
+	{
+		UNKNOWN,
+		LOAD_STATE,
+		SAVE_STATE,
+		LOG_TRACE,
+		LOG_DEBUG,
+		LOG_INFO,
+		LOG_WARNING,
+		LOG_ERROR,
+		LOG_FATAL,
+		SIM_TIME_HORIZON,
+		MODEL_JOINED,
+		STATS,
+		FORK,
+		END_LOGGER
+	};
+	EventNameTable<EventID> mEventNames;
+
 	// Subscriber
 	void handleEvent();
+	bool connectToModel(const std::string& modelName);
+
+	// What-if branches: forks after the barrier of the Fork event
+	void forkBranches(int numBranches);
+
+	// Sharding: each logger instance receives the messages of its sources
+	void setShard();
+	bool isLoggerInstance(const std::string& modelName) const;
+	bool ownsSource(const std::string& modelName) const;
+	bool ownsMessage(boost::string_view message) const;
+	bool isSelectedSeverity(const std::string& eventName) const;
+	size_t mShardIndex;
+	size_t mNumShards;
+	std::set<std::string, std::less<>> mSourceModels;
 	zmq::context_t mCtx;
 	Subscriber mSubscriber;
-	Dealer mDealer;
+	ConfigurationDealer mDealer;
+
+	AllocationMonitor mAllocationMonitor;
+
+	// Log records are written by the background thread of the writer
+	void log(LogSeverity severity, boost::string_view message);
+	void logToConsole(const LogRecord& record);
+	AsyncLogWriter mLogWriter;
+	std::atomic<bool> mConsoleOutput;
 
 	bool mRun;
 	uint64_t mCurrentSimTime;
 
 	friend class boost::serialization::access;
 	template<typename Archive>
-	void serialize(Archive& archive, const unsigned int)
+	void serialize(Archive& archive, const unsigned int version)
 	{
 		archive & boost::serialization::make_nvp("DebugMode", mDebugMode);
+
+		if (version > 0)
+		{
+			archive
+					& boost::serialization::make_nvp("FlushInterval",
+							mFlushInterval);
+		}
 	}
 
 	// Fields
 	Field<bool> mDebugMode;
+	Field<uint32_t> mFlushInterval; // ms
 
-	std::string mLogFilesPath;
+	LoggerSettings mSettings;
 };
 
+// Version 1: FlushInterval
+BOOST_CLASS_VERSION(Logger, 1)
+
 #endif
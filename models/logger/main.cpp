@@ -11,6 +11,8 @@
  * - 2019, Annika Ofenloch (DLR RY-AVS)
  */
 
+#include <boost/algorithm/string.hpp>
+
 #include "Logger.h"
 
 int main(int argc, const char * argv[])
@@ -19,14 +21,61 @@ int main(int argc, const char * argv[])
 	{
 		if (static_cast<std::string>(argv[1]) == "--log-files-path")
 		{
-			Logger logger("logger", "Log messages to the log file", argv[2]);
-			try
+			bool validArgs = true;
+			std::string name = "logger";
+			LoggerSettings settings;
+			settings.logFilesPath = static_cast<std::string>(argv[2]);
+
+			for (int i = 3; validArgs && i + 1 < argc; i += 2)
+			{
+				std::string option = static_cast<std::string>(argv[i]);
+				std::string value = static_cast<std::string>(argv[i + 1]);
+				if (option == "-n")
+				{
+					name = value;
+				} else if (option == "--sources")
+				{
+					boost::split(settings.sources, value, boost::is_any_of(","));
+				} else if (option == "--severities")
+				{
+					std::vector<std::string> levels;
+					boost::split(levels, value, boost::is_any_of(","));
+					for (auto& level : levels)
+					{
+						LogSeverity severity;
+						validArgs = validArgs && parseSeverity(level, severity);
+						settings.severities.push_back(severity);
+					}
+				} else if (option == "--log-format"
+						&& (value == "text" || value == "binary"))
+				{
+					settings.binaryFormat = (value == "binary");
+				} else if (option == "--compression"
+						&& (value == "zlib" || value == "none"))
+				{
+					settings.compress = (value == "zlib");
+				} else
+				{
+					validArgs = false;
+				}
+			}
+
+			if (validArgs && argc % 2 == 1)
 			{
-				logger.run();
+				Logger logger(name, "Log messages to the log file", settings);
+				try
+				{
+					logger.run();
 
-			} catch (zmq::error_t& e)
+				} catch (zmq::error_t& e)
+				{
+					std::cerr << name << ": Interrupt received: Exit"
+							<< std::endl;
+				}
+				BranchFork::waitForBranches();
+			} else
 			{
-				std::cerr << "Logger: Interrupt received: Exit" << std::endl;
+				std::cout << " Invalid argument/s: --help" << std::endl;
 			}
 		} else
 		{
@@ -39,6 +88,15 @@ int main(int argc, const char * argv[])
 			std::cout << "<< Help >>" << std::endl;
 			std::cout << "--log-files-path LOG-FILES-PATH >> "
 					<< "Save log-files in LOG-FILES-PATH" << std::endl;
+			std::cout << "--log-files-path LOG-FILES-PATH --log-format binary "
+					<< "[--compression zlib] >> "
+					<< "Save binary log-files (*.flog, see fraser-logcat)"
+					<< std::endl;
+			std::cout << "--log-files-path LOG-FILES-PATH -n NAME "
+					<< "[--sources MODEL,...] [--severities LEVEL,...] >> "
+					<< "Run a logger instance (array \"logger\" in the "
+					<< "hosts-config file) for some source models or severities"
+					<< std::endl;
 		} else
 		{
 			std::cout << " Invalid argument/s: --help" << std::endl;
@@ -16,6 +16,7 @@
 
 #include <fstream>
 #include <boost/serialization/serialization.hpp>
+#include <boost/serialization/version.hpp>
 #include <boost/archive/xml_oarchive.hpp>
 #include <boost/archive/xml_iarchive.hpp>
 #include <zmq.hpp>
@@ -23,10 +24,25 @@
 #include "communication/zhelpers.hpp"
 #include "communication/Subscriber.h"
 #include "communication/Publisher.h"
-#include "communication/Dealer.h"
+#include "branching/BranchFork.h"
+#include "configuration/ConfigurationDealer.h"
 #include "interfaces/IModel.h"
 #include "interfaces/IPersist.h"
 #include "data-types/Field.h"
+#include "logging/LogLevel.h"
+#include "metrics/AllocationCounter.h"
+#include "metrics/ModelMetrics.h"
+#include "metrics/TickReporter.h"
+#include "pdes/ConservativeSynchronizer.h"
+#include "persistence/SavepointStream.h"
+#include "reflection/FieldRegistry.h"
+#include "timewarp/TimeWarpEngine.h"
+#include "tracing/FlightRecorder.h"
+#include "tracing/Timeline.h"
+#include "tracing/Tracer.h"
+#include "tracing/TracingPublisher.h"
+#include "utilities/EventNameTable.h"
+#include "utilities/MessageBuffer.h"
 
 #include "resources/idl/event_generated.h"
 
@@ -54,27 +70,112 @@ public:
 	void saveState(std::string filename);
 	void loadState(std::string filename);
 
+	// Continues the forked model as the given branch (see BranchFork)
+	void adoptBranch(Model1& parent, int branch);
+
 private:
 	// IModel
 	std::string mName;
 	std::string mDescription;
 
+	// Interned names of the subscribed events
+	enum class EventID
+	{
+		UNKNOWN,
+		LOAD_STATE,
+		SAVE_STATE,
+		END,
+		SIM_TIME_HORIZON,
+		SIM_TIME_CHANGED,
+		NULL_MESSAGE,
+		TIME_WARP_HORIZON,
+		GVT_REQUEST,
+		GVT_UPDATE,
+		ANTI_MESSAGE,
+		SET_LOG_LEVEL,
+		FORK,
+		PCDU_COMMAND,
+		FIRST_EVENT,
+		RETURN_EVENT
+	};
+	EventNameTable<EventID> mEventNames;
+
 	// Subscriber
 	void handleEvent();
+	void processEvent(EventID eventID, uint64_t timestamp);
+
+	// What-if branches: forks after the barrier of the Fork event
+	void forkBranches(int numBranches);
+
+	// Conservative execution (see ConservativeSynchronizer)
+	void advanceConservatively();
+	ConservativeSynchronizer<EventID> mSynchronizer;
+
+	// Optimistic execution (see TimeWarpEngine)
+	void advanceOptimistically();
+	void publishModelEvent(const std::string& eventName, uint64_t timestamp);
+	std::string takeSnapshot();
+	void restoreSnapshot(const std::string& snapshot);
+	TimeWarpEngine<EventID> mTimeWarp;
+	uint64_t mNumGvtUpdates;
+
 	zmq::context_t mCtx;
+	ModelMetrics mMetrics;
+	Tracer mTracer;
+	Timeline mTimeline;
+	std::string mTimelineFile;
+	FlightRecorder mFlightRecorder;
 	Subscriber mSubscriber;
-	Publisher mPublisher;
-	Dealer mDealer;
+	TracingPublisher mPublisher;
+	ConfigurationDealer mDealer;
+	TickReporter mTickReporter;
+
+	// Stats topic and Prometheus text file
+	void publishMetrics();
+	Gauge mPendingEvents;
+
+	// Hot path: reused log message and allocation statistics
+	LogLevel mLogLevel;
+	MessageBuffer mLogMessage;
+	AllocationMonitor mAllocationMonitor;
+
+	// Log messages of the model (see ::publishLog)
+	template<typename ... Parts>
+	void publishLog(LogSeverity severity, uint64_t simTime,
+			const Parts&... parts)
+	{
+		::publishLog(mPublisher, mLogLevel, mLogMessage, severity, simTime,
+				parts...);
+	}
 
 	bool mRun;
 	int mCurrentSimTime;
 
 	friend class boost::serialization::access;
 	template<typename Archive>
-	void serialize(Archive& archive, const unsigned int)
+	void serialize(Archive& archive, const unsigned int version)
 	{
+		if (version > 0)
+		{
+			mFields.serialize(archive);
+		}
 
+		if (version > 1)
+		{
+			archive
+					& boost::serialization::make_nvp("Synchronizer",
+							mSynchronizer);
+		}
 	}
+
+	// Fields (savepoints and snapshots)
+	Field<uint32_t> mLookahead;
+	FieldRegistry mFields
+	{ mLookahead };
 };
 
+// Version 1: Lookahead
+// Version 2: Buffered events of the conservative execution
+BOOST_CLASS_VERSION(Model1, 2)
+
 #endif
@@ -11,6 +11,8 @@
  * - 2017-2019, Annika Ofenloch (DLR RY-AVS)
  */
 
+#include <boost/algorithm/string.hpp>
+
 #include "Model_1.h"
 
 int main(int argc, const char * argv[])
@@ -29,6 +31,35 @@ int main(int argc, const char * argv[])
 			std::cout << " Invalid argument/s: --help" << std::endl;
 		}
 
+		// Join a running simulation (model is not part of the hosts-config file)
+		bool join = false;
+		std::string joinAddress = "localhost";
+		std::vector<std::string> dependencies;
+
+		for (int i = 3; validArgs && i + 1 < argc; i += 2)
+		{
+			std::string option = static_cast<std::string>(argv[i]);
+			if (option == "--join")
+			{
+				join = true;
+				joinAddress = static_cast<std::string>(argv[i + 1]);
+			} else if (option == "--depends")
+			{
+				boost::split(dependencies, argv[i + 1], boost::is_any_of(","));
+			} else
+			{
+				validArgs = false;
+				std::cout << " Invalid argument/s: --help" << std::endl;
+			}
+		}
+
+		if (validArgs && join)
+		{
+			// The model takes part in the savepoints (IPersist)
+			ConfigurationDealer::setJoinRequest(joinAddress, dependencies,
+					true);
+		}
+
 		if (validArgs)
 		{
 			Model1 model_1(modelName, "Test Model 1");
@@ -41,6 +72,7 @@ int main(int argc, const char * argv[])
 				std::cerr << modelName + ": Interrupt received: Exit"
 						<< std::endl;
 			}
+			BranchFork::waitForBranches();
 		}
 	} else if (argc > 1)
 	{
@@ -49,6 +81,9 @@ int main(int argc, const char * argv[])
 			std::cout << "<< Help >>" << std::endl;
 			std::cout << "-n NAME >> " << "Set instance name of Model1"
 					<< std::endl;
+			std::cout << "-n NAME --join ADDRESS [--depends MODEL,...] >> "
+					<< "Join a running simulation (ADDRESS of the host)"
+					<< std::endl;
 		} else
 		{
 			std::cout << " Invalid argument/s: --help" << std::endl;
@@ -15,11 +15,73 @@
 #include "Model_2.h"
 
 Model2::Model2(std::string name, std::string description) :
-		mName(name), mDescription(description), mCtx(1), mSubscriber(mCtx), mPublisher(
-				mCtx), mDealer(mCtx, mName), mCurrentSimTime(0)
+		mName(name), mDescription(description), mEventNames(EventID::UNKNOWN), mTimeWarp(
+				mName), mNumGvtUpdates(0), mCtx(1), mMetrics(mName), mTracer(
+				mName), mTimeline(mName), mFlightRecorder(mName), mSubscriber(
+				mCtx), mPublisher(mCtx, mMetrics, mTracer), mDealer(mCtx, mName), mTickReporter(
+				mCtx, mName), mPendingEvents("pending_events"), mCurrentSimTime(
+				0), mLookahead("Lookahead", 100)
 {
+	mEventNames.add("LoadState", EventID::LOAD_STATE);
+	mEventNames.add("SaveState", EventID::SAVE_STATE);
+	mEventNames.add("End", EventID::END);
+	mEventNames.add("SimTimeHorizon", EventID::SIM_TIME_HORIZON);
+	mEventNames.add("SimTimeChanged", EventID::SIM_TIME_CHANGED);
+	mEventNames.add("NullMessage", EventID::NULL_MESSAGE);
+	mEventNames.add("TimeWarpHorizon", EventID::TIME_WARP_HORIZON);
+	mEventNames.add("GvtRequest", EventID::GVT_REQUEST);
+	mEventNames.add("GvtUpdate", EventID::GVT_UPDATE);
+	mEventNames.add("AntiMessage", EventID::ANTI_MESSAGE);
+	mEventNames.add("SetLogLevel", EventID::SET_LOG_LEVEL);
+	mEventNames.add("Fork", EventID::FORK);
+	mEventNames.add("PCDUCommand", EventID::PCDU_COMMAND);
+	mEventNames.add("SubsequentEvent", EventID::SUBSEQUENT_EVENT);
+
+	mTimeWarp.setSnapshotFunctions([this]()
+	{	return takeSnapshot();}, [this](const std::string& snapshot)
+	{	restoreSnapshot(snapshot);});
+	mTimeWarp.setCancelFunction(
+			[this](const std::string&, uint64_t timestamp,
+					const std::string& messageID)
+			{	mPublisher.publishEvent("AntiMessage", timestamp, messageID);});
+
+	// Messages below the threshold are not published
+	mLogLevel.apply(mName, mDealer.getLogLevel(mName));
+
+	// Metrics: stats topic and Prometheus text file (METRICS-PATH/NAME.prom)
+	mMetrics.addGauge(mPendingEvents);
+	mMetrics.setAllocationMonitor(mAllocationMonitor);
+	mMetrics.setReportInterval(mDealer.getStatsInterval());
+	std::string metricsPath = mDealer.getMetricsPath();
+	if (!metricsPath.empty())
+	{
+		mMetrics.setPrometheusFile(metricsPath + mName + ".prom");
+	}
+
+	// End-to-end tracing: spans of the traced events (TRACE-PATH/NAME.spans)
+	std::string tracePath = mDealer.getTracePath();
+	if (!tracePath.empty() && !mTracer.open(tracePath + mName + ".spans"))
+	{
+		std::cerr << mName << ": Could not open the span file in "
+				<< tracePath << std::endl;
+	}
+
+	// Timeline of the handlers (TRACE-PATH/NAME.trace.json, see Timeline)
+	if (!tracePath.empty())
+	{
+		mTimeline.enable();
+		mTimelineFile = tracePath + mName + ".trace.json";
+	}
 
 	registerInterruptSignal();
+
+	// Flight recorder of the latest events, dumped on interrupts, crashes
+	// and critical simulation cycles (FLIGHT-RECORDER-PATH/NAME.flight)
+	mFlightRecorder.enable(mDealer.getFlightRecorderSize(),
+			mDealer.getFlightRecorderPath() + mName + ".flight");
+	mFlightRecorder.installSignalHandlers();
+	mPublisher.setFlightRecorder(mFlightRecorder);
+
 	mRun = prepare();
 	init();
 }
@@ -27,12 +89,19 @@ Model2::Model2(std::string name, std::string description) :
 void Model2::init()
 {
 	// Set or calculate other parameters ...
+	mSynchronizer.setLookahead(mLookahead.getValue());
 }
 
 bool Model2::prepare()
 {
 	mSubscriber.setOwnershipName(mName);
 
+	// Events before the first horizon are buffered as well
+	if (mDealer.getSyncMode() == "conservative")
+	{
+		mSynchronizer.activate();
+	}
+
 	if (!mPublisher.bindSocket(mDealer.getPortNumFrom(mName)))
 	{
 		return false;
@@ -51,13 +120,21 @@ bool Model2::prepare()
 		{
 			return false;
 		}
+
+		mSynchronizer.addChannel(depModel);
+	}
+
+	for (auto& eventName : mEventNames.getNames())
+	{
+		mSubscriber.subscribeTo(eventName);
 	}
 
-	mSubscriber.subscribeTo("LoadState");
-	mSubscriber.subscribeTo("SaveState");
-	mSubscriber.subscribeTo("End");
-	mSubscriber.subscribeTo("PCDUCommand");
-	mSubscriber.subscribeTo("SubsequentEvent");
+	// Tick reports to the simulation model (critical path)
+	if (!mTickReporter.connect(mDealer.getIPFrom("simulation_model"),
+			mDealer.getReportPort()))
+	{
+		return false;
+	}
 
 	// Synchronization
 	if (!mSubscriber.prepareSubSynchronization(
@@ -82,32 +159,129 @@ void Model2::run()
 		if (mSubscriber.receiveEvent())
 		{
 			handleEvent();
+			mPendingEvents.set(mSynchronizer.getNumberOfPendingEvents());
+		}
+
+		if (mMetrics.isReportDue())
+		{
+			publishMetrics();
 		}
 	}
 }
 
+void Model2::publishMetrics()
+{
+	mPublisher.publishEvent("Stats", mCurrentSimTime, mMetrics.getSummary());
+	mMetrics.writePrometheusFile();
+}
+
 void Model2::handleEvent()
 {
+	ScopedAllocationCycle allocationCycle(mAllocationMonitor);
+
 	auto eventBuffer = mSubscriber.getEventBuffer();
 
 	auto receivedEvent = event::GetEvent(eventBuffer);
-	std::string eventName = receivedEvent->name()->str();
+	auto eventName = receivedEvent->name();
+	auto eventID = mEventNames.lookup(eventName);
+
+	// Metrics: payload bytes and duration of the handler
+	boost::string_view name =
+			eventName != nullptr ?
+					boost::string_view(eventName->c_str(), eventName->size()) :
+					boost::string_view();
+	size_t payloadSize = name.size()
+			+ (receivedEvent->event_data() != nullptr ?
+					receivedEvent->event_data()->size() : 0);
+	ScopedLatency handlerLatency(mMetrics.recordReceived(name, payloadSize));
+	ScopedFlightRecord flightRecord(mFlightRecorder, name,
+			receivedEvent->timestamp(), payloadSize);
+
+	// Events published by the handler continue the trace of the event
+	TraceScope traceScope(mTracer, receivedEvent);
+	ScopedSpan handlerSpan(mTimeline, Timeline::Kind::HANDLER, name,
+			receivedEvent->timestamp());
+
+	// Null messages only carry the promise of the publishing model
+	if (eventID == EventID::NULL_MESSAGE)
+	{
+		auto dataRef = receivedEvent->event_data_flexbuffer_root();
+		if (receivedEvent->event_data() != nullptr && dataRef.IsString())
+		{
+			auto sourceModel = dataRef.AsString();
+			mSynchronizer.updateChannel(
+					boost::string_view(sourceModel.c_str(),
+							sourceModel.length()), receivedEvent->timestamp());
+			advanceConservatively();
+		}
+		return;
+	}
+
+	// Log level changes are not part of the simulation cycles
+	if (eventID == EventID::SET_LOG_LEVEL)
+	{
+		auto dataRef = receivedEvent->event_data_flexbuffer_root();
+		if (receivedEvent->event_data() != nullptr && dataRef.IsString())
+		{
+			auto setting = dataRef.AsString();
+			mLogLevel.apply(mName,
+					boost::string_view(setting.c_str(), setting.length()));
+		}
+		return;
+	}
+
+	// Time-stepped execution: The events of the previous ticks are processed
+	// in order, hence the model reached the tick when it receives it
+	if (eventID == EventID::SIM_TIME_CHANGED)
+	{
+		mTickReporter.report(receivedEvent->timestamp());
+		return;
+	}
+
+	// Control events of the optimistic execution are not part of the
+	// simulation cycles (their timestamps are not monotonic)
+	if (eventID == EventID::GVT_REQUEST)
+	{
+		mPublisher.publishEvent("LvtReport", mTimeWarp.getReportTime(), mName);
+		return;
+	} else if (eventID == EventID::GVT_UPDATE)
+	{
+		mTimeWarp.collectFossils(receivedEvent->timestamp());
+
+		if (++mNumGvtUpdates % 10 == 0)
+		{
+			// Log
+			publishLog(LogSeverity::INFO, receivedEvent->timestamp(), mName,
+					": ", mTimeWarp.getSummary());
+		}
+		return;
+	} else if (eventID == EventID::ANTI_MESSAGE)
+	{
+		auto dataRef = receivedEvent->event_data_flexbuffer_root();
+		if (receivedEvent->event_data() != nullptr && dataRef.IsString())
+		{
+			mTimeWarp.receiveAntiMessage(dataRef.ToString());
+			advanceOptimistically();
+		}
+		return;
+	}
+
 	mCurrentSimTime = receivedEvent->timestamp();
 
 	if (foundCriticalSimCycle(mCurrentSimTime))
 	{
 		mRun = false;
-		mPublisher.publishEvent("LogError", mCurrentSimTime,
-				mName
-						+ ": Multiple delta cycles are running. Current simulation time: "
-						+ std::to_string(mCurrentSimTime));
+		mFlightRecorder.dump(FlightRecorder::CRITICAL_SIM_CYCLE);
+		publishLog(LogSeverity::ERROR, mCurrentSimTime, mName,
+				": Multiple delta cycles are running. Current simulation time: ",
+				mCurrentSimTime);
 	}
 
 	// Log
-	mPublisher.publishEvent("LogInfo", mCurrentSimTime,
-			mName + " received " + eventName);
+	publishLog(LogSeverity::INFO, mCurrentSimTime, mName, " received ",
+			boost::string_view(eventName->c_str(), eventName->size()));
 
-	if (eventName == "SaveState")
+	if (eventID == EventID::SAVE_STATE)
 	{
 		if (receivedEvent->event_data() != nullptr)
 		{
@@ -115,11 +289,11 @@ void Model2::handleEvent()
 			if (dataRef.IsString())
 			{
 				std::string configPath = dataRef.ToString();
-				saveState(configPath + mName + ".config");
+				saveState(configPath);
 			}
 		}
 
-	} else if (eventName == "LoadState")
+	} else if (eventID == EventID::LOAD_STATE)
 	{
 		if (receivedEvent->event_data() != nullptr)
 		{
@@ -127,67 +301,247 @@ void Model2::handleEvent()
 			if (dataRef.IsString())
 			{
 				std::string configPath = dataRef.ToString();
-				loadState(configPath + mName + ".config");
+				loadState(configPath);
+			}
+		}
+	} else if (eventID == EventID::FORK)
+	{
+		if (receivedEvent->event_data() != nullptr)
+		{
+			auto dataRef = receivedEvent->event_data_flexbuffer_root();
+			if (dataRef.IsString())
+			{
+				forkBranches(std::atoi(dataRef.ToString().c_str()));
 			}
 		}
 
-	} else if (eventName == "SubsequentEvent")
+	} else if (eventID == EventID::SIM_TIME_HORIZON)
+	{
+		mTickReporter.beginTick();
+		mSynchronizer.setHorizon(mCurrentSimTime);
+		advanceConservatively();
+	} else if (eventID == EventID::TIME_WARP_HORIZON)
+	{
+		// The model completed the tick when it processed the received events
+		// up to the horizon (they can still be rolled back)
+		uint64_t horizon = mCurrentSimTime;
+		mTickReporter.beginTick();
+		mTimeWarp.setHorizon(horizon);
+		advanceOptimistically();
+		mTickReporter.report(horizon);
+	} else if (eventID == EventID::SUBSEQUENT_EVENT)
 	{
-		mPublisher.publishEvent("ReturnEvent", mCurrentSimTime);
+		if (mSynchronizer.isActive())
+		{
+			mSynchronizer.bufferEvent(eventID, mCurrentSimTime);
+			advanceConservatively();
+		} else if (mTimeWarp.isActive())
+		{
+			// The event data contains the message ID of the sender
+			std::string messageID;
+			auto dataRef = receivedEvent->event_data_flexbuffer_root();
+			if (receivedEvent->event_data() != nullptr && dataRef.IsString())
+			{
+				messageID = dataRef.ToString();
+			}
 
-		// Log
-		mPublisher.publishEvent("LogInfo", mCurrentSimTime,
-				mName + " published ReturnEvent");
-	} else if (eventName == "End")
+			mTimeWarp.receive(eventID, mCurrentSimTime, messageID);
+			advanceOptimistically();
+		} else
+		{
+			processEvent(eventID, mCurrentSimTime);
+		}
+	} else if (eventID == EventID::END)
 	{
+		publishLog(LogSeverity::INFO, mCurrentSimTime, mName, ": ",
+				mAllocationMonitor.getSummary());
+
+		if (mTimeWarp.isActive())
+		{
+			publishLog(LogSeverity::INFO, mCurrentSimTime, mName, ": ",
+					mTimeWarp.getSummary());
+		}
+
+		publishMetrics();
+		if (mTimeline.isEnabled())
+		{
+			mTimeline.writeChromeTrace(mTimelineFile);
+		}
 		mRun = false;
 	}
 }
 
+void Model2::processEvent(EventID eventID, uint64_t timestamp)
+{
+	// In conservative mode the reaction is delayed by the lookahead
+	uint64_t outputTime = timestamp;
+	if (mSynchronizer.isActive())
+	{
+		outputTime += mSynchronizer.getLookahead();
+	}
+
+	if (eventID == EventID::SUBSEQUENT_EVENT)
+	{
+		publishModelEvent("ReturnEvent", outputTime);
+
+		// Log
+		publishLog(LogSeverity::INFO, outputTime, mName,
+				" published ReturnEvent");
+	}
+}
+
+void Model2::advanceConservatively()
+{
+	ConservativeSynchronizer<EventID>::PendingEvent pendingEvent;
+	while (mSynchronizer.popSafeEvent(pendingEvent))
+	{
+		processEvent(pendingEvent.id, pendingEvent.timestamp);
+	}
+
+	if (mSynchronizer.advanceLocalTime())
+	{
+		mPublisher.publishEvent("NullMessage", mSynchronizer.getPromise(),
+				mName);
+	}
+
+	if (mSynchronizer.reachedHorizon())
+	{
+		// The simulation model waits until all models reached the horizon
+		mTickReporter.report(mSynchronizer.getHorizon());
+		ScopedSpan syncSpan(mTimeline, Timeline::Kind::SYNC, "HorizonSync",
+				mSynchronizer.getHorizon());
+		mRun = mSubscriber.synchronizeSub();
+	}
+}
+
+void Model2::advanceOptimistically()
+{
+	mTimeWarp.processEvents([this](EventID eventID, uint64_t timestamp)
+	{
+		mCurrentSimTime = timestamp;
+		processEvent(eventID, timestamp);
+	});
+}
+
+void Model2::publishModelEvent(const std::string& eventName, uint64_t timestamp)
+{
+	if (mTimeWarp.isActive())
+	{
+		// The message ID identifies the event in case of a rollback
+		mPublisher.publishEvent(eventName, timestamp,
+				mTimeWarp.recordOutput(eventName, timestamp));
+	} else
+	{
+		mPublisher.publishEvent(eventName, timestamp);
+	}
+}
+
+std::string Model2::takeSnapshot()
+{
+	// Same fields as the savepoints, but binary and in memory
+	std::string snapshot;
+	mFields.writeBinary(snapshot);
+	return snapshot;
+}
+
+void Model2::restoreSnapshot(const std::string& snapshot)
+{
+	mFields.readBinary(snapshot.data(), snapshot.size());
+
+	init();
+}
+
+void Model2::forkBranches(int numBranches)
+{
+	// The simulation model forks after all models received the event
+	{
+		ScopedSpan syncSpan(mTimeline, Timeline::Kind::SYNC, "ForkSync",
+				mCurrentSimTime);
+		mRun = mSubscriber.synchronizeSub();
+	}
+
+	BranchFork::forkBranches(*this, numBranches, mName, mDescription);
+}
+
+void Model2::adoptBranch(Model2& parent, int branch)
+{
+	// State of the forked instance (the buffered events are processed by the
+	// branch)
+	mCurrentSimTime = parent.mCurrentSimTime;
+	mSynchronizer = parent.mSynchronizer;
+	restoreSnapshot(parent.takeSnapshot());
+
+	for (auto& parameter : BranchFork::applyParameters(mDealer, mName, branch,
+			mFields))
+	{
+		// Log
+		publishLog(LogSeverity::ERROR, mCurrentSimTime, mName,
+				": Invalid parameter of branch ", branch, ": ", parameter);
+	}
+	init();
+}
+
 void Model2::saveState(std::string filePath)
 {
 	// Store states
-	std::ofstream ofs(filePath);
-	boost::archive::xml_oarchive oa(ofs, boost::archive::no_header);
-	try
+	SavepointWriter writer(filePath, mName);
 	{
-		oa << boost::serialization::make_nvp("FieldSet", *this);
+		boost::archive::xml_oarchive oa(writer.getStream(),
+				boost::archive::no_header);
+		try
+		{
+			oa << boost::serialization::make_nvp("FieldSet", *this);
 
-	} catch (boost::archive::archive_exception& ex)
+		} catch (boost::archive::archive_exception& ex)
+		{
+			// Log
+			publishLog(LogSeverity::ERROR, mCurrentSimTime, mName,
+					": Archive Exception during serializing");
+			throw ex.what();
+		}
+	}
+
+	// The other models continue (savepoint barrier)
+	if (!writer.commit())
 	{
 		// Log
-		mPublisher.publishEvent("LogError", mCurrentSimTime,
-				mName + ": Archive Exception during serializing");
-		throw ex.what();
+		publishLog(LogSeverity::ERROR, mCurrentSimTime, mName,
+				" could not write its state to ", filePath);
 	}
 	// Log
-	mPublisher.publishEvent("LogInfo", mCurrentSimTime,
-			mName + " stored its state");
+	publishLog(LogSeverity::INFO, mCurrentSimTime, mName, " stored its state");
 
+	ScopedSpan syncSpan(mTimeline, Timeline::Kind::SYNC, "SavepointSync",
+			mCurrentSimTime);
 	mRun = mSubscriber.synchronizeSub();
 }
 
 void Model2::loadState(std::string filePath)
 {
 	// Restore states
-	std::ifstream ifs(filePath);
-	boost::archive::xml_iarchive ia(ifs, boost::archive::no_header);
-	try
+	SavepointReader reader(filePath, mName);
 	{
-		ia >> boost::serialization::make_nvp("FieldSet", *this);
+		boost::archive::xml_iarchive ia(reader.getStream(),
+				boost::archive::no_header);
+		try
+		{
+			ia >> boost::serialization::make_nvp("FieldSet", *this);
 
-	} catch (boost::archive::archive_exception& ex)
-	{
-		// Log
-		mPublisher.publishEvent("LogError", mCurrentSimTime,
-				mName + ": Archive Exception during deserializing");
-		throw ex.what();
+		} catch (boost::archive::archive_exception& ex)
+		{
+			// Log
+			publishLog(LogSeverity::ERROR, mCurrentSimTime, mName,
+					": Archive Exception during deserializing");
+			throw ex.what();
+		}
 	}
 	// Log
-	mPublisher.publishEvent("LogInfo", mCurrentSimTime,
-			mName + " restored its state");
+	publishLog(LogSeverity::INFO, mCurrentSimTime, mName,
+			" restored its state");
 
 	init();
 
+	ScopedSpan syncSpan(mTimeline, Timeline::Kind::SYNC, "SavepointSync",
+			mCurrentSimTime);
 	mRun = mSubscriber.synchronizeSub();
 }
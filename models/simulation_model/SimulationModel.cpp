@@ -14,14 +14,46 @@
 #include "SimulationModel.h"
 
 #include <iostream>
+#include <algorithm>
+#include <limits>
+
+constexpr std::chrono::milliseconds SimulationModel::MEMBERSHIP_POLL_INTERVAL;
 
 SimulationModel::SimulationModel(std::string name, std::string description) :
-		mName(name), mDescription(description), mCtx(1), mPublisher(mCtx), mDealer(
-				mCtx, mName), mSimTime("SimTime", 5000), mSimTimeStep(
+		mName(name), mDescription(description), mCtx(1), mMetrics(mName), mTimeline(
+				mName), mFlightRecorder(mName), mStragglers(mCtx), mPublisher(mCtx, mMetrics), mSubscriber(mCtx), mDealer(mCtx, mName), mSimTime("SimTime", 5000), mSimTimeStep(
 				"SimTimeStep", 100), mCurrentSimTime("CurrentSimTime", 0), mCycleTime(
-				"CylceTime", 0), mSpeedFactor("SpeedFactor", 1.0)
+				"CylceTime", 0), mSpeedFactor("SpeedFactor", 1.0), mConservativeMode(
+				"ConservativeMode", false), mOptimisticMode("OptimisticMode",
+				false)
 {
+	mLogLevel.apply(mName, mDealer.getLogLevel(mName));
+
+	// Metrics: stats topic and Prometheus text file (METRICS-PATH/NAME.prom)
+	mMetrics.setReportInterval(mDealer.getStatsInterval());
+	std::string metricsPath = mDealer.getMetricsPath();
+	if (!metricsPath.empty())
+	{
+		mMetrics.setPrometheusFile(metricsPath + mName + ".prom");
+	}
+
+	// Timeline of the simulation cycles (TRACE-PATH/NAME.trace.json)
+	std::string tracePath = mDealer.getTracePath();
+	if (!tracePath.empty())
+	{
+		mTimeline.enable();
+		mTimelineFile = tracePath + mName + ".trace.json";
+	}
+
 	registerInterruptSignal();
+
+	// Flight recorder of the latest events, dumped on interrupts, crashes
+	// and critical simulation cycles (FLIGHT-RECORDER-PATH/NAME.flight)
+	mFlightRecorder.enable(mDealer.getFlightRecorderSize(),
+			mDealer.getFlightRecorderPath() + mName + ".flight");
+	mFlightRecorder.installSignalHandlers();
+	mPublisher.setFlightRecorder(mFlightRecorder);
+
 	mRun = prepare();
 }
 
@@ -40,6 +72,10 @@ bool SimulationModel::prepare()
 {
 	mTotalNumOfModels = mDealer.getTotalNumberOfModels();
 	mNumOfPersistModels = mDealer.getNumberOfPersistModels();
+	mModelNames = mDealer.getAllModelNames();
+	mMembershipEpoch = mDealer.getMembershipEpoch();
+	mNumBranches = mDealer.getNumberOfBranches();
+	mForkTime = mDealer.getForkTime();
 
 	if (!mPublisher.bindSocket(mDealer.getPortNumFrom(mName)))
 	{
@@ -52,6 +88,10 @@ bool SimulationModel::prepare()
 		return false;
 	}
 
+	// Tick reports of the models (critical path, optional)
+	mStragglers.bind(mDealer.getReportPort());
+	mStragglers.setExpectedModels(getReportingModels(mModelNames));
+
 	// (mTotalNumOfModels - 2), because the simulation and configuration models should not be included
 	if (!mPublisher.synchronizePub(mTotalNumOfModels - 2,
 			mCurrentSimTime.getValue()))
@@ -59,14 +99,50 @@ bool SimulationModel::prepare()
 		return false;
 	}
 
-	mPublisher.publishEvent("LogInfo", 0,
+	publishLog(LogSeverity::INFO, 0,
 			"Synchronized simulation model with the other models (after preparation phase)");
 
 	return true;
 }
 
+void SimulationModel::applySyncMode()
+{
+	std::string mode = mDealer.getSyncMode();
+	if (mode.empty())
+	{
+		return;
+	}
+
+	bool conservative = (mode == "conservative");
+	bool optimistic = (mode == "optimistic");
+	if (conservative != mConservativeMode.getValue()
+			|| optimistic != mOptimisticMode.getValue())
+	{
+		// Log
+		publishLog(LogSeverity::WARNING, getCurrentSimTime(),
+				"Synchronization mode of the hosts-config file: ", mode);
+	}
+
+	mConservativeMode.setValue(conservative);
+	mOptimisticMode.setValue(optimistic);
+}
+
 void SimulationModel::run()
 {
+	applySyncMode();
+
+	if (mConservativeMode.getValue())
+	{
+		runConservative();
+		return;
+	}
+
+	if (mOptimisticMode.getValue())
+	{
+		runOptimistic();
+		return;
+	}
+
 	uint64_t currentSimTime = getCurrentSimTime();
 	if (mRun)
 	{
@@ -76,31 +152,26 @@ void SimulationModel::run()
 			{
 				std::chrono::high_resolution_clock::time_point t1 =
 						std::chrono::high_resolution_clock::now();
+				uint64_t tickBegin = Tracer::now();
 				// Log
-				mPublisher.publishEvent("LogInfo", currentSimTime,
-						"Simulation Time: " + std::to_string(currentSimTime));
+				publishLog(LogSeverity::INFO, currentSimTime,
+						"Simulation Time: ", currentSimTime);
 
 				// Publish current simulation time
 				mPublisher.publishEvent("SimTimeChanged", currentSimTime);
+				mTimeline.mark(Timeline::Kind::PUBLISH, "SimTimeChanged",
+						currentSimTime);
+				mStragglers.beginTick(currentSimTime);
 
-				for (auto savepoint : getSavepoints())
-				{
-					if (currentSimTime == savepoint)
-					{
-						std::string filePath = "configurations/savepnt_"
-								+ std::to_string(savepoint) + "/";
-
-						boost::filesystem::path dir(filePath);
-						if (boost::filesystem::create_directory(dir))
-						{
-							mPublisher.publishEvent("LogInfo", currentSimTime,
-									"Directory Created: " + filePath);
-						}
-
-						saveState(filePath);
-						break;
-					}
-				}
+				handleSavepoint(currentSimTime);
+				handleFork(currentSimTime);
+				handleMembershipChanges(currentSimTime);
+				mStragglers.receiveReports();
+				publishMetrics();
+
+				// The sleep until the next cycle is not part of the tick
+				mTimeline.record(Timeline::Kind::TICK, "Tick", currentSimTime,
+						tickBegin, Tracer::now());
 
 				currentSimTime += mSimTimeStep.getValue();
 				mCurrentSimTime.setValue(currentSimTime);
@@ -124,6 +195,433 @@ void SimulationModel::run()
 	stopSim();
 }
 
+void SimulationModel::runConservative()
+{
+	uint64_t currentSimTime = getCurrentSimTime();
+
+	// The branches continue after the fork time
+	bool inclusive = mBranch == 0;
+
+	while (mRun && currentSimTime < mSimTime.getValue())
+	{
+		uint64_t horizon = getNextHorizon(currentSimTime, inclusive);
+		inclusive = false;
+		ScopedSpan tickSpan(mTimeline, Timeline::Kind::TICK, "Tick", horizon);
+
+		// Log
+		publishLog(LogSeverity::INFO, currentSimTime,
+				"Simulation Time Horizon: ", horizon);
+
+		mPublisher.publishEvent("SimTimeHorizon", horizon);
+		mTimeline.mark(Timeline::Kind::PUBLISH, "SimTimeHorizon", horizon);
+		mStragglers.beginTick(horizon);
+
+		// Wait until all models reached the horizon
+		// (mTotalNumOfModels - 2), because the simulation and configuration models should not be included
+		{
+			ScopedSpan syncSpan(mTimeline, Timeline::Kind::SYNC, "HorizonSync",
+					horizon);
+			mRun = mPublisher.synchronizePub(mTotalNumOfModels - 2, horizon);
+		}
+		mStragglers.receiveReports();
+
+		currentSimTime = horizon;
+		mCurrentSimTime.setValue(currentSimTime);
+
+		handleSavepoint(currentSimTime);
+		handleFork(currentSimTime);
+		publishMetrics();
+
+		if (interruptOccured)
+		{
+			break;
+		}
+	}
+
+	stopSim();
+}
+
+void SimulationModel::runOptimistic()
+{
+	uint64_t currentSimTime = getCurrentSimTime();
+	bool inclusive = true;
+	uint64_t round = 0;
+
+	mRun = mRun && connectToTimeWarpModels();
+
+	while (mRun && currentSimTime < mSimTime.getValue())
+	{
+		uint64_t horizon = getNextHorizon(currentSimTime, inclusive);
+		inclusive = false;
+		ScopedSpan tickSpan(mTimeline, Timeline::Kind::TICK, "Tick", horizon);
+
+		// Log
+		publishLog(LogSeverity::INFO, currentSimTime, "Time Warp Horizon: ",
+				horizon);
+
+		mPublisher.publishEvent("TimeWarpHorizon", horizon);
+		mTimeline.mark(Timeline::Kind::PUBLISH, "TimeWarpHorizon", horizon);
+		mStragglers.beginTick(horizon);
+
+		// Events, which are published before a report, can still be in transit
+		// while the receiver reports. Hence the GVT is the minimum of two
+		// consecutive rounds (every message is delivered within one round).
+		// All events up to the horizon are committed, if the GVT exceeds it.
+		uint64_t gvt = currentSimTime;
+		uint64_t previousMinimum = currentSimTime;
+		uint64_t gvtBegin = Tracer::now();
+		while (mRun && gvt <= horizon)
+		{
+			std::this_thread::sleep_for(
+					std::chrono::milliseconds(mCycleTime.getValue()));
+
+			uint64_t minimum = computeGvtRound(++round);
+			uint64_t newGvt = std::min(minimum, previousMinimum);
+			previousMinimum = minimum;
+
+			if (newGvt > gvt)
+			{
+				gvt = newGvt;
+				mPublisher.publishEvent("GvtUpdate", gvt);
+			}
+
+			if (interruptOccured)
+			{
+				break;
+			}
+		}
+
+		mTimeline.record(Timeline::Kind::SYNC, "GvtRounds", horizon, gvtBegin,
+				Tracer::now());
+		mStragglers.receiveReports();
+
+		currentSimTime = horizon;
+		mCurrentSimTime.setValue(currentSimTime);
+
+		handleSavepoint(currentSimTime);
+		publishMetrics();
+
+		if (interruptOccured)
+		{
+			break;
+		}
+	}
+
+	stopSim();
+}
+
+std::vector<std::string> SimulationModel::getReportingModels(
+		const std::vector<std::string>& modelNames) const
+{
+	// The configuration server does not publish events and the loggers only
+	// subscribe to them, hence they do not report their ticks or a local
+	// virtual time
+	std::vector<std::string> reportingModels;
+	for (auto& modelName : modelNames)
+	{
+		if (modelName == mName || modelName == "configuration_server"
+				|| modelName.find("logger") != std::string::npos)
+		{
+			continue;
+		}
+		reportingModels.push_back(modelName);
+	}
+	return reportingModels;
+}
+
+bool SimulationModel::connectToTimeWarpModels()
+{
+	mSubscriber.setOwnershipName(mName);
+
+	for (auto modelName : getReportingModels(mDealer.getAllModelNames()))
+	{
+		if (!mSubscriber.connectToPub(mDealer.getIPFrom(modelName),
+				mDealer.getPortNumFrom(modelName)))
+		{
+			return false;
+		}
+
+		mTimeWarpModels.push_back(modelName);
+	}
+
+	mSubscriber.subscribeTo("LvtReport");
+
+	// Wait for the slow joiner
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	return true;
+}
+
+uint64_t SimulationModel::computeGvtRound(uint64_t round)
+{
+	mPublisher.publishEvent("GvtRequest", round);
+
+	// Every model answers with its local virtual time (or the lowest timestamp
+	// of its events published since the last report)
+	std::vector<std::string> reportedModels;
+	uint64_t minimum = std::numeric_limits<uint64_t>::max();
+
+	while (mRun && reportedModels.size() < mTimeWarpModels.size())
+	{
+		if (!mSubscriber.receiveEvent())
+		{
+			continue;
+		}
+
+		auto receivedEvent = event::GetEvent(mSubscriber.getEventBuffer());
+		size_t payloadSize = (
+				receivedEvent->name() != nullptr ?
+						receivedEvent->name()->size() : 0)
+				+ (receivedEvent->event_data() != nullptr ?
+						receivedEvent->event_data()->size() : 0);
+		mMetrics.recordReceived("LvtReport", payloadSize);
+		mFlightRecorder.record(FlightRecorder::Kind::RECEIVED, "LvtReport",
+				receivedEvent->timestamp(), uint32_t(payloadSize));
+
+		auto dataRef = receivedEvent->event_data_flexbuffer_root();
+		if (receivedEvent->event_data() == nullptr || !dataRef.IsString())
+		{
+			continue;
+		}
+
+		std::string modelName = dataRef.ToString();
+		if (std::find(reportedModels.begin(), reportedModels.end(), modelName)
+				== reportedModels.end())
+		{
+			reportedModels.push_back(modelName);
+			minimum = std::min(minimum, uint64_t(receivedEvent->timestamp()));
+		}
+
+		if (interruptOccured)
+		{
+			mRun = false;
+		}
+	}
+
+	return minimum;
+}
+
+uint64_t SimulationModel::getNextHorizon(uint64_t currentSimTime,
+		bool inclusive)
+{
+	uint64_t horizon = mSimTime.getValue();
+
+	for (auto savepoint : getSavepoints())
+	{
+		if ((savepoint > currentSimTime
+				|| (inclusive && savepoint == currentSimTime))
+				&& savepoint < horizon)
+		{
+			horizon = savepoint;
+		}
+	}
+
+	// The models fork at a horizon
+	if (!mForked && mNumBranches > 0
+			&& (mForkTime > currentSimTime
+					|| (inclusive && mForkTime == currentSimTime))
+			&& mForkTime < horizon)
+	{
+		horizon = mForkTime;
+	}
+
+	return horizon;
+}
+
+void SimulationModel::handleSavepoint(uint64_t currentSimTime)
+{
+	for (auto savepoint : getSavepoints())
+	{
+		if (currentSimTime == savepoint)
+		{
+			std::string filePath = "configurations/savepnt_"
+					+ std::to_string(savepoint);
+			if (mBranch > 0)
+			{
+				filePath += "_branch_" + std::to_string(mBranch);
+			}
+
+			// One container file or one file per model (region size 0)
+			uint64_t regionSize = mDealer.getSavepointRegionSize();
+			if (regionSize > 0)
+			{
+				// The commit requires the regions of all persistent models
+				std::vector<std::string> persistModels;
+				for (auto& modelName : mModelNames)
+				{
+					if (mDealer.isPersistModel(modelName))
+					{
+						persistModels.push_back(modelName);
+					}
+				}
+
+				filePath += SavepointContainer::getSuffix();
+				if (!SavepointContainer::create(filePath, currentSimTime,
+						persistModels, regionSize))
+				{
+					// Log
+					publishLog(LogSeverity::ERROR, currentSimTime,
+							"Could not create savepoint: ", filePath);
+					break;
+				}
+			} else
+			{
+				filePath += "/";
+				boost::filesystem::path dir(filePath);
+				if (boost::filesystem::create_directory(dir))
+				{
+					publishLog(LogSeverity::INFO, currentSimTime,
+							"Directory Created: ", filePath);
+				}
+			}
+
+			saveState(filePath);
+			break;
+		}
+	}
+}
+
+void SimulationModel::handleFork(uint64_t currentSimTime)
+{
+	if (mForked || mNumBranches == 0 || currentSimTime < mForkTime)
+	{
+		return;
+	}
+	mForked = true;
+
+	// Every model has to fork (the configuration server is shared)
+	if (mNumOfPersistModels != mTotalNumOfModels - 1)
+	{
+		// Log
+		publishLog(LogSeverity::ERROR, currentSimTime,
+				"Fork requires persistent models only");
+		return;
+	}
+
+	pauseSim();
+
+	// Event Data Serialization
+	mPublisher.publishEvent("Fork", currentSimTime,
+			std::to_string(mNumBranches));
+
+	// The models fork after they received the event
+	{
+		ScopedSpan syncSpan(mTimeline, Timeline::Kind::SYNC, "ForkSync",
+				currentSimTime);
+		mRun = mPublisher.synchronizePub(mNumOfPersistModels - 1,
+				currentSimTime);
+	}
+
+	// Log
+	publishLog(LogSeverity::INFO, currentSimTime, "Forked ", mNumBranches,
+			" branches");
+
+	BranchFork::forkBranches(*this, mNumBranches, mName, mDescription);
+
+	continueSim();
+}
+
+void SimulationModel::adoptBranch(SimulationModel& parent, int branch)
+{
+	mBranch = branch;
+	mForked = true;
+
+	// State of the forked instance
+	std::string fields;
+	parent.mFields.writeBinary(fields);
+	mFields.readBinary(fields.data(), fields.size());
+	mSavepoints = parent.mSavepoints;
+
+	for (auto& parameter : BranchFork::applyParameters(mDealer, mName, branch,
+			mFields))
+	{
+		// Log
+		publishLog(LogSeverity::ERROR, getCurrentSimTime(),
+				"Invalid parameter of branch ", branch, ": ", parameter);
+	}
+	init();
+
+	// The time-stepped execution continues with the next cycle
+	if (!mConservativeMode.getValue() && !mOptimisticMode.getValue())
+	{
+		mCurrentSimTime.setValue(
+				mCurrentSimTime.getValue() + mSimTimeStep.getValue());
+	}
+}
+
+void SimulationModel::handleMembershipChanges(uint64_t currentSimTime)
+{
+	// The epoch is requested at most once per interval, its reply is
+	// received by one of the next cycles (the cycles do not wait)
+	uint64_t membershipEpoch;
+	if (!mDealer.receiveMembershipEpoch(membershipEpoch))
+	{
+		auto now = std::chrono::steady_clock::now();
+		if (now - mLastMembershipPoll >= MEMBERSHIP_POLL_INTERVAL)
+		{
+			mLastMembershipPoll = now;
+			mDealer.requestMembershipEpoch();
+		}
+		return;
+	}
+
+	if (membershipEpoch == mMembershipEpoch || !mDealer.refresh())
+	{
+		return;
+	}
+	mMembershipEpoch = membershipEpoch;
+
+	std::vector<std::string> modelNames = mDealer.getAllModelNames();
+	std::vector<std::string> joinedModels;
+
+	for (auto modelName : modelNames)
+	{
+		if (std::find(mModelNames.begin(), mModelNames.end(), modelName)
+				== mModelNames.end())
+		{
+			joinedModels.push_back(modelName);
+		}
+	}
+
+	for (auto modelName : mModelNames)
+	{
+		if (std::find(modelNames.begin(), modelNames.end(), modelName)
+				== modelNames.end())
+		{
+			// Log
+			publishLog(LogSeverity::INFO, currentSimTime, modelName,
+					" left the simulation");
+
+			mPublisher.publishEvent("ModelLeft", currentSimTime, modelName);
+		}
+	}
+
+	mModelNames = modelNames;
+	mTotalNumOfModels = mDealer.getTotalNumberOfModels();
+	mNumOfPersistModels = mDealer.getNumberOfPersistModels();
+	mStragglers.setExpectedModels(getReportingModels(mModelNames));
+
+	if (!joinedModels.empty())
+	{
+		// Wait until the joined models finished their preparation phase
+		{
+			ScopedSpan syncSpan(mTimeline, Timeline::Kind::SYNC, "JoinSync",
+					currentSimTime);
+			mRun = mPublisher.synchronizePub(joinedModels.size(),
+					currentSimTime);
+		}
+
+		for (auto modelName : joinedModels)
+		{
+			// Log
+			publishLog(LogSeverity::INFO, currentSimTime, modelName,
+					" joined the simulation");
+
+			mPublisher.publishEvent("ModelJoined", currentSimTime, modelName);
+		}
+	}
+}
+
 void SimulationModel::stopSim()
 {
 	// Stop all running models and the dns server
@@ -132,29 +630,55 @@ void SimulationModel::stopSim()
 	// Sleep for a second to wait that all models are terminated
 	// before terminating the logger otherwise log messages could get lost.
 	sleep(1);
+	mStragglers.receiveReports();
+	publishMetrics(true);
+	if (mTimeline.isEnabled())
+	{
+		mTimeline.writeChromeTrace(mTimelineFile);
+	}
 	mPublisher.publishEvent("EndLogger", mCurrentSimTime.getValue());
 
 	mDealer.stopDNSserver();
 }
 
+void SimulationModel::publishMetrics(bool force)
+{
+	if (mMetrics.isReportDue() || force)
+	{
+		mPublisher.publishEvent("Stats", mCurrentSimTime.getValue(),
+				mMetrics.getSummary());
+		mMetrics.writePrometheusFile();
+
+		std::string stragglers = mStragglers.getSummary();
+		if (!stragglers.empty())
+		{
+			mPublisher.publishEvent("StragglerSummary",
+					mCurrentSimTime.getValue(), stragglers);
+		}
+	}
+}
+
 void SimulationModel::loadState(std::string filePath)
 {
 	pauseSim();
 	auto currentSimTime = mCurrentSimTime.getValue();
 
 	// Restore states
-	std::ifstream ifs(filePath + mName + ".config");
-	boost::archive::xml_iarchive ia(ifs, boost::archive::no_header);
-	try
+	SavepointReader reader(filePath, mName);
 	{
-		ia >> boost::serialization::make_nvp("FieldSet", *this);
+		boost::archive::xml_iarchive ia(reader.getStream(),
+				boost::archive::no_header);
+		try
+		{
+			ia >> boost::serialization::make_nvp("FieldSet", *this);
 
-	} catch (boost::archive::archive_exception& ex)
-	{
-		// Log
-		mPublisher.publishEvent("LogError", currentSimTime,
-				mName + ": Archive Exception during deserializing");
-		throw ex.what();
+		} catch (boost::archive::archive_exception& ex)
+		{
+			// Log
+			publishLog(LogSeverity::ERROR, currentSimTime, mName,
+					": Archive Exception during deserializing");
+			throw ex.what();
+		}
 	}
 	// Event Data Serialization
 	mPublisher.publishEvent("LoadState", currentSimTime, filePath);
@@ -164,9 +688,14 @@ void SimulationModel::loadState(std::string filePath)
 	// Synchronization is necessary, because the simulation
 	// has to wait until the other models finished their Restore-method
 	// (mNumOfPersistModels - 1), because the simulation model itself should not be included
-	mRun = mPublisher.synchronizePub(mNumOfPersistModels - 1, currentSimTime);
+	{
+		ScopedSpan syncSpan(mTimeline, Timeline::Kind::SYNC, "SavepointSync",
+				currentSimTime);
+		mRun = mPublisher.synchronizePub(mNumOfPersistModels - 1,
+				currentSimTime);
+	}
 
-	mPublisher.publishEvent("LogInfo", currentSimTime,
+	publishLog(LogSeverity::INFO, currentSimTime,
 			"Synchronized simulation model with the other models (after initialization phase)");
 
 	continueSim();
@@ -181,32 +710,55 @@ void SimulationModel::saveState(std::string filePath)
 	mPublisher.publishEvent("SaveState", currentSimTime, filePath);
 
 	// Store states
-	std::ofstream ofs(filePath + mName + ".config");
-	boost::archive::xml_oarchive oa(ofs, boost::archive::no_header);
-
-	try
+	SavepointWriter writer(filePath, mName);
 	{
-		oa << boost::serialization::make_nvp("FieldSet", *this);
+		boost::archive::xml_oarchive oa(writer.getStream(),
+				boost::archive::no_header);
+		try
+		{
+			oa << boost::serialization::make_nvp("FieldSet", *this);
 
-	} catch (boost::archive::archive_exception& ex)
+		} catch (boost::archive::archive_exception& ex)
+		{
+			// Log
+			publishLog(LogSeverity::ERROR, currentSimTime, mName,
+					": Archive Exception during serializing");
+			throw ex.what();
+		}
+	}
+
+	if (!writer.commit())
 	{
 		// Log
-		mPublisher.publishEvent("LogError", currentSimTime,
-				mName + ": Archive Exception during serializing");
-		throw ex.what();
+		publishLog(LogSeverity::ERROR, currentSimTime, mName,
+				" could not write its state to ", filePath);
 	}
 
 	// Synchronization is necessary, because the simulation
 	// has to wait until the other models finished their Store-method
 	// (mNumOfPersistModels - 1), because the simulation model itself should not be included
-	mRun = mPublisher.synchronizePub(mNumOfPersistModels - 1, currentSimTime);
+	{
+		ScopedSpan syncSpan(mTimeline, Timeline::Kind::SYNC, "SavepointSync",
+				currentSimTime);
+		mRun = mPublisher.synchronizePub(mNumOfPersistModels - 1,
+				currentSimTime);
+	}
+
+	// All models wrote their regions (barrier)
+	if (SavepointContainer::isContainer(filePath)
+			&& !SavepointContainer::commit(filePath))
+	{
+		// Log
+		publishLog(LogSeverity::ERROR, currentSimTime,
+				"Could not commit savepoint: ", filePath);
+	}
 
-	mPublisher.publishEvent("LogInfo", currentSimTime,
+	publishLog(LogSeverity::INFO, currentSimTime,
 			"Synchronized simulation model with the other models (after save state phase)");
 
 	if (mConfigMode)
 	{
-		mPublisher.publishEvent("LogInfo", currentSimTime,
+		publishLog(LogSeverity::INFO, currentSimTime,
 				"Default configuration files were created");
 
 		stopSim();
@@ -21,6 +21,7 @@
 #include <zmq.hpp>
 #include <boost/thread.hpp>
 #include <boost/serialization/serialization.hpp>
+#include <boost/serialization/version.hpp>
 #include <boost/archive/xml_oarchive.hpp>
 #include <boost/archive/xml_iarchive.hpp>
 #include <boost/filesystem.hpp>
@@ -29,8 +30,19 @@
 #include "interfaces/IModel.h"
 #include "interfaces/IPersist.h"
 #include "communication/Publisher.h"
-#include "communication/Dealer.h"
+#include "communication/Subscriber.h"
+#include "configuration/ConfigurationDealer.h"
 #include "data-types/Field.h"
+#include "logging/LogLevel.h"
+#include "metrics/MeteredPublisher.h"
+#include "metrics/ModelMetrics.h"
+#include "branching/BranchFork.h"
+#include "metrics/StragglerDetector.h"
+#include "persistence/SavepointStream.h"
+#include "reflection/FieldRegistry.h"
+#include "tracing/FlightRecorder.h"
+#include "tracing/Timeline.h"
+#include "utilities/MessageBuffer.h"
 #include "communication/zhelpers.hpp"
 
 #include "resources/idl/event_generated.h"
@@ -71,11 +83,50 @@ public:
 
 	void stopSim();
 
+	// Continues the forked simulation model as the given branch (see
+	// BranchFork)
+	void adoptBranch(SimulationModel& parent, int branch);
+
+	// Conservative execution: Instead of every time step, only horizons
+	// (next savepoint or end of the simulation) are published. The models
+	// advance independently up to the horizon (see ConservativeSynchronizer).
+	void setConservativeMode(bool status)
+	{
+		mConservativeMode.setValue(status);
+	}
+
+	// Optimistic execution: The models process their events speculatively up
+	// to the horizon and roll back on stragglers (see TimeWarpEngine). The
+	// simulation model computes the global virtual time (GVT) from the
+	// reports of the models.
+	void setOptimisticMode(bool status)
+	{
+		mOptimisticMode.setValue(status);
+	}
+
 	void setConfigMode(bool status)
 	{
 		mConfigMode = status;
 	}
 
+	// Overrides of the configuration file (e.g. by the benchmarks)
+	void setSimTime(uint64_t simTime)
+	{
+		mSimTime.setValue(simTime);
+	}
+
+	void setSimTimeStep(uint32_t simTimeStep)
+	{
+		mSimTimeStep.setValue(simTimeStep);
+		init();
+	}
+
+	void setSpeedFactor(double speedFactor)
+	{
+		mSpeedFactor.setValue(speedFactor);
+		init();
+	}
+
 	// Properties
 	int getCurrentSimTime()
 	{
@@ -103,8 +154,30 @@ private:
 
 	// For the communication
 	zmq::context_t mCtx;  // ZMQ-instance
-	Publisher mPublisher; // ZMQ-PUB
-	Dealer mDealer;		  // ZMQ-DEALER
+	ModelMetrics mMetrics; // Published and received events (stats topic)
+	Timeline mTimeline; // Ticks and barriers (TRACE-PATH/NAME.trace.json)
+	FlightRecorder mFlightRecorder; // Latest events (dumped on a crash)
+	StragglerDetector mStragglers; // ZMQ-PULL (tick reports of the models)
+	MeteredPublisher mPublisher; // ZMQ-PUB
+	Subscriber mSubscriber; // ZMQ-SUB (GVT reports, only optimistic mode)
+	ConfigurationDealer mDealer; // ZMQ-DEALER (configuration bundle)
+
+	// Threshold of the log messages (from the hosts-config file)
+	LogLevel mLogLevel;
+	MessageBuffer mLogMessage;
+
+	// Log messages of the model (see ::publishLog)
+	template<typename ... Parts>
+	void publishLog(LogSeverity severity, uint64_t simTime,
+			const Parts&... parts)
+	{
+		::publishLog(mPublisher, mLogLevel, mLogMessage, severity, simTime,
+				parts...);
+	}
+
+	// Stats topic and Prometheus text file (once per report interval)
+	void publishMetrics(bool force = false);
+	std::string mTimelineFile;
 
 	SavepointSet mSavepoints;
 	bool mRun = true;
@@ -115,15 +188,74 @@ private:
 	uint64_t mTotalNumOfModels = 0;
 	uint64_t mNumOfPersistModels = 0;
 
+	// Dynamic membership: Joined models are synchronized at the next cycle
+	// (only in the time-stepped execution)
+	void handleMembershipChanges(uint64_t currentSimTime);
+	uint64_t mMembershipEpoch = 0;
+	// The epoch is requested from the configuration server without waiting
+	// for the reply, at most once per interval (wall-clock)
+	static constexpr std::chrono::milliseconds MEMBERSHIP_POLL_INTERVAL
+	{ 1000 };
+	std::chrono::steady_clock::time_point mLastMembershipPoll;
+	std::vector<std::string> mModelNames;
+
+	// The mode of the hosts-config file (syncMode) overrides the mode of the
+	// configuration file, because the models activate their synchronizers
+	// from it
+	void applySyncMode();
+
+	void runConservative();
+	uint64_t getNextHorizon(uint64_t currentSimTime, bool inclusive);
+	void handleSavepoint(uint64_t currentSimTime);
+
+	// What-if branches: All models fork at the fork time (time-stepped and
+	// conservative execution), each branch continues with its parameters
+	void handleFork(uint64_t currentSimTime);
+	int mNumBranches = 0;
+	uint64_t mForkTime = 0;
+	bool mForked = false;
+	int mBranch = 0;
+
+	// Models which report their ticks and local virtual times
+	std::vector<std::string> getReportingModels(
+			const std::vector<std::string>& modelNames) const;
+
+	void runOptimistic();
+	bool connectToTimeWarpModels();
+	uint64_t computeGvtRound(uint64_t round);
+	std::vector<std::string> mTimeWarpModels;
+
 	friend class boost::serialization::access;
 	template<typename Archive>
-	void serialize(Archive& archive, const unsigned int)
+	void serialize(Archive& archive, const unsigned int version)
 	{
+		if (version > 2)
+		{
+			mFields.serialize(archive);
+			archive & boost::serialization::make_nvp("SavepointSet", mSavepoints);
+			return;
+		}
+
+		// Savepoints of older versions (tagged with the field types)
 		archive & boost::serialization::make_nvp("IntField", mSimTime);
 		archive & boost::serialization::make_nvp("IntField", mSimTimeStep);
 		archive & boost::serialization::make_nvp("IntField", mCurrentSimTime);
 		archive & boost::serialization::make_nvp("DoubleField", mSpeedFactor);
 		archive & boost::serialization::make_nvp("SavepointSet", mSavepoints);
+
+		if (version > 0)
+		{
+			archive
+					& boost::serialization::make_nvp("ConservativeMode",
+							mConservativeMode);
+		}
+
+		if (version > 1)
+		{
+			archive
+					& boost::serialization::make_nvp("OptimisticMode",
+							mOptimisticMode);
+		}
 	}
 
 	// Fields
@@ -132,7 +264,18 @@ private:
 	Field<uint64_t> mCurrentSimTime;
 	Field<uint32_t> mCycleTime;
 	Field<double> mSpeedFactor;
+	Field<bool> mConservativeMode;
+	Field<bool> mOptimisticMode;
 
+	// Persistent fields (the cycle time is derived by init)
+	FieldRegistry mFields
+	{ mSimTime, mSimTimeStep, mCurrentSimTime, mSpeedFactor, mConservativeMode,
+			mOptimisticMode };
 };
 
+// Version 1: ConservativeMode
+// Version 2: OptimisticMode
+// Version 3: Fields tagged with their names (FieldRegistry)
+BOOST_CLASS_VERSION(SimulationModel, 3)
+
 #endif /* SIMULATION_MODEL_SIMULATIONMODEL_H_ */
@@ -16,6 +16,52 @@
 
 #include "SimulationModel.h"
 
+// Overrides of the configuration file: --sim-time N, --sim-time-step N,
+// --speed-factor F and --mode time-stepped|conservative|optimistic
+bool applyOverrides(SimulationModel& simulation, int argc, char* argv[])
+{
+	for (int i = 3; i + 1 < argc; i += 2)
+	{
+		std::string option = static_cast<std::string>(argv[i]);
+		std::string value = static_cast<std::string>(argv[i + 1]);
+
+		try
+		{
+			if (option == "--sim-time")
+			{
+				simulation.setSimTime(std::stoull(value));
+			} else if (option == "--sim-time-step")
+			{
+				simulation.setSimTimeStep(std::stoul(value));
+			} else if (option == "--speed-factor")
+			{
+				simulation.setSpeedFactor(std::stod(value));
+			} else if (option == "--mode" && value == "time-stepped")
+			{
+				simulation.setConservativeMode(false);
+				simulation.setOptimisticMode(false);
+			} else if (option == "--mode" && value == "conservative")
+			{
+				simulation.setConservativeMode(true);
+				simulation.setOptimisticMode(false);
+			} else if (option == "--mode" && value == "optimistic")
+			{
+				simulation.setConservativeMode(false);
+				simulation.setOptimisticMode(true);
+			} else
+			{
+				return false;
+			}
+		} catch (std::exception& e)
+		{
+			return false;
+		}
+	}
+
+	// Options are pairs
+	return argc % 2 == 1;
+}
+
 int main(int argc, char* argv[])
 {
 	if (argc > 2)
@@ -27,11 +73,19 @@ int main(int argc, char* argv[])
 		if (static_cast<std::string>(argv[1]) == "--create-config-files")
 		{
 			simulation.setConfigMode(true);
+			if (!applyOverrides(simulation, argc, argv))
+			{
+				std::cout << " Invalid argument/s: --help" << std::endl;
+			}
 			simulation.saveState(configFilePath);
 
 		} else if (static_cast<std::string>(argv[1]) == "--load-config")
 		{
 			simulation.loadState(configFilePath);
+			if (!applyOverrides(simulation, argc, argv))
+			{
+				std::cout << " Invalid argument/s: --help" << std::endl;
+			}
 			try
 			{
 				simulation.run();
@@ -41,6 +95,7 @@ int main(int argc, char* argv[])
 				std::cerr << "Simulation Model: Interrupt received: Exit"
 						<< std::endl;
 			}
+			BranchFork::waitForBranches();
 
 		} else
 		{
@@ -57,6 +112,12 @@ int main(int argc, char* argv[])
 			std::cout
 					<< "--load-config CONFIG-PATH >> Define path of configuration file/s"
 					<< std::endl;
+			std::cout << "... [--sim-time N] [--sim-time-step N] "
+					<< "[--speed-factor F] "
+					<< "[--mode time-stepped|conservative|optimistic] >> "
+					<< "Override the values of the configuration file "
+					<< "(the mode only without syncMode in the hosts-config file)"
+					<< std::endl;
 		} else
 		{
 			std::cout << " Invalid argument/s: --help" << std::endl;
@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include "SyntheticModel.h"
+
+namespace
+{
+uint64_t now()
+{
+	return uint64_t(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+}
+
+SyntheticModel::SyntheticModel(std::string name, std::string description) :
+		mName(name), mDescription(description), mEventNames(EventID::UNKNOWN), mCtx(
+				1), mSubscriber(mCtx), mPublisher(mCtx), mDealer(mCtx, mName), mTickReporter(mCtx,
+				mName), mHandlerCost(0), mFanOut(0), mPayloadSize(64), mPublishRate(1), mCreated(
+				now()), mReady(0), mFirstTick(0), mLastTick(0), mNumTicks(0), mNumReceived(
+				0), mNumPublished(0), mReceivedBytes(0)
+{
+	mEventNames.add("SimTimeChanged", EventID::SIM_TIME_CHANGED);
+	mEventNames.add("End", EventID::END);
+	mEventNames.add("SyntheticEvent", EventID::SYNTHETIC_EVENT);
+
+	registerInterruptSignal();
+	mRun = prepare();
+	init();
+	mReady = now();
+}
+
+void SyntheticModel::init()
+{
+	mHandlerCost = getParameter("handlerCost", 0);
+	mFanOut = uint32_t(getParameter("fanOut", 0));
+	mPayloadSize = uint32_t(getParameter("payloadSize", 64));
+	mPublishRate = uint32_t(getParameter("publishRate", 1));
+	mResultsPath = mDealer.getParameter(mName, "resultsPath");
+}
+
+uint64_t SyntheticModel::getParameter(const std::string& parameter,
+		uint64_t defaultValue)
+{
+	std::string value = mDealer.getParameter(mName, parameter);
+	try
+	{
+		return value.empty() ? defaultValue : std::stoull(value);
+	} catch (std::exception& e)
+	{
+		std::cerr << mName << ": Invalid parameter " << parameter << ": "
+				<< value << std::endl;
+		return defaultValue;
+	}
+}
+
+bool SyntheticModel::prepare()
+{
+	mSubscriber.setOwnershipName(mName);
+
+	if (!mPublisher.bindSocket(mDealer.getPortNumFrom(mName)))
+	{
+		return false;
+	}
+
+	if (!mSubscriber.connectToPub(mDealer.getIPFrom("simulation_model"),
+			mDealer.getPortNumFrom("simulation_model")))
+	{
+		return false;
+	}
+
+	for (auto depModel : mDealer.getModelDependencies())
+	{
+		if (!mSubscriber.connectToPub(mDealer.getIPFrom(depModel),
+				mDealer.getPortNumFrom(depModel)))
+		{
+			return false;
+		}
+	}
+
+	for (auto& eventName : mEventNames.getNames())
+	{
+		mSubscriber.subscribeTo(eventName);
+	}
+
+	// Tick reports to the simulation model (critical path)
+	if (!mTickReporter.connect(mDealer.getIPFrom("simulation_model"),
+			mDealer.getReportPort()))
+	{
+		return false;
+	}
+
+	// Synchronization
+	if (!mSubscriber.prepareSubSynchronization(
+			mDealer.getIPFrom("simulation_model"),
+			mDealer.getSynchronizationPort()))
+	{
+		return false;
+	}
+
+	if (!mSubscriber.synchronizeSub())
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void SyntheticModel::run()
+{
+	while (mRun)
+	{
+		if (mSubscriber.receiveEvent())
+		{
+			handleEvent();
+		}
+	}
+}
+
+void SyntheticModel::handleEvent()
+{
+	auto eventBuffer = mSubscriber.getEventBuffer();
+
+	auto receivedEvent = event::GetEvent(eventBuffer);
+	auto eventID = mEventNames.lookup(receivedEvent->name());
+
+	if (eventID == EventID::SYNTHETIC_EVENT)
+	{
+		handleSyntheticEvent(receivedEvent);
+
+	} else if (eventID == EventID::SIM_TIME_CHANGED)
+	{
+		mTickReporter.beginTick();
+		uint64_t tick = now();
+		if (mNumTicks++ == 0)
+		{
+			mFirstTick = tick;
+		}
+		mLastTick = tick;
+
+		publishSyntheticEvents(receivedEvent->timestamp(), mPublishRate, 0);
+		mTickReporter.report(receivedEvent->timestamp());
+
+	} else if (eventID == EventID::END)
+	{
+		writeResults();
+		mRun = false;
+	}
+}
+
+void SyntheticModel::handleSyntheticEvent(const event::Event* receivedEvent)
+{
+	uint64_t received = now();
+	mNumReceived++;
+
+	auto eventData = receivedEvent->event_data();
+	if (eventData == nullptr)
+	{
+		return;
+	}
+	mReceivedBytes += eventData->size();
+
+	// Header: SEND-TIME HOPS
+	auto payload = receivedEvent->event_data_flexbuffer_root().AsString();
+	char* end = nullptr;
+	uint64_t sent = std::strtoull(payload.c_str(), &end, 10);
+	uint32_t hops = uint32_t(std::strtoul(end, nullptr, 10));
+	mLatency.record(received >= sent ? received - sent : 0);
+
+	// Handler cost
+	while (now() - received < mHandlerCost)
+	{
+	}
+
+	// Answers are not answered again
+	if (hops == 0)
+	{
+		publishSyntheticEvents(receivedEvent->timestamp(), mFanOut, 1);
+	}
+}
+
+void SyntheticModel::publishSyntheticEvents(uint64_t timestamp,
+		uint32_t number, uint32_t hops)
+{
+	for (uint32_t i = 0; i < number; i++)
+	{
+		char header[48];
+		int length = std::snprintf(header, sizeof(header), "%" PRIu64 " %u ",
+				now(), hops);
+
+		mPayload.assign(header, size_t(length));
+		if (mPayload.size() < mPayloadSize)
+		{
+			mPayload.resize(mPayloadSize, 'x');
+		}
+
+		mPublisher.publishEvent("SyntheticEvent", timestamp, mPayload);
+		mNumPublished++;
+	}
+}
+
+void SyntheticModel::writeResults()
+{
+	if (mResultsPath.empty())
+	{
+		return;
+	}
+
+	std::string filePath = mResultsPath + mName + ".json";
+	std::FILE* file = std::fopen(filePath.c_str(), "w");
+	if (file == nullptr)
+	{
+		std::cerr << mName << ": Could not write the results to " << filePath
+				<< std::endl;
+		return;
+	}
+
+	std::fprintf(file,
+			"{\"model\": \"%s\", \"created_ns\": %" PRIu64 ", \"ready_ns\": %" PRIu64 ",\n",
+			mName.c_str(), mCreated, mReady);
+	std::fprintf(file,
+			" \"ticks\": %" PRIu64 ", \"first_tick_ns\": %" PRIu64 ", \"last_tick_ns\": %" PRIu64 ",\n",
+			mNumTicks, mFirstTick, mLastTick);
+	std::fprintf(file,
+			" \"received\": %" PRIu64 ", \"received_bytes\": %" PRIu64 ", \"published\": %" PRIu64 ",\n",
+			mNumReceived, mReceivedBytes, mNumPublished);
+	std::fprintf(file,
+			" \"parameters\": {\"handlerCost\": %" PRIu64 ", \"fanOut\": %u, \"payloadSize\": %u, \"publishRate\": %u},\n",
+			mHandlerCost, mFanOut, mPayloadSize, mPublishRate);
+
+	// Non-empty buckets of the latency histogram: [upper bound in ns, count]
+	std::fprintf(file,
+			" \"latency\": {\"count\": %" PRIu64 ", \"sum_ns\": %" PRIu64 ", \"max_ns\": %" PRIu64 ", \"buckets\": [",
+			mLatency.getCount(), mLatency.getSum(), mLatency.getMax());
+	const char* separator = "";
+	for (size_t bucket = 0; bucket < LatencyHistogram::NUM_BUCKETS; bucket++)
+	{
+		uint64_t count = mLatency.getBucketCount(bucket);
+		if (count > 0)
+		{
+			std::fprintf(file, "%s[%" PRIu64 ", %" PRIu64 "]", separator,
+					LatencyHistogram::getUpperBound(bucket), count);
+			separator = ", ";
+		}
+	}
+	std::fprintf(file, "]}}\n");
+
+	std::fclose(file);
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef SYNTHETIC_MODEL_SYNTHETICMODEL_H_
+#define SYNTHETIC_MODEL_SYNTHETICMODEL_H_
+
+#include <zmq.hpp>
+
+#include "communication/zhelpers.hpp"
+#include "communication/Subscriber.h"
+#include "communication/Publisher.h"
+#include "configuration/ConfigurationDealer.h"
+#include "interfaces/IModel.h"
+#include "metrics/LatencyHistogram.h"
+#include "metrics/TickReporter.h"
+#include "utilities/EventNameTable.h"
+
+#include "resources/idl/event_generated.h"
+
+// Load generator of the federation benchmarks (benchmarks/federation).
+// Every simulation tick the model publishes a number of SyntheticEvents,
+// every received SyntheticEvent costs a configurable handler time and is
+// answered by a number of SyntheticEvents (fan-out, not answered again).
+// The latency from publishing to receiving is measured with the monotonic
+// clock (all models on one host), the results are written to
+// RESULTS-PATH/NAME.json at the end of the simulation.
+//
+// Parameters (Parameter elements of the model in the hosts-config file):
+//   handlerCost  busy time per received event in ns (default: 0)
+//   fanOut       events published per received event (default: 0)
+//   payloadSize  bytes of the event data, at least the header (default: 64)
+//   publishRate  events published per tick (default: 1)
+//   resultsPath  folder of the result files (default: no results)
+class SyntheticModel: public virtual IModel
+{
+public:
+	SyntheticModel(std::string name, std::string description);
+	virtual ~SyntheticModel() = default;
+
+	// IModel
+	virtual void init() override;
+	virtual bool prepare() override;
+	virtual void run() override;
+
+	virtual std::string getName() const override
+	{
+		return mName;
+	}
+	virtual std::string getDescription() const override
+	{
+		return mDescription;
+	}
+
+private:
+	// IModel
+	std::string mName;
+	std::string mDescription;
+
+	// Interned names of the subscribed events
+	enum class EventID
+	{
+		UNKNOWN, SIM_TIME_CHANGED, END, SYNTHETIC_EVENT
+	};
+	EventNameTable<EventID> mEventNames;
+
+	// Subscriber
+	void handleEvent();
+	void handleSyntheticEvent(const event::Event* receivedEvent);
+
+	// Publisher (the send time and the hop count are part of the payload)
+	void publishSyntheticEvents(uint64_t timestamp, uint32_t number,
+			uint32_t hops);
+
+	void writeResults();
+
+	zmq::context_t mCtx;
+	Subscriber mSubscriber;
+	Publisher mPublisher;
+	ConfigurationDealer mDealer;
+	TickReporter mTickReporter;
+
+	// Parameters
+	uint64_t getParameter(const std::string& parameter, uint64_t defaultValue);
+	uint64_t mHandlerCost;
+	uint32_t mFanOut;
+	uint32_t mPayloadSize;
+	uint32_t mPublishRate;
+	std::string mResultsPath;
+
+	// Results (monotonic clock in ns)
+	LatencyHistogram mLatency;
+	uint64_t mCreated;
+	uint64_t mReady;
+	uint64_t mFirstTick;
+	uint64_t mLastTick;
+	uint64_t mNumTicks;
+	uint64_t mNumReceived;
+	uint64_t mNumPublished;
+	uint64_t mReceivedBytes;
+
+	std::string mPayload;
+	bool mRun;
+};
+
+#endif /* SYNTHETIC_MODEL_SYNTHETICMODEL_H_ */
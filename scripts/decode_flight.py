@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# Copyright (c) 2019, German Aerospace Center (DLR)
+#
+# This file is part of the development version of FRASER.
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+#
+# Authors:
+# - 2019, Annika Ofenloch (DLR RY-AVS)
+
+"""Decodes the dump of a flight recorder (MODEL.flight).
+
+Prints the latest received and published events and the handler durations
+of a model before the dump (see src/tracing/FlightRecorder.h) in the order
+of their recording. The times are relative to the dump (negative) or in
+the realtime clock of the host (--absolute). Several dumps (e.g. of all
+models of a crashed simulation) are merged by their realtime.
+"""
+
+import argparse
+import datetime
+import json
+import signal
+import struct
+import sys
+
+HEADER = struct.Struct('<8sIIQQiiQQ64s')
+RECORD = struct.Struct('<QQQIBB34s')
+MAGIC = b'FRFLIGHT'
+
+KINDS = {1: 'RECEIVED', 2: 'PUBLISHED', 3: 'HANDLER'}
+REASONS = {0: 'requested', -1: 'critical simulation cycle'}
+
+
+def describe_reason(reason):
+    if reason in REASONS:
+        return REASONS[reason]
+    try:
+        return signal.Signals(reason).name
+    except ValueError:
+        return 'signal %d' % reason
+
+
+def read_dump(file_name):
+    with open(file_name, 'rb') as dump_file:
+        data = dump_file.read()
+
+    if len(data) < HEADER.size:
+        raise ValueError('%s: incomplete header' % file_name)
+
+    (magic, version, record_size, capacity, written, reason, pid, real_time,
+     monotonic_time, model_name) = HEADER.unpack_from(data, 0)
+    if magic != MAGIC or version != 1 or record_size != RECORD.size:
+        raise ValueError('%s: not a flight recorder dump (version 1)'
+                         % file_name)
+
+    dump = {
+        'model': model_name.split(b'\0', 1)[0].decode('utf-8', 'replace'),
+        'file': file_name,
+        'capacity': capacity,
+        'written': written,
+        'reason': describe_reason(reason),
+        'pid': pid,
+        'real_time': real_time,
+        'records': [],
+    }
+
+    offset = HEADER.size
+    for slot in range(capacity):
+        if offset + RECORD.size > len(data):
+            break
+        (sequence, time, sim_time, value, kind, name_length,
+         name) = RECORD.unpack_from(data, offset)
+        offset += RECORD.size
+
+        # Empty, incomplete (written during the dump) or stale records
+        if sequence == 0 or (sequence - 1) % capacity != slot:
+            continue
+
+        dump['records'].append({
+            'model': dump['model'],
+            'sequence': sequence,
+            # Realtime of the record (monotonic clock of the same host)
+            'real_time': real_time - (monotonic_time - time),
+            'relative_us': (time - monotonic_time) / 1e3,
+            'sim_time': sim_time,
+            'kind': KINDS.get(kind, 'UNKNOWN'),
+            'name': name[:name_length].decode('utf-8', 'replace'),
+            'value': value,
+        })
+
+    dump['records'].sort(key=lambda record: record['sequence'])
+    return dump
+
+
+def format_record(record, absolute, show_model):
+    if absolute:
+        time = datetime.datetime.fromtimestamp(
+            record['real_time'] / 1e9).strftime('%H:%M:%S.%f')
+    else:
+        time = '%+14.1fus' % record['relative_us']
+
+    if record['kind'] == 'HANDLER':
+        value = 'duration_us=%.1f' % (record['value'] / 1e3)
+    else:
+        value = 'bytes=%d' % record['value']
+
+    model = '%-20s ' % record['model'] if show_model else ''
+    return '%s %s%-9s sim=%-10d %-34s %s' % (
+        time, model, record['kind'], record['sim_time'], record['name'],
+        value)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawTextHelpFormatter)
+    parser.add_argument('dumps', nargs='+', help='MODEL.flight files')
+    parser.add_argument('--last', type=int, default=0,
+                        help='only the last N records (default: all)')
+    parser.add_argument('--absolute', action='store_true',
+                        help='realtime of the records instead of the time '
+                        'relative to the dump')
+    parser.add_argument('--json', action='store_true',
+                        help='records as JSON lines')
+    args = parser.parse_args()
+
+    dumps = []
+    for file_name in args.dumps:
+        try:
+            dumps.append(read_dump(file_name))
+        except (IOError, ValueError) as error:
+            print(error, file=sys.stderr)
+            sys.exit(1)
+
+    for dump in dumps:
+        lost = max(dump['written'] - dump['capacity'], 0)
+        print('# %s: pid %d, dump on %s at %s, %d records (%d overwritten)'
+              % (dump['model'], dump['pid'], dump['reason'],
+                 datetime.datetime.fromtimestamp(
+                     dump['real_time'] / 1e9).isoformat(),
+                 len(dump['records']), lost), file=sys.stderr)
+
+    records = [record for dump in dumps for record in dump['records']]
+    if len(dumps) > 1:
+        records.sort(key=lambda record: record['real_time'])
+    if args.last > 0:
+        records = records[-args.last:]
+
+    for record in records:
+        if args.json:
+            print(json.dumps(record))
+        else:
+            print(format_record(record, args.absolute or len(dumps) > 1,
+                                len(dumps) > 1))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# Copyright (c) 2019, German Aerospace Center (DLR)
+#
+# This file is part of the development version of FRASER.
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+#
+# Authors:
+# - 2019, Annika Ofenloch (DLR RY-AVS)
+
+"""Model instance arrays (<Model count="N">) of a hosts-config file.
+
+  arrays  Print the ids of all instance arrays (one per line)
+  names   Print the instance names of all arrays (id_0 ... id_N-1)
+  launch  Start all instances of the arrays (optionally only of one host)
+          with a single process, which waits for the instances and
+          forwards SIGINT/SIGTERM to them
+
+The instances of the array "logger" (sharded logger) are started with
+--log-files-path, all other instances with -n NAME only.
+"""
+
+import argparse
+import glob
+import os
+import signal
+import subprocess
+import sys
+import xml.etree.ElementTree as ET
+
+
+def read_arrays(config_file):
+    root = ET.parse(config_file).getroot()
+
+    addresses = {}
+    for host in root.iter('Host'):
+        addresses[host.get('id')] = host.findtext('Address', '').strip()
+
+    arrays = []
+    for model in root.iter('Model'):
+        count = int(model.get('count', '0'))
+        if count > 0:
+            host = model.find('HostReference')
+            host_id = host.get('hostID') if host is not None else None
+            arrays.append({
+                'id': model.get('id'),
+                'path': model.get('path'),
+                'host': host_id,
+                'address': addresses.get(host_id),
+                'instances': ['%s_%d' % (model.get('id'), i)
+                              for i in range(count)]})
+    return arrays
+
+
+def find_binary(model_path, base_path):
+    # Remote hosts: all models are copied into one folder
+    if base_path:
+        path = os.path.join(base_path, os.path.basename(model_path))
+    else:
+        path = model_path
+    binaries = [f for f in glob.glob(os.path.join(path, 'build', 'bin', '*'))
+                if os.access(f, os.X_OK)]
+    if not binaries:
+        sys.exit('No binary found in %s/build/bin' % path)
+    return binaries[0]
+
+
+def launch(arrays, host, base_path, log_files_path):
+    processes = []
+    for array in arrays:
+        if host is not None and host not in (array['host'], array['address']):
+            continue
+
+        binary = find_binary(array['path'], base_path)
+        for name in array['instances']:
+            if array['id'] == 'logger':
+                command = [binary, '--log-files-path', log_files_path,
+                           '-n', name]
+            else:
+                command = [binary, '-n', name]
+            processes.append(subprocess.Popen(command))
+
+    def forward(signum, frame):
+        for process in processes:
+            if process.poll() is None:
+                process.send_signal(signum)
+
+    signal.signal(signal.SIGINT, forward)
+    signal.signal(signal.SIGTERM, forward)
+
+    failed = 0
+    for process in processes:
+        if process.wait() != 0:
+            failed += 1
+    return 1 if failed > 0 else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawTextHelpFormatter)
+    parser.add_argument('command', choices=['arrays', 'names', 'launch'])
+    parser.add_argument('-f', '--config-file', required=True,
+                        help='hosts-config file')
+    parser.add_argument('--host', default=None,
+                        help='only instances on this host (id or address)')
+    parser.add_argument('--base-path', default=None,
+                        help='folder of the models (remote runs)')
+    parser.add_argument('--array', action='append', default=[],
+                        help='only this array (repeatable)')
+    parser.add_argument('--skip', action='append', default=[],
+                        help='not this array (repeatable)')
+    parser.add_argument('--log-files-path', default='../logs/',
+                        help='log files of the logger instances')
+    args = parser.parse_args()
+
+    arrays = [array for array in read_arrays(args.config_file)
+              if (not args.array or array['id'] in args.array)
+              and array['id'] not in args.skip]
+
+    if args.command == 'arrays':
+        for array in arrays:
+            print(array['id'])
+    elif args.command == 'names':
+        for array in arrays:
+            print('\n'.join(array['instances']))
+    else:
+        sys.exit(launch(arrays, args.host, args.base_path,
+                        args.log_files_path))
+
+
+if __name__ == '__main__':
+    main()
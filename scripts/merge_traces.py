@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# Copyright (c) 2019, German Aerospace Center (DLR)
+#
+# This file is part of the development version of FRASER.
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+#
+# Authors:
+# - 2019, Annika Ofenloch (DLR RY-AVS)
+
+"""Merges the timelines of the models into a single Chrome trace.
+
+Reads the timeline files of the models (TRACE-PATH/MODEL.trace.json, see
+src/tracing/Timeline.h) and writes one trace file with a process per model,
+which can be opened in chrome://tracing or https://ui.perfetto.dev.
+
+Axes:
+  wall   spans at their monotonic time (the clocks of different hosts are
+         not synchronized)
+  sim    the spans of each simulation tick are placed one after another
+         in the order of the simulation time, every tick starts at the
+         earliest span of the tick (stragglers and slow barriers of a tick
+         line up across the models)
+"""
+
+import argparse
+import glob
+import json
+import os
+import sys
+
+# Gap between two ticks on the simulation time axis (microseconds)
+TICK_GAP = 10.0
+
+
+def read_timelines(files):
+    timelines = []
+    for pid, file_name in enumerate(files, 1):
+        with open(file_name) as trace_file:
+            trace = json.load(trace_file)
+
+        # The process IDs of different hosts can collide
+        events = []
+        for event in trace.get('traceEvents', []):
+            event['pid'] = pid
+            events.append(event)
+        model = trace.get('otherData', {}).get(
+            'model', os.path.basename(file_name))
+        overwritten = trace.get('otherData', {}).get('overwritten', 0)
+        if overwritten:
+            sys.stderr.write('%s: %d spans were overwritten (ring buffer)\n'
+                             % (model, overwritten))
+        timelines.append((model, events))
+    return timelines
+
+
+def end_of(event):
+    return event['ts'] + event.get('dur', 0.0)
+
+
+def to_sim_axis(events, per_model):
+    ticks = {}
+    for event in events:
+        sim_time = event['args']['sim_time']
+        ticks.setdefault(sim_time, []).append(event)
+
+    cursor = 0.0
+    for sim_time in sorted(ticks):
+        spans = ticks[sim_time]
+        groups = {}
+        if per_model:
+            for event in spans:
+                groups.setdefault(event['pid'], []).append(event)
+        else:
+            groups[0] = spans
+
+        length = 0.0
+        for group in groups.values():
+            begin = min(event['ts'] for event in group)
+            for event in group:
+                event['ts'] = round(event['ts'] - begin + cursor, 3)
+            length = max(length, max(end_of(e) for e in group) - cursor)
+        cursor += length + TICK_GAP
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawTextHelpFormatter)
+    parser.add_argument('paths', nargs='+',
+                        help='timeline files or folders with timeline files')
+    parser.add_argument('-o', '--output', default='simulation.trace.json',
+                        help='merged trace file (default: %(default)s)')
+    parser.add_argument('--axis', choices=['wall', 'sim'], default='wall',
+                        help='time axis of the merged trace')
+    parser.add_argument('--per-model', action='store_true',
+                        help='sim axis: align the spans of every model to '
+                        'the start of the tick (models on different hosts)')
+    parser.add_argument('--tick', type=int, action='append', default=None,
+                        help='keep only the spans of this simulation time '
+                        '(repeatable)')
+    args = parser.parse_args()
+
+    files = []
+    for path in args.paths:
+        if os.path.isdir(path):
+            files.extend(sorted(glob.glob(os.path.join(path,
+                                                       '*.trace.json'))))
+        else:
+            files.append(path)
+    files = [f for f in files
+             if os.path.abspath(f) != os.path.abspath(args.output)]
+    if not files:
+        sys.exit('No timeline files found')
+
+    metadata = []
+    events = []
+    for model, timeline in read_timelines(files):
+        for event in timeline:
+            if event.get('ph') == 'M':
+                metadata.append(event)
+            elif args.tick is None or event['args']['sim_time'] in args.tick:
+                events.append(event)
+
+    if args.axis == 'sim':
+        to_sim_axis(events, args.per_model)
+    else:
+        # Relative to the earliest span
+        begin = min([event['ts'] for event in events] or [0.0])
+        for event in events:
+            event['ts'] = round(event['ts'] - begin, 3)
+
+    events.sort(key=lambda event: (event['ts'], event['pid']))
+    with open(args.output, 'w') as output:
+        json.dump({'traceEvents': metadata + events,
+                   'displayTimeUnit': 'ns',
+                   'otherData': {'axis': args.axis}}, output)
+    print('%d spans of %d models written to %s' % (
+        len(events), len(files), args.output))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,328 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# Copyright (c) 2019, German Aerospace Center (DLR)
+#
+# This file is part of the development version of FRASER.
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+#
+# Authors:
+# - 2019, Annika Ofenloch (DLR RY-AVS)
+
+"""Traffic-aware placement of the models on the hosts of a hosts-config file.
+
+The models are the vertices of a graph, the edges are weighted by the
+recorded traffic between them (--traffic) or, without recordings, by the
+<Dependencies> of the hosts-config file. The vertices are weighted by their
+CPU load (--load, default: 1 per model instance).
+
+A greedy placement (heaviest models first, next to their neighbours) is
+refined by Kernighan-Lin passes (moves and swaps), which minimize the
+traffic between the hosts while the load of each host stays within its
+share of the cores (<Host cores="N">, default: 1).
+
+The environment models (configuration server, simulation model, logger)
+keep their host, other models can be pinned with --pin MODEL=HOST.
+
+Traffic file (CSV): source,target,bytes[,messages]
+Load file (CSV):    model,load
+"""
+
+import argparse
+import csv
+import sys
+import xml.etree.ElementTree as ET
+
+ENVIRONMENT_MODELS = ('configuration_server', 'simulation_model', 'logger')
+
+
+def parse_config(config_file):
+    try:
+        parser = ET.XMLParser(target=ET.TreeBuilder(insert_comments=True))
+    except TypeError:
+        # Python < 3.8: comments are not preserved
+        parser = ET.XMLParser()
+    return ET.parse(config_file, parser)
+
+
+def read_hosts(root):
+    hosts = {}
+    for host in root.iter('Host'):
+        hosts[host.get('id')] = float(host.get('cores', '1'))
+    return hosts
+
+
+def read_models(root):
+    models = {}
+    for model in root.iter('Model'):
+        host = model.find('HostReference')
+        dependencies = [reference.get('modelID') for reference in
+                        model.iter('ModelReference')]
+        models[model.get('id')] = {
+            'element': model,
+            'host': host.get('hostID') if host is not None else None,
+            'count': max(int(model.get('count', '0')), 1),
+            'dependencies': dependencies}
+    return models
+
+
+def array_id(name, models):
+    """Maps an instance name (id_N) to its array (all instances share one
+    <Model> entry and therefore one host)."""
+    if name in models:
+        return name
+    base, _, index = name.rpartition('_')
+    if index.isdigit() and base in models:
+        return base
+    return None
+
+
+def read_traffic(traffic_file, models):
+    edges = {}
+    with open(traffic_file) as f:
+        for row in csv.reader(f):
+            if not row or row[0].startswith('#') or row[0] == 'source':
+                continue
+            source = array_id(row[0].strip(), models)
+            target = array_id(row[1].strip(), models)
+            if source is None or target is None or source == target:
+                continue
+            key = tuple(sorted((source, target)))
+            edges[key] = edges.get(key, 0.0) + float(row[2])
+    return edges
+
+
+def dependency_edges(models):
+    edges = {}
+    for name, model in models.items():
+        for dependency in model['dependencies']:
+            if dependency in models and dependency != name:
+                key = tuple(sorted((name, dependency)))
+                edges[key] = edges.get(key, 0.0) + float(model['count'])
+    return edges
+
+
+def read_loads(load_file, models):
+    loads = {name: float(model['count']) for name, model in models.items()}
+    if load_file:
+        measured = {}
+        with open(load_file) as f:
+            for row in csv.reader(f):
+                if not row or row[0].startswith('#') or row[0] == 'model':
+                    continue
+                name = array_id(row[0].strip(), models)
+                if name is not None:
+                    measured[name] = measured.get(name, 0.0) + float(row[1])
+        loads.update(measured)
+    return loads
+
+
+class Placement:
+
+    def __init__(self, hosts, loads, edges, pinned, imbalance):
+        self.hosts = hosts
+        self.loads = loads
+        self.pinned = pinned
+        self.neighbours = {name: {} for name in loads}
+        for (a, b), weight in edges.items():
+            self.neighbours[a][b] = self.neighbours[a].get(b, 0.0) + weight
+            self.neighbours[b][a] = self.neighbours[b].get(a, 0.0) + weight
+
+        # Share of the total load per host (proportional to its cores)
+        total_load = sum(loads.values())
+        total_cores = sum(hosts.values())
+        self.capacity = {host: max(total_load * cores / total_cores
+                                   * (1.0 + imbalance), 0.0)
+                         for host, cores in hosts.items()}
+        self.assignment = {}
+        self.host_load = {host: 0.0 for host in hosts}
+
+    def assign(self, name, host):
+        previous = self.assignment.get(name)
+        if previous is not None:
+            self.host_load[previous] -= self.loads[name]
+        self.assignment[name] = host
+        self.host_load[host] += self.loads[name]
+
+    def fits(self, name, host, removed=None):
+        load = self.host_load[host] + self.loads[name]
+        if removed is not None:
+            load -= self.loads[removed]
+        return load <= self.capacity[host] + 1e-9
+
+    def affinity(self, name, host):
+        return sum(weight for neighbour, weight in
+                   self.neighbours[name].items()
+                   if self.assignment.get(neighbour) == host)
+
+    def cut(self):
+        cut = 0.0
+        for name, neighbours in self.neighbours.items():
+            for neighbour, weight in neighbours.items():
+                if name < neighbour and \
+                        self.assignment[name] != self.assignment[neighbour]:
+                    cut += weight
+        return cut
+
+    def greedy(self):
+        for name, host in self.pinned.items():
+            self.assign(name, host)
+
+        # Heaviest (load and traffic) first, next to their neighbours
+        free = [name for name in self.loads if name not in self.pinned]
+        free.sort(key=lambda name: (self.loads[name],
+                                    sum(self.neighbours[name].values())),
+                  reverse=True)
+        for name in free:
+            candidates = [host for host in self.hosts if self.fits(name, host)]
+            if not candidates:
+                candidates = list(self.hosts)
+            best = max(candidates, key=lambda host: (
+                self.affinity(name, host),
+                self.capacity[host] - self.host_load[host]))
+            self.assign(name, best)
+
+    def gain(self, name, host):
+        return self.affinity(name, host) - \
+            self.affinity(name, self.assignment[name])
+
+    def refine(self, max_passes):
+        movable = [name for name in self.loads if name not in self.pinned]
+
+        for _ in range(max_passes):
+            improved = False
+            locked = set()
+
+            while True:
+                best = None
+
+                # Moves to another host
+                for name in movable:
+                    if name in locked:
+                        continue
+                    for host in self.hosts:
+                        if host != self.assignment[name] and \
+                                self.fits(name, host):
+                            gain = self.gain(name, host)
+                            if best is None or gain > best[0]:
+                                best = (gain, name, host, None)
+
+                # Swaps between two hosts (keep the balance)
+                for i, a in enumerate(movable):
+                    if a in locked:
+                        continue
+                    for b in movable[i + 1:]:
+                        if b in locked or \
+                                self.assignment[a] == self.assignment[b]:
+                            continue
+                        host_a = self.assignment[a]
+                        host_b = self.assignment[b]
+                        if not (self.fits(a, host_b, removed=b) and
+                                self.fits(b, host_a, removed=a)):
+                            continue
+                        weight = self.neighbours[a].get(b, 0.0)
+                        gain = self.gain(a, host_b) + self.gain(b, host_a) \
+                            - 2.0 * weight
+                        if best is None or gain > best[0]:
+                            best = (gain, a, host_b, b)
+
+                if best is None or best[0] <= 1e-9:
+                    break
+
+                gain, name, host, swapped = best
+                if swapped is not None:
+                    self.assign(swapped, self.assignment[name])
+                    locked.add(swapped)
+                self.assign(name, host)
+                locked.add(name)
+                improved = True
+
+            if not improved:
+                break
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawTextHelpFormatter)
+    parser.add_argument('-f', '--config-file', required=True,
+                        help='hosts-config file')
+    parser.add_argument('-o', '--output', default=None,
+                        help='optimized hosts-config file (default: stdout)')
+    parser.add_argument('--traffic', default=None,
+                        help='recorded traffic per model pair (CSV)')
+    parser.add_argument('--load', default=None,
+                        help='CPU load per model (CSV)')
+    parser.add_argument('--pin', action='append', default=[],
+                        metavar='MODEL=HOST', help='keep a model on a host')
+    parser.add_argument('--imbalance', type=float, default=0.1,
+                        help='allowed load above the share of a host '
+                             '(default: 0.1)')
+    parser.add_argument('--passes', type=int, default=10,
+                        help='max. number of refinement passes')
+    args = parser.parse_args()
+
+    tree = parse_config(args.config_file)
+    root = tree.getroot()
+    hosts = read_hosts(root)
+    models = read_models(root)
+
+    if not hosts:
+        sys.exit('No hosts defined in %s' % args.config_file)
+
+    pinned = {name: model['host'] for name, model in models.items()
+              if name in ENVIRONMENT_MODELS and model['host'] in hosts}
+    for pin in args.pin:
+        name, _, host = pin.partition('=')
+        if name not in models or host not in hosts:
+            sys.exit('Invalid pin: %s' % pin)
+        pinned[name] = host
+
+    if args.traffic:
+        edges = read_traffic(args.traffic, models)
+    else:
+        edges = dependency_edges(models)
+
+    placement = Placement(hosts, read_loads(args.load, models), edges, pinned,
+                          args.imbalance)
+
+    # Cut of the current placement (for the summary)
+    current = {name: model['host'] for name, model in models.items()}
+    if all(host in hosts for host in current.values()):
+        for name, host in current.items():
+            placement.assign(name, host)
+        before = placement.cut()
+        placement = Placement(hosts, placement.loads, edges, pinned,
+                              args.imbalance)
+    else:
+        before = None
+
+    placement.greedy()
+    placement.refine(args.passes)
+
+    for name, model in models.items():
+        host = model['element'].find('HostReference')
+        if host is None:
+            host = ET.SubElement(model['element'], 'HostReference')
+        host.set('hostID', placement.assignment[name])
+
+    if before is not None:
+        print('Cross-host traffic: %.0f -> %.0f' % (before, placement.cut()),
+              file=sys.stderr)
+    else:
+        print('Cross-host traffic: %.0f' % placement.cut(), file=sys.stderr)
+    for host in sorted(hosts):
+        print('  %s: load %.1f (capacity %.1f)' % (
+            host, placement.host_load[host], placement.capacity[host]),
+            file=sys.stderr)
+
+    if args.output:
+        tree.write(args.output, encoding='utf-8', xml_declaration=True)
+    else:
+        tree.write(sys.stdout, encoding='unicode', xml_declaration=True)
+
+
+if __name__ == '__main__':
+    main()
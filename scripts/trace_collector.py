@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# Copyright (c) 2019, German Aerospace Center (DLR)
+#
+# This file is part of the development version of FRASER.
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+#
+# Authors:
+# - 2019, Annika Ofenloch (DLR RY-AVS)
+
+"""Latency distributions of the traced event chains.
+
+Reads the span files of the models (TRACE-PATH/MODEL.spans, see
+src/tracing/Tracer.h) and prints:
+
+  hops         latency from publishing to receiving an event per link
+               (sender model, event, receiver model)
+  handlers     duration of the handlers of the traced events
+  end-to-end   time from publishing the root event of a chain until the
+               last handler of the chain finished (per root event)
+
+All times in microseconds. The latencies between hosts include the offset
+of their monotonic clocks.
+"""
+
+import argparse
+import collections
+import glob
+import os
+import sys
+
+
+def read_spans(files):
+    sent = {}
+    received = []
+    for file_name in files:
+        with open(file_name) as span_file:
+            for line in span_file:
+                fields = line.split()
+                if len(fields) == 7 and fields[0] == 'S':
+                    sent[fields[2]] = {
+                        'trace': fields[1], 'parent': fields[3],
+                        'model': fields[4], 'event': fields[5],
+                        'send': int(fields[6])}
+                elif len(fields) == 9 and fields[0] == 'R':
+                    received.append({
+                        'trace': fields[1], 'span': fields[2],
+                        'parent': fields[3], 'model': fields[4],
+                        'event': fields[5], 'send': int(fields[6]),
+                        'receive': int(fields[7]),
+                        'handler': int(fields[8])})
+    return sent, received
+
+
+def percentile(values, percent):
+    index = min(len(values) - 1, int(percent / 100.0 * len(values)))
+    return values[index]
+
+
+def print_table(title, rows):
+    print(title)
+    print('  %-48s %8s %10s %10s %10s %10s %10s' % (
+        '', 'count', 'mean', 'p50', 'p90', 'p99', 'max'))
+    for key in sorted(rows):
+        values = sorted(rows[key])
+        print('  %-48s %8d %10.1f %10.1f %10.1f %10.1f %10.1f' % (
+            key, len(values), sum(values) / len(values) / 1000.0,
+            percentile(values, 50) / 1000.0, percentile(values, 90) / 1000.0,
+            percentile(values, 99) / 1000.0, values[-1] / 1000.0))
+    print('')
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawTextHelpFormatter)
+    parser.add_argument('paths', nargs='+',
+                        help='span files or folders with span files')
+    parser.add_argument('--trace', default=None,
+                        help='print the spans of a single trace (ID)')
+    args = parser.parse_args()
+
+    files = []
+    for path in args.paths:
+        if os.path.isdir(path):
+            files.extend(sorted(glob.glob(os.path.join(path, '*.spans'))))
+        else:
+            files.append(path)
+    if not files:
+        sys.exit('No span files found')
+
+    sent, received = read_spans(files)
+
+    if args.trace is not None:
+        spans = [r for r in received if r['trace'] == args.trace]
+        root = min([s['send'] for s in sent.values()
+                    if s['trace'] == args.trace] or [0])
+        for r in sorted(spans, key=lambda r: r['receive']):
+            sender = sent.get(r['span'], {}).get('model', '?')
+            print('%10.1f %-20s -> %-20s %-24s hop %8.1f handler %8.1f' % (
+                (r['receive'] - root) / 1000.0, sender, r['model'],
+                r['event'], (r['receive'] - r['send']) / 1000.0,
+                r['handler'] / 1000.0))
+        return
+
+    hops = collections.defaultdict(list)
+    handlers = collections.defaultdict(list)
+    chain_ends = {}
+    for r in received:
+        sender = sent.get(r['span'], {}).get('model', '?')
+        hops['%s -%s-> %s' % (sender, r['event'], r['model'])].append(
+            r['receive'] - r['send'])
+        handlers['%s %s' % (r['model'], r['event'])].append(r['handler'])
+        chain_ends[r['trace']] = max(chain_ends.get(r['trace'], 0),
+                                     r['receive'] + r['handler'])
+
+    end_to_end = collections.defaultdict(list)
+    for span in sent.values():
+        if int(span['parent'], 16) == 0 and span['trace'] in chain_ends:
+            end_to_end[span['event']].append(
+                chain_ends[span['trace']] - span['send'])
+
+    print_table('Hops (publish -> receive)', hops)
+    print_table('Handlers', handlers)
+    print_table('End-to-end (root event)', end_to_end)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include "BranchFork.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+std::vector<pid_t> BranchFork::sChildren;
+
+namespace
+{
+// Sockets and files of the forked instance (e.g. the bound ports of the
+// parent stay with the parent)
+void closeInheritedDescriptors()
+{
+	std::vector<int> descriptors;
+	DIR* directory = opendir("/proc/self/fd");
+	if (directory == nullptr)
+	{
+		return;
+	}
+
+	while (dirent* entry = readdir(directory))
+	{
+		int fd = std::atoi(entry->d_name);
+		if (fd > STDERR_FILENO && fd != dirfd(directory))
+		{
+			descriptors.push_back(fd);
+		}
+	}
+	closedir(directory);
+
+	for (int fd : descriptors)
+	{
+		close(fd);
+	}
+}
+}
+
+int BranchFork::fork(int numBranches)
+{
+	// Buffered output would be written by every process
+	std::cout.flush();
+	std::cerr.flush();
+	std::fflush(nullptr);
+
+	for (int branch = 1; branch <= numBranches; branch++)
+	{
+		pid_t pid = ::fork();
+		if (pid == 0)
+		{
+			sChildren.clear();
+			closeInheritedDescriptors();
+			return branch;
+		}
+
+		if (pid < 0)
+		{
+			std::cerr << "Could not fork branch " << branch << ": "
+					<< std::strerror(errno) << std::endl;
+			break;
+		}
+		sChildren.push_back(pid);
+	}
+	return 0;
+}
+
+void BranchFork::exitBranch()
+{
+	std::cout.flush();
+	std::cerr.flush();
+	std::fflush(nullptr);
+	_exit(0);
+}
+
+void BranchFork::waitForBranches()
+{
+	for (pid_t child : sChildren)
+	{
+		while (waitpid(child, nullptr, 0) < 0 && errno == EINTR)
+		{
+		}
+	}
+	sChildren.clear();
+}
+
+std::vector<std::string> BranchFork::applyParameters(
+		ConfigurationDealer& dealer, const std::string& modelName, int branch,
+		FieldRegistry& fields)
+{
+	std::vector<std::string> invalidParameters;
+	for (size_t i = 0; i < fields.size(); i++)
+	{
+		const std::string& name = fields.getName(i);
+		std::string value = dealer.getBranchParameter(modelName, branch, name);
+		if (!value.empty() && !fields.setValueFromString(name, value))
+		{
+			invalidParameters.push_back(name + "=" + value);
+		}
+	}
+	return invalidParameters;
+}
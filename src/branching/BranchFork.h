@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef BRANCHING_BRANCHFORK_H_
+#define BRANCHING_BRANCHFORK_H_
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <zmq.hpp>
+
+#include "configuration/ConfigurationDealer.h"
+#include "reflection/FieldRegistry.h"
+
+// What-if branches of a running simulation: At the Fork event every model
+// process forks one child process per branch (copy-on-write memory, the
+// pages are copied when a branch changes them). The parent continues as
+// branch 0.
+//
+// The ZeroMQ context of the forked model is not usable in the child (its
+// I/O threads are not forked), hence the child creates a new instance of
+// the model (new context, ports of the branch, see
+// ConfigurationDealer::setBranch), which adopts the state of the forked
+// instance (adoptBranch), and runs the branch. The forked instance is not
+// destroyed, the child exits after the end of the branch.
+class BranchFork
+{
+public:
+	// Branch of the calling process: 0 in the parent, 1 ... numBranches in
+	// the children
+	static int fork(int numBranches);
+
+	// Exits the child after the end of its branch (without the destructors
+	// of the forked instance)
+	static void exitBranch();
+
+	// Waits for the children of the process (end of the simulation)
+	static void waitForBranches();
+
+	// Sets the fields to the parameters of the branch (Parameter elements of
+	// the Branch), returns the parameters with invalid values
+	static std::vector<std::string> applyParameters(
+			ConfigurationDealer& dealer, const std::string& modelName,
+			int branch, FieldRegistry& fields);
+
+	// Returns in the parent. The child creates the model of the branch with
+	// the constructor arguments of the forked model.
+	template<typename Model, typename ... Arguments>
+	static void forkBranches(Model& model, int numBranches,
+			const Arguments& ... arguments)
+	{
+		int branch = fork(numBranches);
+		if (branch == 0)
+		{
+			return;
+		}
+
+		ConfigurationDealer::setBranch(branch);
+		try
+		{
+			Model branchModel(arguments...);
+			branchModel.adoptBranch(model, branch);
+			branchModel.run();
+
+		} catch (zmq::error_t& e)
+		{
+			std::cerr << model.getName() << " (branch " << branch
+					<< "): Interrupt received: Exit" << std::endl;
+		} catch (std::runtime_error& e)
+		{
+			// E.g. the ports of the branch are invalid
+			std::cerr << model.getName() << " (branch " << branch
+					<< "): Fork failed: " << e.what() << std::endl;
+		}
+		exitBranch();
+	}
+
+private:
+	static std::vector<pid_t> sChildren;
+};
+
+#endif /* BRANCHING_BRANCHFORK_H_ */
@@ -0,0 +1,637 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include "ConfigurationDealer.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <boost/filesystem.hpp>
+
+#include "communication/zhelpers.hpp"
+#include "utilities/Hash.h"
+
+bool ConfigurationDealer::sJoinRequested = false;
+std::string ConfigurationDealer::sJoinAddress;
+std::vector<std::string> ConfigurationDealer::sJoinDependencies;
+bool ConfigurationDealer::sJoinPersist = false;
+int ConfigurationDealer::sBranch = 0;
+
+ConfigurationDealer::ConfigurationDealer(zmq::context_t& ctx,
+		std::string ownershipName) :
+		Dealer(ctx, ownershipName), mCtx(ctx), mOwnershipName(ownershipName)
+{
+	std::string version;
+	if (request("config_version", version) && !version.empty())
+	{
+		if (loadCachedBundle(version))
+		{
+			mBundleFromCache = true;
+		} else if (requestBundle())
+		{
+			storeCachedBundle(version);
+		}
+	} else
+	{
+		requestBundle();
+	}
+
+	if (sJoinRequested && hasBundle() && !isKnownModel())
+	{
+		registerModel();
+	}
+}
+
+ConfigurationDealer::~ConfigurationDealer()
+{
+	if (mRegistered)
+	{
+		std::string reply;
+		request("deregister", std::vector<std::string>
+		{ mOwnershipName }, reply, CONFIGURATION_DEREGISTER_TIMEOUT);
+	}
+}
+
+void ConfigurationDealer::setJoinRequest(const std::string& address,
+		const std::vector<std::string>& dependencies, bool persist)
+{
+	sJoinRequested = true;
+	sJoinAddress = address;
+	sJoinDependencies = dependencies;
+	sJoinPersist = persist;
+}
+
+void ConfigurationDealer::setBranch(int branch)
+{
+	sBranch = branch;
+}
+
+uint64_t ConfigurationDealer::getMembershipEpoch()
+{
+	std::string epoch;
+	if (!request("membership_epoch", epoch) || epoch.empty())
+	{
+		return 0;
+	}
+	return std::stoull(epoch);
+}
+
+void ConfigurationDealer::requestMembershipEpoch()
+{
+	if (mEpochRequestPending)
+	{
+		if (std::chrono::steady_clock::now() - mEpochRequestTime
+				< std::chrono::milliseconds(CONFIGURATION_BUNDLE_TIMEOUT))
+		{
+			return;
+		}
+
+		// A lost reply (e.g. restarted server) is dropped with the socket
+		mEpochSocket.reset();
+	}
+
+	try
+	{
+		if (!mEpochSocket)
+		{
+			mEpochSocket.reset(new zmq::socket_t(mCtx, ZMQ_DEALER));
+			mEpochSocket->setsockopt(ZMQ_LINGER, 0);
+			mEpochSocket->connect(CONFIGURATION_SERVER_ENDPOINT);
+		}
+
+		s_sendmore(*mEpochSocket, "membership_epoch");
+		s_send(*mEpochSocket, mOwnershipName, ZMQ_DONTWAIT);
+	} catch (zmq::error_t& e)
+	{
+		mEpochSocket.reset();
+		mEpochRequestPending = false;
+		return;
+	}
+
+	mEpochRequestPending = true;
+	mEpochRequestTime = std::chrono::steady_clock::now();
+}
+
+bool ConfigurationDealer::receiveMembershipEpoch(uint64_t& epoch)
+{
+	if (!mEpochRequestPending)
+	{
+		return false;
+	}
+
+	zmq::message_t replyMessage;
+	try
+	{
+		if (!mEpochSocket->recv(&replyMessage, ZMQ_DONTWAIT))
+		{
+			return false;
+		}
+	} catch (zmq::error_t& e)
+	{
+		return false;
+	}
+	mEpochRequestPending = false;
+
+	try
+	{
+		epoch = std::stoull(
+				std::string(static_cast<const char*>(replyMessage.data()),
+						replyMessage.size()));
+	} catch (std::exception& e)
+	{
+		return false;
+	}
+	return true;
+}
+
+bool ConfigurationDealer::refresh()
+{
+	mBundleFromCache = false;
+	return requestBundle();
+}
+
+bool ConfigurationDealer::request(const std::string& msg, std::string& reply)
+{
+	return request(msg, std::vector<std::string>
+	{ mOwnershipName }, reply);
+}
+
+bool ConfigurationDealer::request(const std::string& msg,
+		const std::vector<std::string>& arguments, std::string& reply,
+		int timeout)
+{
+	// The identity of the Dealer is already in use, hence the model name
+	// is sent as additional frame
+	zmq::socket_t socket(mCtx, ZMQ_DEALER);
+	socket.setsockopt(ZMQ_LINGER, 0);
+	socket.setsockopt(ZMQ_RCVTIMEO, timeout);
+
+	zmq::message_t replyMessage;
+	try
+	{
+		socket.connect(CONFIGURATION_SERVER_ENDPOINT);
+		s_sendmore(socket, msg);
+		for (size_t i = 0; i + 1 < arguments.size(); i++)
+		{
+			s_sendmore(socket, arguments[i]);
+		}
+		s_send(socket, arguments.empty() ? "" : arguments.back());
+
+		if (!socket.recv(&replyMessage))
+		{
+			return false;
+		}
+	} catch (zmq::error_t& e)
+	{
+		return false;
+	}
+
+	reply.assign(static_cast<const char*>(replyMessage.data()),
+			replyMessage.size());
+	return true;
+}
+
+bool ConfigurationDealer::requestBundle()
+{
+	std::string buffer;
+	if (!request("model_bundle", buffer))
+	{
+		return false;
+	}
+
+	return setBundle(buffer);
+}
+
+bool ConfigurationDealer::registerModel()
+{
+	std::vector<std::string> arguments
+	{ mOwnershipName, sJoinAddress, sJoinPersist ? "1" : "0" };
+	arguments.insert(arguments.end(), sJoinDependencies.begin(),
+			sJoinDependencies.end());
+
+	std::string port;
+	if (!request("register", arguments, port) || port.empty())
+	{
+		return false;
+	}
+
+	// The new bundle contains the port and the dependencies of the model
+	mRegistered = true;
+	return requestBundle();
+}
+
+bool ConfigurationDealer::isKnownModel() const
+{
+	if (mBundle == nullptr || mBundle->model_names() == nullptr)
+	{
+		return false;
+	}
+
+	for (auto modelName : *mBundle->model_names())
+	{
+		if (modelName->str() == mOwnershipName)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ConfigurationDealer::setBundle(std::string buffer)
+{
+	mBundleBuffer = std::move(buffer);
+
+	auto data = reinterpret_cast<const uint8_t*>(mBundleBuffer.data());
+	flatbuffers::Verifier verifier(data, mBundleBuffer.size());
+	if (mBundleBuffer.empty()
+			|| !configuration::VerifyModelBundleBuffer(verifier))
+	{
+		mBundleBuffer.clear();
+		mBundle = nullptr;
+		return false;
+	}
+
+	mBundle = configuration::GetModelBundle(data);
+
+	mEntryModels.clear();
+	if (mBundle->entry_models() != nullptr)
+	{
+		for (auto entryModel : *mBundle->entry_models())
+		{
+			mEntryModels.insert(entryModel->str());
+		}
+	}
+	return true;
+}
+
+std::string ConfigurationDealer::getCacheFilePath(
+		const std::string& version) const
+{
+	return CONFIGURATION_CACHE_PATH + version + "/" + mOwnershipName
+			+ ".bundle";
+}
+
+bool ConfigurationDealer::loadCachedBundle(const std::string& version)
+{
+	std::ifstream ifs(getCacheFilePath(version), std::ios::binary);
+	if (!ifs)
+	{
+		return false;
+	}
+
+	std::stringstream content;
+	content << ifs.rdbuf();
+
+	// The bundle contains the version as well (e.g. modified cache files)
+	if (!setBundle(content.str())
+			|| Hash::toHex(mBundle->version()) != version)
+	{
+		mBundleBuffer.clear();
+		mBundle = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+void ConfigurationDealer::storeCachedBundle(const std::string& version)
+{
+	// Write to a temporary file and rename it, so that concurrently
+	// starting models never read a partially written bundle
+	std::string filePath = getCacheFilePath(version);
+	std::string tmpFilePath = filePath + ".tmp";
+
+	try
+	{
+		boost::filesystem::create_directories(
+				boost::filesystem::path(filePath).parent_path());
+
+		std::ofstream ofs(tmpFilePath, std::ios::binary | std::ios::trunc);
+		ofs.write(mBundleBuffer.data(), mBundleBuffer.size());
+		ofs.close();
+
+		if (ofs)
+		{
+			boost::filesystem::rename(tmpFilePath, filePath);
+		}
+	} catch (boost::filesystem::filesystem_error& e)
+	{
+		// The cache is optional
+	}
+}
+
+bool ConfigurationDealer::coversModel(const std::string& modelName) const
+{
+	// Older bundles contain the entries of all models
+	return hasBundle()
+			&& (modelName.empty() || mBundle->entry_models() == nullptr
+					|| mEntryModels.count(modelName) > 0);
+}
+
+std::string ConfigurationDealer::getInformation(const std::string& key,
+		const std::string& modelName)
+{
+	// A key missing from the bundle is not set (no round trip)
+	std::string value;
+	if (!lookup(key, value) && !coversModel(modelName))
+	{
+		request(key, value);
+	}
+	return value;
+}
+
+bool ConfigurationDealer::lookup(const std::string& request,
+		std::string& value) const
+{
+	if (mBundle == nullptr || mBundle->information() == nullptr)
+	{
+		return false;
+	}
+
+	auto entry = mBundle->information()->LookupByKey(request.c_str());
+	if (entry == nullptr || entry->value() == nullptr)
+	{
+		return false;
+	}
+
+	value = entry->value()->str();
+	return true;
+}
+
+std::string ConfigurationDealer::getPortNumFrom(std::string modelName)
+{
+	std::string port;
+	if (!lookup(modelName + "_port", port) && !coversModel(modelName))
+	{
+		port = Dealer::getPortNumFrom(modelName);
+	}
+	return getBranchPort(port);
+}
+
+std::string ConfigurationDealer::getIPFrom(std::string modelName)
+{
+	std::string ip;
+	if (!lookup(modelName + "_ip", ip) && !coversModel(modelName))
+	{
+		ip = Dealer::getIPFrom(modelName);
+	}
+	return ip;
+}
+
+std::string ConfigurationDealer::getSynchronizationPort()
+{
+	std::string port;
+	if (!lookup("sim_sync_port", port) && !hasBundle())
+	{
+		port = Dealer::getSynchronizationPort();
+	}
+	return getBranchPort(port);
+}
+
+std::string ConfigurationDealer::getReportPort()
+{
+	return getBranchPort(getInformation("sim_report_port"));
+}
+
+std::string ConfigurationDealer::getInjectionPort(std::string modelName)
+{
+	return getBranchPort(
+			getInformation(modelName + "_injection_port", modelName));
+}
+
+std::string ConfigurationDealer::getLogLevel(std::string modelName)
+{
+	// Empty if not set (all severities)
+	return getInformation(modelName + "_log_level", modelName);
+}
+
+uint32_t ConfigurationDealer::getStatsInterval()
+{
+	std::string interval = getInformation("stats_interval");
+
+	try
+	{
+		return interval.empty() ? 1000 : uint32_t(std::stoul(interval));
+	} catch (std::exception& e)
+	{
+		return 1000;
+	}
+}
+
+std::string ConfigurationDealer::getMetricsPath()
+{
+	std::string path = getInformation("metrics_path");
+	return path.empty() ? path : getBranchPath(path);
+}
+
+std::string ConfigurationDealer::getTracePath()
+{
+	std::string path = getInformation("trace_path");
+	return path.empty() ? path : getBranchPath(path);
+}
+
+uint32_t ConfigurationDealer::getTraceSampling()
+{
+	std::string sampling = getInformation("trace_sampling");
+
+	try
+	{
+		return sampling.empty() ? 1 : uint32_t(std::stoul(sampling));
+	} catch (std::exception& e)
+	{
+		return 1;
+	}
+}
+
+uint32_t ConfigurationDealer::getFlightRecorderSize()
+{
+	std::string size = getInformation("flight_recorder_size");
+
+	try
+	{
+		return size.empty() ? 4096 : uint32_t(std::stoul(size));
+	} catch (std::exception& e)
+	{
+		return 4096;
+	}
+}
+
+std::string ConfigurationDealer::getFlightRecorderPath()
+{
+	std::string path = getInformation("flight_recorder_path");
+	return getBranchPath(path);
+}
+
+uint64_t ConfigurationDealer::getSavepointRegionSize()
+{
+	std::string size = getInformation("savepoint_region_size");
+
+	try
+	{
+		return size.empty() ? 16777216 : uint64_t(std::stoull(size));
+	} catch (std::exception& e)
+	{
+		return 16777216;
+	}
+}
+
+std::string ConfigurationDealer::getSyncMode()
+{
+	return getInformation("sync_mode");
+}
+
+bool ConfigurationDealer::getLazyRestore()
+{
+	std::string lazy = getInformation("lazy_restore");
+	return lazy != "0";
+}
+
+std::string ConfigurationDealer::getParameter(std::string modelName,
+		std::string parameter)
+{
+	return getInformation(modelName + "_param_" + parameter, modelName);
+}
+
+int ConfigurationDealer::getNumberOfBranches()
+{
+	std::string branches = getInformation("num_branches");
+
+	try
+	{
+		return branches.empty() ? 0 : std::stoi(branches);
+	} catch (std::exception& e)
+	{
+		return 0;
+	}
+}
+
+uint64_t ConfigurationDealer::getForkTime()
+{
+	std::string time = getInformation("fork_time");
+
+	try
+	{
+		return time.empty() ? 0 : uint64_t(std::stoull(time));
+	} catch (std::exception& e)
+	{
+		return 0;
+	}
+}
+
+std::string ConfigurationDealer::getBranchParameter(std::string modelName,
+		int branch, std::string parameter)
+{
+	std::string key = modelName + "_branch_" + std::to_string(branch)
+			+ "_param_" + parameter;
+	return getInformation(key, modelName);
+}
+
+std::vector<std::string> ConfigurationDealer::getModelDependencies()
+{
+	if (mBundle == nullptr || mBundle->dependencies() == nullptr)
+	{
+		return Dealer::getModelDependencies();
+	}
+
+	std::vector<std::string> modelDependencies;
+	for (auto dependency : *mBundle->dependencies())
+	{
+		modelDependencies.push_back(dependency->str());
+	}
+	return modelDependencies;
+}
+
+std::vector<std::string> ConfigurationDealer::getAllModelNames()
+{
+	if (mBundle == nullptr || mBundle->model_names() == nullptr)
+	{
+		return Dealer::getAllModelNames();
+	}
+
+	std::vector<std::string> modelNames;
+	for (auto modelName : *mBundle->model_names())
+	{
+		modelNames.push_back(modelName->str());
+	}
+	return modelNames;
+}
+
+int ConfigurationDealer::getTotalNumberOfModels()
+{
+	if (mBundle == nullptr)
+	{
+		return Dealer::getTotalNumberOfModels();
+	}
+	return mBundle->total_num_models();
+}
+
+int ConfigurationDealer::getNumberOfPersistModels()
+{
+	if (mBundle == nullptr)
+	{
+		return Dealer::getNumberOfPersistModels();
+	}
+	return mBundle->num_persist_models();
+}
+
+bool ConfigurationDealer::isPersistModel(std::string modelName)
+{
+	std::string persist = getInformation(modelName + "_persist", modelName);
+	return persist == "1";
+}
+
+std::string ConfigurationDealer::getBranchPort(const std::string& port)
+{
+	if (sBranch == 0 || port.empty())
+	{
+		return port;
+	}
+
+	std::string range = getInformation("branch_port_range");
+
+	// The branch must not reuse the ports of the parent (fails the fork)
+	unsigned long branchPort = 0;
+	try
+	{
+		branchPort = std::stoul(port) + sBranch * std::stoul(range);
+	} catch (std::exception& e)
+	{
+		throw std::runtime_error(
+				"[Error] Invalid branch port range '" + range + "' (port "
+						+ port + ")");
+	}
+
+	if (branchPort > 65535)
+	{
+		throw std::runtime_error(
+				"[Error] Exceeded max. port number in branch "
+						+ std::to_string(sBranch) + " (port " + port
+						+ ") --> Decrease the branch port range");
+	}
+
+	return std::to_string(branchPort);
+}
+
+std::string ConfigurationDealer::getBranchPath(const std::string& path) const
+{
+	if (sBranch == 0)
+	{
+		return path;
+	}
+
+	// PATH/branch_N/ (the working directory if the path is empty)
+	std::string branchPath = path + "branch_" + std::to_string(sBranch) + "/";
+	boost::system::error_code error;
+	boost::filesystem::create_directories(branchPath, error);
+	return branchPath;
+}
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef CONFIGURATION_CONFIGURATIONDEALER_H_
+#define CONFIGURATION_CONFIGURATIONDEALER_H_
+
+#include <chrono>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include <zmq.hpp>
+#include <flatbuffers/flatbuffers.h>
+
+#include "communication/Dealer.h"
+
+#include "resources/idl/configuration_generated.h"
+
+// Endpoint of the configuration server (same as the Dealer)
+#ifndef CONFIGURATION_SERVER_ENDPOINT
+#define CONFIGURATION_SERVER_ENDPOINT std::string("tcp://localhost:5570")
+#endif
+
+// Timeout of the bundle request in milliseconds
+#define CONFIGURATION_BUNDLE_TIMEOUT 2000
+
+// Timeout of the deregistration in milliseconds (the configuration server
+// could already be stopped at the end of the simulation)
+#define CONFIGURATION_DEREGISTER_TIMEOUT 500
+
+// Directory of the cached bundles (one sub directory per configuration version)
+#ifndef CONFIGURATION_CACHE_PATH
+#define CONFIGURATION_CACHE_PATH std::string("../configurations/cache/")
+#endif
+
+//  Drop-in replacement of the Dealer: Requests all information of the model
+//  with a single "model_bundle" request during the construction instead of
+//  one round trip per request. If the bundle is not available (e.g. older
+//  configuration server), the requests are forwarded to the Dealer. Otherwise
+//  a key missing from the bundle is not set, only the keys of models whose
+//  entries are not part of the bundle are requested.
+//  The bundle is cached on disk, keyed by the hash of the hosts-config file.
+//  A restarted model only requests the version ("config_version") and
+//  loads its bundle from the cache if the version did not change.
+//  Models, which are not part of the hosts-config file, can join the running
+//  simulation (see setJoinRequest) and leave it with their destruction.
+
+class ConfigurationDealer: public Dealer
+{
+public:
+	ConfigurationDealer(zmq::context_t& ctx, std::string ownershipName);
+	virtual ~ConfigurationDealer();
+
+	// Register the model during the construction if it is not part of the
+	// hosts-config file (has to be called before the model is created).
+	// Persistent models take part in the savepoint barriers.
+	static void setJoinRequest(const std::string& address,
+			const std::vector<std::string>& dependencies, bool persist);
+
+	// Branch of the process (0: the models of the hosts-config file). The
+	// ports and output folders of the branches are separated (has to be set
+	// before the model of the branch is created, see BranchFork)
+	static void setBranch(int branch);
+	static int getBranch()
+	{
+		return sBranch;
+	}
+
+	// Changes with every joining or leaving model (0 if not available)
+	uint64_t getMembershipEpoch();
+
+	// Non-blocking variant on a persistent socket: The request is sent if
+	// none is pending (or the pending one timed out), the receive returns
+	// false until its reply arrived
+	void requestMembershipEpoch();
+	bool receiveMembershipEpoch(uint64_t& epoch);
+
+	// Request the current bundle (e.g. after the membership changed)
+	bool refresh();
+
+	std::string getPortNumFrom(std::string modelName);
+	std::string getIPFrom(std::string modelName);
+	std::string getSynchronizationPort();
+
+	// Tick reports to the simulation model (empty if not available)
+	std::string getReportPort();
+
+	// Event injection endpoint of the model (empty if injection is disabled)
+	std::string getInjectionPort(std::string modelName);
+	std::string getLogLevel(std::string modelName);
+	uint32_t getStatsInterval();
+	std::string getMetricsPath();
+	std::string getTracePath();
+	uint32_t getTraceSampling();
+	uint32_t getFlightRecorderSize();
+	std::string getFlightRecorderPath();
+
+	// time-stepped, conservative or optimistic (empty if not configured)
+	std::string getSyncMode();
+
+	// Bytes per model in the savepoint container (0: savepoint directories)
+	uint64_t getSavepointRegionSize();
+
+	// Large states are decoded at their first use (after the barrier)
+	bool getLazyRestore();
+
+	// Parameter of the model (element Parameter, empty if not set)
+	std::string getParameter(std::string modelName, std::string parameter);
+
+	// What-if branches (0: none), forked at the fork time
+	int getNumberOfBranches();
+	uint64_t getForkTime();
+
+	// Parameter of the model in the branch (empty if not set)
+	std::string getBranchParameter(std::string modelName, int branch,
+			std::string parameter);
+
+	// Output folder of the branch (PATH/branch_N/, created if needed), the
+	// path itself in branch 0
+	std::string getBranchPath(const std::string& path) const;
+
+	std::vector<std::string> getModelDependencies();
+	std::vector<std::string> getAllModelNames();
+	int getTotalNumberOfModels();
+	int getNumberOfPersistModels();
+
+	// The model writes its state into the savepoints (attribute persist)
+	bool isPersistModel(std::string modelName);
+
+	bool hasBundle() const
+	{
+		return mBundle != nullptr;
+	}
+
+	bool isBundleFromCache() const
+	{
+		return mBundleFromCache;
+	}
+
+private:
+	// Sends the request (and the arguments, by default the model name) and
+	// waits for a single reply
+	bool request(const std::string& msg, std::string& reply);
+	bool request(const std::string& msg,
+			const std::vector<std::string>& arguments, std::string& reply,
+			int timeout = CONFIGURATION_BUNDLE_TIMEOUT);
+	bool requestBundle();
+	bool registerModel();
+	bool isKnownModel() const;
+	bool loadCachedBundle(const std::string& version);
+	void storeCachedBundle(const std::string& version);
+	bool setBundle(std::string buffer);
+	std::string getCacheFilePath(const std::string& version) const;
+
+	// Returns false if the bundle does not contain the requested information
+	bool lookup(const std::string& request, std::string& value) const;
+
+	// The bundle contains the entries of the model (global keys: modelName
+	// is empty)
+	bool coversModel(const std::string& modelName) const;
+
+	// Value of the bundle, requested only if the bundle does not cover the
+	// model (empty if not set)
+	std::string getInformation(const std::string& key,
+			const std::string& modelName = "");
+
+	// Ports of the branch, throws std::runtime_error if the port range is
+	// missing or the port of the branch exceeds 65535
+	std::string getBranchPort(const std::string& port);
+
+	zmq::context_t& mCtx;
+	std::string mOwnershipName;
+	bool mRegistered = false;
+
+	static bool sJoinRequested;
+	static std::string sJoinAddress;
+	static std::vector<std::string> sJoinDependencies;
+	static bool sJoinPersist;
+	static int sBranch;
+
+	// Received buffer and the root of the bundle within it
+	std::string mBundleBuffer;
+	const configuration::ModelBundle* mBundle = nullptr;
+	std::set<std::string> mEntryModels;
+	bool mBundleFromCache = false;
+
+	// Asynchronous membership epoch requests
+	std::unique_ptr<zmq::socket_t> mEpochSocket;
+	bool mEpochRequestPending = false;
+	std::chrono::steady_clock::time_point mEpochRequestTime;
+};
+
+#endif /* CONFIGURATION_CONFIGURATIONDEALER_H_ */
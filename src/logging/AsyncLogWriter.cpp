@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include "AsyncLogWriter.h"
+
+#include <algorithm>
+
+AsyncLogWriter::AsyncLogWriter(size_t capacity, size_t batchSize) :
+		mRing(capacity), mBatchSize(batchSize), mFile(nullptr), mStop(false), mWriterSleeping(
+				false), mFlushInterval(100), mFlushRequests(0), mFlushesDone(
+				0), mCachedSecond(-1), mReportedDrops(0), mMaxQueueDepth(0), mPushed(
+				0), mDropped(0), mWritten(0), mWrites(0)
+{
+	// Reserve the message buffers, so that pushing a record does not allocate
+	for (auto& record : mRing.getSlots())
+	{
+		record.message.reserve(256);
+	}
+	mBatch.reserve(mBatchSize + 1024);
+	mCachedTimeStamp[0] = '\0';
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+	stop();
+}
+
+bool AsyncLogWriter::open(const std::string& filePath)
+{
+	mFile = std::fopen(filePath.c_str(), "a");
+	if (mFile == nullptr)
+	{
+		return false;
+	}
+
+	// The batches are the buffers
+	std::setvbuf(mFile, nullptr, _IONBF, 0);
+	return true;
+}
+
+bool AsyncLogWriter::openBinary(const std::string& filePath, bool compress)
+{
+	return mBinaryLog.open(filePath, compress);
+}
+
+void AsyncLogWriter::addSource(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mNewSources.push_back(name);
+}
+
+void AsyncLogWriter::start()
+{
+	if (!mWriter.joinable())
+	{
+		mStop.store(false);
+		mWriter = std::thread(&AsyncLogWriter::writeLoop, this);
+	}
+}
+
+void AsyncLogWriter::stop()
+{
+	if (mWriter.joinable())
+	{
+		mStop.store(true);
+		wakeUpWriter();
+		mWriter.join();
+	}
+
+	if (mFile != nullptr)
+	{
+		std::fclose(mFile);
+		mFile = nullptr;
+	}
+
+	// Writes the index of the blocks
+	mBinaryLog.close();
+}
+
+bool AsyncLogWriter::push(LogSeverity severity, boost::string_view message,
+		uint64_t simTime)
+{
+	LogRecord* record = mRing.claim();
+	if (record == nullptr)
+	{
+		mDropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	record->wallTime = std::chrono::system_clock::now();
+	record->simTime = simTime;
+	record->severity = severity;
+	record->message.assign(message.data(), message.size());
+	mRing.publish();
+	mPushed.fetch_add(1, std::memory_order_relaxed);
+
+	size_t depth = mRing.size();
+	if (depth > mMaxQueueDepth.load(std::memory_order_relaxed))
+	{
+		mMaxQueueDepth.store(depth, std::memory_order_relaxed);
+	}
+
+	// The writer wakes up by itself after the flush interval, it is only
+	// woken up earlier if the ring buffer is about to run full
+	if (depth >= mRing.capacity() / 2)
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (mWriterSleeping.load(std::memory_order_relaxed))
+		{
+			wakeUpWriter();
+		}
+	}
+
+	return true;
+}
+
+void AsyncLogWriter::flush()
+{
+	if (!mWriter.joinable())
+	{
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	uint64_t request = mFlushRequests.fetch_add(1) + 1;
+	mWakeUp.notify_one();
+	mFlushed.wait(lock, [this, request]
+	{	return mFlushesDone >= request;});
+}
+
+void AsyncLogWriter::wakeUpWriter()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mWakeUp.notify_one();
+}
+
+void AsyncLogWriter::writeLoop()
+{
+	auto lastWrite = std::chrono::steady_clock::now();
+
+	while (true)
+	{
+		// Read before draining: the records of these requests are in the ring
+		bool stop = mStop.load();
+		uint64_t flushRequests = mFlushRequests.load();
+
+		drain();
+
+		auto interval = std::chrono::milliseconds(
+				mFlushInterval.load(std::memory_order_relaxed));
+		auto now = std::chrono::steady_clock::now();
+
+		bool flushRequested = false;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			flushRequested = flushRequests > mFlushesDone;
+		}
+
+		if (stop || flushRequested || now - lastWrite >= interval)
+		{
+			writeBatch();
+			lastWrite = now;
+		}
+
+		if (flushRequested)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mFlushesDone = flushRequests;
+			mFlushed.notify_all();
+		}
+
+		if (stop)
+		{
+			break;
+		}
+
+		std::unique_lock<std::mutex> lock(mMutex);
+		mWriterSleeping.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (mRing.size() < mRing.capacity() / 2 && !mStop.load()
+				&& mFlushRequests.load() == mFlushesDone)
+		{
+			mWakeUp.wait_for(lock,
+					std::max(interval - (now - lastWrite),
+							std::chrono::steady_clock::duration(
+									std::chrono::milliseconds(1))));
+		}
+		mWriterSleeping.store(false, std::memory_order_relaxed);
+	}
+}
+
+size_t AsyncLogWriter::drain()
+{
+	size_t count = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		for (auto& source : mNewSources)
+		{
+			mBinaryLog.addSource(source);
+		}
+		mNewSources.clear();
+	}
+
+	uint64_t dropped = mDropped.load(std::memory_order_relaxed);
+	if (dropped > mReportedDrops)
+	{
+		formatDropped(dropped - mReportedDrops);
+		mReportedDrops = dropped;
+	}
+
+	while (LogRecord* record = mRing.front())
+	{
+		format(*record);
+		if (mRecordHandler)
+		{
+			mRecordHandler(*record);
+		}
+		mRing.pop();
+		count++;
+
+		if (mBatch.size() >= mBatchSize)
+		{
+			writeBatch();
+		}
+	}
+
+	mWritten.fetch_add(count, std::memory_order_relaxed);
+	return count;
+}
+
+void AsyncLogWriter::appendTimeStamp(
+		std::chrono::system_clock::time_point wallTime)
+{
+	auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(
+			wallTime.time_since_epoch()).count();
+	std::time_t second = std::time_t(microseconds / 1000000);
+
+	// Same format as the TimeStamp attribute of boost.log
+	if (second != mCachedSecond)
+	{
+		std::tm localTime;
+		localtime_r(&second, &localTime);
+		std::strftime(mCachedTimeStamp, sizeof(mCachedTimeStamp),
+				"%Y-%b-%d %H:%M:%S", &localTime);
+		mCachedSecond = second;
+	}
+
+	char fraction[8];
+	std::snprintf(fraction, sizeof(fraction), ".%06u",
+			unsigned(microseconds % 1000000));
+
+	mBatch.append(mCachedTimeStamp);
+	mBatch.append(fraction);
+}
+
+void AsyncLogWriter::format(const LogRecord& record)
+{
+	if (mBinaryLog.isOpen())
+	{
+		mBinaryLog.append(
+				uint64_t(
+						std::chrono::duration_cast<std::chrono::microseconds>(
+								record.wallTime.time_since_epoch()).count()),
+				record.simTime, record.severity, record.message);
+		return;
+	}
+
+	mBatch.push_back('[');
+	appendTimeStamp(record.wallTime);
+	mBatch.append("] [");
+	mBatch.append(toString(record.severity));
+	mBatch.append("] ");
+	mBatch.append(record.message);
+	mBatch.push_back('\n');
+}
+
+void AsyncLogWriter::formatDropped(uint64_t dropped)
+{
+	if (mBinaryLog.isOpen())
+	{
+		LogRecord record;
+		record.wallTime = std::chrono::system_clock::now();
+		record.severity = LogSeverity::WARNING;
+		record.message = std::to_string(dropped)
+				+ " log records dropped (queue full)";
+		format(record);
+		return;
+	}
+
+	mBatch.push_back('[');
+	appendTimeStamp(std::chrono::system_clock::now());
+	mBatch.append("] [warning] ");
+	mBatch.append(std::to_string(dropped));
+	mBatch.append(" log records dropped (queue full)\n");
+}
+
+void AsyncLogWriter::writeBatch()
+{
+	if (mBinaryLog.isOpen())
+	{
+		if (mBinaryLog.writeBlock())
+		{
+			mWrites.fetch_add(1, std::memory_order_relaxed);
+		}
+		return;
+	}
+
+	if (mBatch.empty())
+	{
+		return;
+	}
+
+	if (mFile != nullptr)
+	{
+		std::fwrite(mBatch.data(), 1, mBatch.size(), mFile);
+		mWrites.fetch_add(1, std::memory_order_relaxed);
+	}
+	mBatch.clear();
+}
+
+std::string AsyncLogWriter::getSummary() const
+{
+	return "records=" + std::to_string(getPushed()) + " dropped="
+			+ std::to_string(getDropped()) + " queue_depth="
+			+ std::to_string(getQueueDepth()) + " max_queue_depth="
+			+ std::to_string(getMaxQueueDepth()) + "/"
+			+ std::to_string(mRing.capacity()) + " writes="
+			+ std::to_string(getWrites());
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef LOGGING_ASYNCLOGWRITER_H_
+#define LOGGING_ASYNCLOGWRITER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/utility/string_view.hpp>
+
+#include "logging/BinaryLogFormat.h"
+#include "logging/LogRing.h"
+#include "logging/LogRecord.h"
+
+// Writes log records to a file in a background thread.
+// The receiving thread only copies a record into a lock-free ring buffer
+// (push), the writer thread formats the records and writes them in large
+// batches. A batch is written if it is full, if the flush interval has
+// expired, if a flush is requested or if the writer is stopped.
+// Records are dropped (and counted) if the ring buffer is full.
+// The file is either a text file or a binary log file (BinaryLogFormat.h),
+// in which a batch corresponds to a block.
+class AsyncLogWriter
+{
+public:
+	typedef std::function<void(const LogRecord&)> RecordHandler;
+
+	AsyncLogWriter(size_t capacity = 8192, size_t batchSize = 64 * 1024);
+	~AsyncLogWriter();
+
+	AsyncLogWriter(const AsyncLogWriter&) = delete;
+	AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+
+	bool open(const std::string& filePath);
+	bool openBinary(const std::string& filePath, bool compress);
+	void start();
+
+	// Known source models of the binary log file (any thread)
+	void addSource(const std::string& name);
+
+	// Writes all pending records, flushes and closes the file
+	void stop();
+
+	// Producer (one thread only)
+	bool push(LogSeverity severity, boost::string_view message,
+			uint64_t simTime = 0);
+
+	// Blocks until all records pushed so far are written
+	void flush();
+
+	// Milliseconds between two writes of a partially filled batch
+	void setFlushInterval(uint32_t milliseconds)
+	{
+		mFlushInterval.store(milliseconds, std::memory_order_relaxed);
+	}
+
+	// Called by the writer thread for each record (set before start)
+	void setRecordHandler(RecordHandler handler)
+	{
+		mRecordHandler = handler;
+	}
+
+	size_t getQueueDepth() const
+	{
+		return mRing.size();
+	}
+
+	size_t getMaxQueueDepth() const
+	{
+		return mMaxQueueDepth.load(std::memory_order_relaxed);
+	}
+
+	uint64_t getPushed() const
+	{
+		return mPushed.load(std::memory_order_relaxed);
+	}
+
+	uint64_t getDropped() const
+	{
+		return mDropped.load(std::memory_order_relaxed);
+	}
+
+	uint64_t getWritten() const
+	{
+		return mWritten.load(std::memory_order_relaxed);
+	}
+
+	uint64_t getWrites() const
+	{
+		return mWrites.load(std::memory_order_relaxed);
+	}
+
+	std::string getSummary() const;
+
+private:
+	void writeLoop();
+	size_t drain();
+	void format(const LogRecord& record);
+	void formatDropped(uint64_t dropped);
+	void appendTimeStamp(std::chrono::system_clock::time_point wallTime);
+	void writeBatch();
+	void wakeUpWriter();
+
+	LogRing<LogRecord> mRing;
+	std::string mBatch;
+	size_t mBatchSize;
+	std::FILE* mFile;
+	BinaryLogWriter mBinaryLog;
+	std::vector<std::string> mNewSources;
+	RecordHandler mRecordHandler;
+
+	std::thread mWriter;
+	std::mutex mMutex;
+	std::condition_variable mWakeUp;
+	std::condition_variable mFlushed;
+	std::atomic<bool> mStop;
+	std::atomic<bool> mWriterSleeping;
+	std::atomic<uint32_t> mFlushInterval;
+	std::atomic<uint64_t> mFlushRequests;
+	uint64_t mFlushesDone;
+
+	// Formatted date and time of the last second (writer thread)
+	std::time_t mCachedSecond;
+	char mCachedTimeStamp[32];
+	uint64_t mReportedDrops;
+
+	// Statistics
+	std::atomic<size_t> mMaxQueueDepth;
+	std::atomic<uint64_t> mPushed;
+	std::atomic<uint64_t> mDropped;
+	std::atomic<uint64_t> mWritten;
+	std::atomic<uint64_t> mWrites;
+};
+
+#endif /* LOGGING_ASYNCLOGWRITER_H_ */
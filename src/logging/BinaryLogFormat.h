@@ -0,0 +1,985 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef LOGGING_BINARYLOGFORMAT_H_
+#define LOGGING_BINARYLOGFORMAT_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <boost/utility/string_view.hpp>
+#include <zlib.h>
+
+#include "logging/LogRecord.h"
+
+// Compact binary log files (*.flog)
+//
+//   FileHeader
+//   Block*            BlockHeader, dictionary section, record section
+//   Index             IndexEntry per block (missing if not closed)
+//   Trailer
+//
+// Strings (source models and message templates) are stored once in the
+// dictionary section of the block in which they are used first. A message
+// is split into its source model (leading model name), a template in which
+// the tokens with digits (numbers and identifiers, e.g. 42, 1.5 or
+// model_1_0) are replaced by ARG_PLACEHOLDER and these tokens (args).
+// A record is: wall time delta, sim time delta (zigzag), severity, source
+// ID, template ID, number of args and the args (all varints). The deltas
+// refer to the previous record of the block (first record: to zero). An
+// arg is an integer (value << 1) or the length of the token
+// ((length << 1) | 1) followed by its characters.
+//
+// The dictionary holds at most MAX_DICTIONARY_STRINGS strings, if it is
+// full the next block starts a new one (flag DICTIONARY_RESET).
+//
+// The block header contains the sim time and wall time range, a mask of
+// the severities and a mask of the sources (bit: source ID % 64), so that
+// a reader can skip blocks without decompressing the record section. With
+// the index a reader seeks to the first block of the sim time range of its
+// filter (the dictionary is read from the last reset before it) and stops
+// after the last one.
+// Integers are stored in the byte order of the host (little endian).
+namespace BinaryLog
+{
+const char FILE_MAGIC[8] =
+{ 'F', 'R', 'L', 'O', 'G', 'B', 'I', 'N' };
+const char INDEX_MAGIC[8] =
+{ 'F', 'R', 'L', 'O', 'G', 'I', 'D', 'X' };
+const uint32_t FORMAT_VERSION = 2;
+const uint32_t BLOCK_MAGIC = 0x4b4c4246; // "FBLK"
+const char ARG_PLACEHOLDER = '\x01';
+const size_t MAX_DICTIONARY_STRINGS = 65536;
+
+enum Compression : uint8_t
+{
+	NO_COMPRESSION,
+	ZLIB_COMPRESSION
+};
+
+enum BlockFlags : uint8_t
+{
+	DICTIONARY_RESET = 1
+};
+
+struct FileHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t flags;
+};
+
+struct BlockHeader
+{
+	uint32_t magic;
+	uint8_t compression;
+	uint8_t severityMask;
+	uint8_t flags;
+	uint8_t reserved;
+	uint32_t numRecords;
+	uint32_t dictionarySize;
+	uint32_t rawSize;
+	uint32_t storedSize;
+	uint64_t sourceMask;
+	uint64_t minSimTime;
+	uint64_t maxSimTime;
+	uint64_t minWallTime; // us since epoch
+	uint64_t maxWallTime;
+};
+
+struct IndexEntry
+{
+	uint64_t offset;
+	uint64_t minSimTime;
+	uint64_t maxSimTime;
+	uint64_t sourceMask;
+	uint32_t numRecords;
+	uint8_t severityMask;
+	uint8_t flags;
+	uint8_t reserved[2];
+};
+
+struct Trailer
+{
+	uint64_t indexOffset;
+	uint64_t numBlocks;
+	char magic[8];
+};
+
+static_assert(sizeof(BlockHeader) == 64, "Unexpected BlockHeader size");
+static_assert(sizeof(IndexEntry) == 40, "Unexpected IndexEntry size");
+
+inline void appendVarint(std::string& buffer, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		buffer.push_back(char((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	buffer.push_back(char(value));
+}
+
+inline bool readVarint(const char*& pos, const char* end, uint64_t& value)
+{
+	value = 0;
+	for (int shift = 0; shift < 64 && pos < end; shift += 7)
+	{
+		uint8_t byte = uint8_t(*pos++);
+		value |= uint64_t(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+inline uint64_t zigzag(int64_t value)
+{
+	return (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value)
+{
+	return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
+
+inline uint64_t sourceBit(uint64_t sourceID)
+{
+	return uint64_t(1) << (sourceID % 64);
+}
+
+inline uint8_t severityBit(LogSeverity severity)
+{
+	return uint8_t(1 << uint8_t(severity));
+}
+
+inline bool isDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+}
+
+class BinaryLogWriter
+{
+public:
+	BinaryLogWriter(size_t blockSize = 64 * 1024) :
+			mFile(nullptr), mBlockSize(blockSize), mCompression(
+					BinaryLog::NO_COMPRESSION), mNumArgs(0)
+	{
+		mRecords.reserve(mBlockSize + 1024);
+		resetBlock();
+	}
+
+	~BinaryLogWriter()
+	{
+		close();
+	}
+
+	BinaryLogWriter(const BinaryLogWriter&) = delete;
+	BinaryLogWriter& operator=(const BinaryLogWriter&) = delete;
+
+	bool open(const std::string& filePath, bool compress)
+	{
+		mFile = std::fopen(filePath.c_str(), "wb");
+		if (mFile == nullptr)
+		{
+			return false;
+		}
+
+		mCompression =
+				compress ?
+						BinaryLog::ZLIB_COMPRESSION : BinaryLog::NO_COMPRESSION;
+
+		BinaryLog::FileHeader header;
+		std::memcpy(header.magic, BinaryLog::FILE_MAGIC, sizeof(header.magic));
+		header.version = BinaryLog::FORMAT_VERSION;
+		header.flags = 0;
+		std::fwrite(&header, sizeof(header), 1, mFile);
+		return true;
+	}
+
+	bool isOpen() const
+	{
+		return mFile != nullptr;
+	}
+
+	// Messages starting with a source name (followed by ':' or ' ') are
+	// stored with the ID of the source
+	void addSource(const std::string& name)
+	{
+		mSources.insert(name);
+	}
+
+	void append(uint64_t wallTime, uint64_t simTime, LogSeverity severity,
+			boost::string_view message)
+	{
+		// Both strings of the record fit into the dictionary
+		if (mStrings.size() + 2 > BinaryLog::MAX_DICTIONARY_STRINGS)
+		{
+			writeBlock();
+			mStrings.clear();
+			mHeader.flags |= BinaryLog::DICTIONARY_RESET;
+		}
+
+		uint64_t sourceID = 0;
+		size_t end = message.find_first_of(": ");
+		if (end != boost::string_view::npos && end > 0)
+		{
+			mString.assign(message.data(), end);
+			if (mSources.count(mString) != 0)
+			{
+				sourceID = intern(mString);
+				message.remove_prefix(end);
+			}
+		}
+
+		splitMessage(message);
+		uint64_t templateID = intern(mString);
+
+		if (mNumRecords == 0)
+		{
+			mHeader.minWallTime = wallTime;
+			mHeader.minSimTime = mHeader.maxSimTime = simTime;
+		}
+
+		BinaryLog::appendVarint(mRecords,
+				wallTime >= mLastWallTime ? wallTime - mLastWallTime : 0);
+		BinaryLog::appendVarint(mRecords,
+				BinaryLog::zigzag(int64_t(simTime - mLastSimTime)));
+		mRecords.push_back(char(severity));
+		BinaryLog::appendVarint(mRecords, sourceID);
+		BinaryLog::appendVarint(mRecords, templateID);
+		BinaryLog::appendVarint(mRecords, mNumArgs);
+		mRecords.append(mArgs);
+
+		mLastWallTime = std::max(mLastWallTime, wallTime);
+		mLastSimTime = simTime;
+		mNumRecords++;
+		mHeader.minSimTime = std::min(mHeader.minSimTime, simTime);
+		mHeader.maxSimTime = std::max(mHeader.maxSimTime, simTime);
+		mHeader.maxWallTime = mLastWallTime;
+		mHeader.severityMask |= BinaryLog::severityBit(severity);
+		mHeader.sourceMask |= BinaryLog::sourceBit(sourceID);
+
+		if (mRecords.size() + mDictionary.size() >= mBlockSize)
+		{
+			writeBlock();
+		}
+	}
+
+	// Writes the current (partially filled) block
+	bool writeBlock()
+	{
+		if (mFile == nullptr || mNumRecords == 0)
+		{
+			return false;
+		}
+
+		const std::string* payload = &mRecords;
+		mHeader.compression = BinaryLog::NO_COMPRESSION;
+
+		if (mCompression == BinaryLog::ZLIB_COMPRESSION)
+		{
+			uLongf size = compressBound(uLong(mRecords.size()));
+			mCompressed.resize(size);
+			if (compress2(reinterpret_cast<Bytef*>(&mCompressed[0]), &size,
+					reinterpret_cast<const Bytef*>(mRecords.data()),
+					uLong(mRecords.size()), Z_BEST_SPEED) == Z_OK
+					&& size < mRecords.size())
+			{
+				mCompressed.resize(size);
+				payload = &mCompressed;
+				mHeader.compression = BinaryLog::ZLIB_COMPRESSION;
+			}
+		}
+
+		mHeader.numRecords = mNumRecords;
+		mHeader.dictionarySize = uint32_t(mDictionary.size());
+		mHeader.rawSize = uint32_t(mRecords.size());
+		mHeader.storedSize = uint32_t(payload->size());
+
+		BinaryLog::IndexEntry entry;
+		std::memset(&entry, 0, sizeof(entry));
+		entry.offset = uint64_t(std::ftell(mFile));
+		entry.minSimTime = mHeader.minSimTime;
+		entry.maxSimTime = mHeader.maxSimTime;
+		entry.sourceMask = mHeader.sourceMask;
+		entry.numRecords = mHeader.numRecords;
+		entry.severityMask = mHeader.severityMask;
+		entry.flags = mHeader.flags;
+		mIndex.push_back(entry);
+
+		std::fwrite(&mHeader, sizeof(mHeader), 1, mFile);
+		std::fwrite(mDictionary.data(), 1, mDictionary.size(), mFile);
+		std::fwrite(payload->data(), 1, payload->size(), mFile);
+		std::fflush(mFile);
+
+		resetBlock();
+		return true;
+	}
+
+	// Writes the last block, the index and the trailer
+	void close()
+	{
+		if (mFile == nullptr)
+		{
+			return;
+		}
+
+		writeBlock();
+
+		BinaryLog::Trailer trailer;
+		trailer.indexOffset = uint64_t(std::ftell(mFile));
+		trailer.numBlocks = mIndex.size();
+		std::memcpy(trailer.magic, BinaryLog::INDEX_MAGIC,
+				sizeof(trailer.magic));
+
+		if (!mIndex.empty())
+		{
+			std::fwrite(mIndex.data(), sizeof(BinaryLog::IndexEntry),
+					mIndex.size(), mFile);
+		}
+		std::fwrite(&trailer, sizeof(trailer), 1, mFile);
+		std::fclose(mFile);
+		mFile = nullptr;
+	}
+
+private:
+	void resetBlock()
+	{
+		std::memset(&mHeader, 0, sizeof(mHeader));
+		mHeader.magic = BinaryLog::BLOCK_MAGIC;
+		mRecords.clear();
+		mDictionary.clear();
+		mNumRecords = 0;
+		mLastWallTime = 0;
+		mLastSimTime = 0;
+	}
+
+	// Template (mString) and args (mArgs) of a message
+	void splitMessage(boost::string_view message)
+	{
+		mString.clear();
+		mArgs.clear();
+		mNumArgs = 0;
+
+		// Messages with the placeholder character are stored unchanged
+		if (message.find(BinaryLog::ARG_PLACEHOLDER)
+				!= boost::string_view::npos)
+		{
+			mString.assign(message.data(), message.size());
+			return;
+		}
+
+		size_t pos = 0;
+		while (pos < message.size())
+		{
+			if (!isWordCharacter(message[pos]))
+			{
+				mString.push_back(message[pos++]);
+				continue;
+			}
+
+			size_t end = pos;
+			bool hasDigit = false;
+			while (end < message.size() && isWordCharacter(message[end]))
+			{
+				hasDigit = hasDigit || BinaryLog::isDigit(message[end]);
+				end++;
+			}
+
+			// Words are part of the template
+			boost::string_view token = message.substr(pos, end - pos);
+			if (hasDigit)
+			{
+				appendArg(token);
+				mString.push_back(BinaryLog::ARG_PLACEHOLDER);
+			} else
+			{
+				mString.append(token.data(), token.size());
+			}
+			pos = end;
+		}
+	}
+
+	// Integers are stored as values if they can be restored exactly
+	void appendArg(boost::string_view token)
+	{
+		bool isInteger = token.size() <= 18
+				&& (token[0] != '0' || token.size() == 1);
+		uint64_t value = 0;
+		for (size_t i = 0; isInteger && i < token.size(); i++)
+		{
+			if (!BinaryLog::isDigit(token[i]))
+			{
+				isInteger = false;
+				break;
+			}
+			value = value * 10 + uint64_t(token[i] - '0');
+		}
+
+		if (isInteger)
+		{
+			BinaryLog::appendVarint(mArgs, value << 1);
+		} else
+		{
+			BinaryLog::appendVarint(mArgs, (uint64_t(token.size()) << 1) | 1);
+			mArgs.append(token.data(), token.size());
+		}
+		mNumArgs++;
+	}
+
+	static bool isWordCharacter(char c)
+	{
+		return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z')
+				|| (c >= 'A' && c <= 'Z') || c == '_' || c == '.';
+	}
+
+	uint64_t intern(const std::string& text)
+	{
+		auto found = mStrings.find(text);
+		if (found != mStrings.end())
+		{
+			return found->second;
+		}
+
+		uint64_t id = mStrings.size() + 1;
+		mStrings.emplace(text, id);
+		BinaryLog::appendVarint(mDictionary, id);
+		BinaryLog::appendVarint(mDictionary, text.size());
+		mDictionary.append(text);
+		return id;
+	}
+
+	std::FILE* mFile;
+	size_t mBlockSize;
+	BinaryLog::Compression mCompression;
+
+	std::set<std::string> mSources;
+	std::unordered_map<std::string, uint64_t> mStrings;
+
+	// Current block
+	BinaryLog::BlockHeader mHeader;
+	std::string mDictionary;
+	std::string mRecords;
+	std::string mCompressed;
+	uint32_t mNumRecords;
+	uint64_t mLastWallTime;
+	uint64_t mLastSimTime;
+
+	std::vector<BinaryLog::IndexEntry> mIndex;
+
+	// Reused buffers
+	std::string mString;
+	std::string mArgs;
+	uint64_t mNumArgs;
+};
+
+struct BinaryLogRecord
+{
+	uint64_t wallTime = 0; // us since epoch
+	uint64_t simTime = 0;
+	LogSeverity severity = LogSeverity::INFO;
+	std::string source;
+	std::string message; // including the source
+};
+
+struct BinaryLogFilter
+{
+	std::set<std::string> sources; // empty: all
+	LogSeverity minSeverity = LogSeverity::TRACE;
+	uint64_t fromSimTime = 0;
+	uint64_t toSimTime = UINT64_MAX;
+};
+
+class BinaryLogReader
+{
+public:
+	BinaryLogReader() :
+			mFile(nullptr), mFileSize(0), mHasIndex(false), mCorrupt(false), mNextOffset(
+					sizeof(BinaryLog::FileHeader)), mNextBlock(0), mEndBlock(
+					0), mSeverityMask(0xff), mPos(nullptr), mEnd(nullptr), mRemaining(
+					0), mWallTime(0), mSimTime(0), mSourceID(0), mTemplateID(
+					0), mBlocksRead(0), mBlocksSkipped(0)
+	{
+		mStrings.push_back("");
+	}
+
+	~BinaryLogReader()
+	{
+		if (mFile != nullptr)
+		{
+			std::fclose(mFile);
+		}
+	}
+
+	BinaryLogReader(const BinaryLogReader&) = delete;
+	BinaryLogReader& operator=(const BinaryLogReader&) = delete;
+
+	bool open(const std::string& filePath)
+	{
+		mFile = std::fopen(filePath.c_str(), "rb");
+		if (mFile == nullptr)
+		{
+			return false;
+		}
+
+		BinaryLog::FileHeader header;
+		if (std::fread(&header, sizeof(header), 1, mFile) != 1
+				|| std::memcmp(header.magic, BinaryLog::FILE_MAGIC,
+						sizeof(header.magic)) != 0
+				|| header.version != BinaryLog::FORMAT_VERSION)
+		{
+			return false;
+		}
+
+		std::fseek(mFile, 0, SEEK_END);
+		mFileSize = uint64_t(std::ftell(mFile));
+
+		readIndex();
+		return true;
+	}
+
+	// The index is missing if the writer was not closed (e.g. crash),
+	// then the block headers are read one after another
+	bool hasIndex() const
+	{
+		return mHasIndex;
+	}
+
+	// False if a corrupt block was found
+	bool isComplete() const
+	{
+		return !mCorrupt;
+	}
+
+	uint64_t getBlocksRead() const
+	{
+		return mBlocksRead;
+	}
+
+	uint64_t getBlocksSkipped() const
+	{
+		return mBlocksSkipped;
+	}
+
+	// Has to be set before the first record is read
+	void setFilter(const BinaryLogFilter& filter)
+	{
+		mFilter = filter;
+		mSeverityMask = 0;
+		for (int severity = int(filter.minSeverity);
+				severity <= int(LogSeverity::FATAL); severity++)
+		{
+			mSeverityMask |= BinaryLog::severityBit(LogSeverity(severity));
+		}
+
+		if (mHasIndex)
+		{
+			seekBlocks();
+		}
+	}
+
+	// Next matching record (valid until the next call) or nullptr at the end
+	const BinaryLogRecord* next()
+	{
+		while (true)
+		{
+			if (mRemaining == 0)
+			{
+				if (!readNextBlock())
+				{
+					return nullptr;
+				}
+				continue;
+			}
+
+			if (!decodeRecord())
+			{
+				mCorrupt = true;
+				return nullptr;
+			}
+
+			if (mRecord.severity >= mFilter.minSeverity
+					&& mRecord.simTime >= mFilter.fromSimTime
+					&& mRecord.simTime <= mFilter.toSimTime
+					&& (mFilter.sources.empty()
+							|| mFilter.sources.count(mStrings[mSourceID])
+									!= 0))
+			{
+				mRecord.source = mStrings[mSourceID];
+				mRecord.message = mRecord.source;
+				restoreMessage(mStrings[mTemplateID]);
+				return &mRecord;
+			}
+		}
+	}
+
+	// Calls handler(const BinaryLogRecord&) for each matching record
+	template<typename Handler>
+	bool read(const BinaryLogFilter& filter, Handler handler)
+	{
+		setFilter(filter);
+		while (const BinaryLogRecord* record = next())
+		{
+			handler(*record);
+		}
+		return isComplete();
+	}
+
+private:
+	void readIndex()
+	{
+		BinaryLog::Trailer trailer;
+		if (std::fseek(mFile, -long(sizeof(trailer)), SEEK_END) != 0
+				|| std::fread(&trailer, sizeof(trailer), 1, mFile) != 1
+				|| std::memcmp(trailer.magic, BinaryLog::INDEX_MAGIC,
+						sizeof(trailer.magic)) != 0)
+		{
+			return;
+		}
+
+		mIndex.resize(trailer.numBlocks);
+		if (std::fseek(mFile, long(trailer.indexOffset), SEEK_SET) != 0
+				|| (trailer.numBlocks > 0
+						&& std::fread(mIndex.data(),
+								sizeof(BinaryLog::IndexEntry), mIndex.size(),
+								mFile) != mIndex.size()))
+		{
+			mIndex.clear();
+			return;
+		}
+		mHasIndex = true;
+		mEndBlock = mIndex.size();
+	}
+
+	// Blocks of the sim time range of the filter (the index entries of the
+	// blocks are not ordered by their sim times)
+	void seekBlocks()
+	{
+		size_t first = mIndex.size();
+		size_t last = 0;
+		for (size_t block = 0; block < mIndex.size(); block++)
+		{
+			auto& entry = mIndex[block];
+			if (entry.maxSimTime >= mFilter.fromSimTime
+					&& entry.minSimTime <= mFilter.toSimTime
+					&& (entry.severityMask & mSeverityMask) != 0)
+			{
+				first = std::min(first, block);
+				last = block;
+			}
+		}
+
+		if (first == mIndex.size())
+		{
+			mBlocksSkipped += mIndex.size();
+			mNextBlock = mEndBlock = mIndex.size();
+			return;
+		}
+
+		// The strings of the first block are defined since the last reset
+		size_t begin = first;
+		while (begin > 0
+				&& (mIndex[begin].flags & BinaryLog::DICTIONARY_RESET) == 0)
+		{
+			begin--;
+		}
+
+		mBlocksSkipped += begin + (mIndex.size() - last - 1);
+		mNextBlock = begin;
+		mEndBlock = last + 1;
+	}
+
+	// Reads the next block which may contain matching records
+	bool readNextBlock()
+	{
+		while (!mCorrupt)
+		{
+			uint64_t offset = mNextOffset;
+			if (mHasIndex)
+			{
+				if (mNextBlock >= mEndBlock)
+				{
+					return false;
+				}
+				offset = mIndex[mNextBlock++].offset;
+			}
+
+			BinaryLog::BlockHeader header;
+			if (std::fseek(mFile, long(offset), SEEK_SET) != 0
+					|| std::fread(&header, sizeof(header), 1, mFile) != 1
+					|| header.magic != BinaryLog::BLOCK_MAGIC)
+			{
+				// End of the blocks (or truncated block)
+				return false;
+			}
+
+			// The last block of a file which was not closed may be incomplete
+			if (offset + sizeof(header) + header.dictionarySize
+					+ header.storedSize > mFileSize)
+			{
+				return false;
+			}
+			mNextOffset = offset + sizeof(header) + header.dictionarySize
+					+ header.storedSize;
+
+			// The dictionary is always needed for the following blocks
+			if ((header.flags & BinaryLog::DICTIONARY_RESET) != 0)
+			{
+				mStrings.resize(1);
+				mIds.clear();
+			}
+			mBuffer.resize(header.dictionarySize);
+			if ((header.dictionarySize > 0
+					&& std::fread(&mBuffer[0], 1, mBuffer.size(), mFile)
+							!= mBuffer.size()) || !readDictionary())
+			{
+				mCorrupt = true;
+				return false;
+			}
+
+			if (!matches(header))
+			{
+				mBlocksSkipped++;
+				continue;
+			}
+
+			mBlocksRead++;
+			if (!readRecordSection(header))
+			{
+				mCorrupt = true;
+				return false;
+			}
+			return true;
+		}
+		return false;
+	}
+
+	bool readDictionary()
+	{
+		const char* pos = mBuffer.data();
+		const char* end = pos + mBuffer.size();
+
+		while (pos < end)
+		{
+			uint64_t id;
+			uint64_t size;
+			if (!BinaryLog::readVarint(pos, end, id)
+					|| !BinaryLog::readVarint(pos, end, size)
+					|| size > uint64_t(end - pos) || id != mStrings.size()
+					|| id > BinaryLog::MAX_DICTIONARY_STRINGS)
+			{
+				return false;
+			}
+			mStrings.emplace_back(pos, size);
+			mIds[mStrings.back()] = id;
+			pos += size;
+		}
+		return true;
+	}
+
+	bool matches(const BinaryLog::BlockHeader& header)
+	{
+		if (header.maxSimTime < mFilter.fromSimTime
+				|| header.minSimTime > mFilter.toSimTime
+				|| (header.severityMask & mSeverityMask) == 0)
+		{
+			return false;
+		}
+
+		if (mFilter.sources.empty())
+		{
+			return true;
+		}
+
+		uint64_t sourceMask = 0;
+		for (auto& source : mFilter.sources)
+		{
+			auto found = mIds.find(source);
+			if (found != mIds.end())
+			{
+				sourceMask |= BinaryLog::sourceBit(found->second);
+			}
+		}
+		return (header.sourceMask & sourceMask) != 0;
+	}
+
+	bool readRecordSection(const BinaryLog::BlockHeader& header)
+	{
+		mBuffer.resize(header.storedSize);
+		if (header.storedSize > 0
+				&& std::fread(&mBuffer[0], 1, mBuffer.size(), mFile)
+						!= mBuffer.size())
+		{
+			return false;
+		}
+
+		const std::string* records = &mBuffer;
+		if (header.compression == BinaryLog::ZLIB_COMPRESSION)
+		{
+			uLongf size = header.rawSize;
+			mUncompressed.resize(size);
+			if (uncompress(reinterpret_cast<Bytef*>(&mUncompressed[0]), &size,
+					reinterpret_cast<const Bytef*>(mBuffer.data()),
+					uLong(mBuffer.size())) != Z_OK || size != header.rawSize)
+			{
+				return false;
+			}
+			records = &mUncompressed;
+		}
+
+		// The first record of a block is stored relative to zero
+		mPos = records->data();
+		mEnd = mPos + records->size();
+		mRemaining = header.numRecords;
+		mWallTime = 0;
+		mSimTime = 0;
+		return true;
+	}
+
+	// The message is restored only for matching records
+	bool decodeRecord()
+	{
+		uint64_t wallDelta, simDelta, numArgs;
+		if (!BinaryLog::readVarint(mPos, mEnd, wallDelta)
+				|| !BinaryLog::readVarint(mPos, mEnd, simDelta) || mPos >= mEnd)
+		{
+			return false;
+		}
+		LogSeverity severity = LogSeverity(*mPos++);
+		if (!BinaryLog::readVarint(mPos, mEnd, mSourceID)
+				|| !BinaryLog::readVarint(mPos, mEnd, mTemplateID)
+				|| !BinaryLog::readVarint(mPos, mEnd, numArgs)
+				|| mSourceID >= mStrings.size()
+				|| mTemplateID >= mStrings.size())
+		{
+			return false;
+		}
+
+		// Every arg has at least one byte
+		if (numArgs > uint64_t(mEnd - mPos))
+		{
+			return false;
+		}
+
+		mArgs.resize(numArgs);
+		for (auto& arg : mArgs)
+		{
+			uint64_t value;
+			if (!BinaryLog::readVarint(mPos, mEnd, value))
+			{
+				return false;
+			}
+
+			arg.text.clear();
+			arg.value = value >> 1;
+			if ((value & 1) != 0)
+			{
+				if (arg.value > uint64_t(mEnd - mPos))
+				{
+					return false;
+				}
+				arg.text = boost::string_view(mPos, arg.value);
+				mPos += arg.value;
+			}
+		}
+
+		mRemaining--;
+		mWallTime += wallDelta;
+		mSimTime += uint64_t(BinaryLog::unzigzag(simDelta));
+
+		mRecord.wallTime = mWallTime;
+		mRecord.simTime = mSimTime;
+		mRecord.severity = severity;
+		return true;
+	}
+
+	void restoreMessage(const std::string& messageTemplate)
+	{
+		if (mArgs.empty())
+		{
+			mRecord.message.append(messageTemplate);
+			return;
+		}
+
+		size_t arg = 0;
+		for (char c : messageTemplate)
+		{
+			if (c == BinaryLog::ARG_PLACEHOLDER && arg < mArgs.size())
+			{
+				if (mArgs[arg].text.empty())
+				{
+					mRecord.message.append(std::to_string(mArgs[arg].value));
+				} else
+				{
+					mRecord.message.append(mArgs[arg].text.data(),
+							mArgs[arg].text.size());
+				}
+				arg++;
+			} else
+			{
+				mRecord.message.push_back(c);
+			}
+		}
+	}
+
+	std::FILE* mFile;
+	uint64_t mFileSize;
+	bool mHasIndex;
+	bool mCorrupt;
+	std::vector<BinaryLog::IndexEntry> mIndex;
+	std::vector<std::string> mStrings;
+	std::unordered_map<std::string, uint64_t> mIds;
+
+	// Position of the next block (without index: offset, else index entry)
+	uint64_t mNextOffset;
+	size_t mNextBlock;
+	size_t mEndBlock;
+
+	BinaryLogFilter mFilter;
+	uint8_t mSeverityMask;
+
+	// Records of the current block
+	const char* mPos;
+	const char* mEnd;
+	uint32_t mRemaining;
+	uint64_t mWallTime;
+	uint64_t mSimTime;
+	uint64_t mSourceID;
+	uint64_t mTemplateID;
+
+	uint64_t mBlocksRead;
+	uint64_t mBlocksSkipped;
+
+	// Integer (empty text) or token of the record section
+	struct Arg
+	{
+		uint64_t value;
+		boost::string_view text;
+	};
+
+	// Reused buffers
+	std::string mBuffer;
+	std::string mUncompressed;
+	std::vector<Arg> mArgs;
+	BinaryLogRecord mRecord;
+};
+
+#endif /* LOGGING_BINARYLOGFORMAT_H_ */
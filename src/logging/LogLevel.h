@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef LOGGING_LOGLEVEL_H_
+#define LOGGING_LOGLEVEL_H_
+
+#include <string>
+#include <boost/utility/string_view.hpp>
+
+#include "logging/LogRecord.h"
+#include "utilities/MessageBuffer.h"
+
+// Severity threshold of the log messages of a model.
+// Messages below the threshold are neither composed nor published (the
+// models log with publishLog, which checks isEnabled()).
+//
+// Settings (hosts-config attribute logLevel, payload of SetLogLevel):
+//   LEVEL                       all models
+//   MODEL=LEVEL[,MODEL=LEVEL]   only the listed models ("*": all models)
+class LogLevel
+{
+public:
+	LogLevel(LogSeverity threshold = LogSeverity::TRACE) :
+			mThreshold(threshold)
+	{
+	}
+
+	bool isEnabled(LogSeverity severity) const
+	{
+		return severity >= mThreshold;
+	}
+
+	LogSeverity getThreshold() const
+	{
+		return mThreshold;
+	}
+
+	void setThreshold(LogSeverity threshold)
+	{
+		mThreshold = threshold;
+	}
+
+	// Returns true if the setting changed the threshold of the model
+	bool apply(const std::string& modelName, boost::string_view setting)
+	{
+		bool changed = false;
+
+		while (!setting.empty())
+		{
+			size_t end = setting.find(',');
+			boost::string_view item = setting.substr(0, end);
+			setting =
+					(end == boost::string_view::npos) ?
+							boost::string_view() : setting.substr(end + 1);
+
+			boost::string_view level = item;
+			size_t separator = item.find('=');
+			if (separator != boost::string_view::npos)
+			{
+				boost::string_view name = item.substr(0, separator);
+				level = item.substr(separator + 1);
+
+				if (name != "*" && name != modelName)
+				{
+					continue;
+				}
+			}
+
+			LogSeverity threshold;
+			if (parseSeverity(level, threshold) && threshold != mThreshold)
+			{
+				mThreshold = threshold;
+				changed = true;
+			}
+		}
+
+		return changed;
+	}
+
+private:
+	LogSeverity mThreshold;
+};
+
+// Event of the log messages of the severity (received by the logger)
+inline const char* getLogEventName(LogSeverity severity)
+{
+	switch (severity)
+	{
+	case LogSeverity::TRACE:
+		return "LogTrace";
+	case LogSeverity::DEBUG:
+		return "LogDebug";
+	case LogSeverity::INFO:
+		return "LogInfo";
+	case LogSeverity::WARNING:
+		return "LogWarning";
+	case LogSeverity::ERROR:
+		return "LogError";
+	case LogSeverity::FATAL:
+		return "LogFatal";
+	}
+	return "LogInfo";
+}
+
+// Publishes a log message of a model. The message is composed from its
+// parts in the reused buffer, only if the severity is enabled.
+template<typename Publisher, typename ... Parts>
+void publishLog(Publisher& publisher, const LogLevel& logLevel,
+		MessageBuffer& message, LogSeverity severity, uint64_t simTime,
+		const Parts&... parts)
+{
+	if (logLevel.isEnabled(severity))
+	{
+		publisher.publishEvent(getLogEventName(severity), simTime,
+				message.clear().compose(parts...).str());
+	}
+}
+
+#endif /* LOGGING_LOGLEVEL_H_ */
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef LOGGING_LOGRECORD_H_
+#define LOGGING_LOGRECORD_H_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <boost/utility/string_view.hpp>
+
+// Same levels (and names) as boost::log::trivial::severity_level
+enum class LogSeverity : uint8_t
+{
+	TRACE,
+	DEBUG,
+	INFO,
+	WARNING,
+	ERROR,
+	FATAL
+};
+
+inline const char* toString(LogSeverity severity)
+{
+	switch (severity)
+	{
+	case LogSeverity::TRACE:
+		return "trace";
+	case LogSeverity::DEBUG:
+		return "debug";
+	case LogSeverity::INFO:
+		return "info";
+	case LogSeverity::WARNING:
+		return "warning";
+	case LogSeverity::ERROR:
+		return "error";
+	case LogSeverity::FATAL:
+		return "fatal";
+	}
+	return "unknown";
+}
+
+inline bool parseSeverity(boost::string_view name, LogSeverity& severity)
+{
+	for (int level = int(LogSeverity::TRACE); level <= int(LogSeverity::FATAL);
+			level++)
+	{
+		if (name == toString(LogSeverity(level)))
+		{
+			severity = LogSeverity(level);
+			return true;
+		}
+	}
+	return false;
+}
+
+struct LogRecord
+{
+	std::chrono::system_clock::time_point wallTime;
+	uint64_t simTime = 0;
+	LogSeverity severity = LogSeverity::INFO;
+	std::string message;
+};
+
+#endif /* LOGGING_LOGRECORD_H_ */
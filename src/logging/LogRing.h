@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef LOGGING_LOGRING_H_
+#define LOGGING_LOGRING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Lock-free ring buffer for exactly one producer and one consumer thread.
+// The slots are allocated once and reused, so the producer can fill a
+// slot in place (claim/publish) and the consumer can read it in place
+// (front/pop) without copying or allocating.
+template<typename T>
+class LogRing
+{
+public:
+	// The capacity is rounded up to a power of two
+	explicit LogRing(size_t capacity)
+	{
+		size_t size = 1;
+		while (size < capacity)
+		{
+			size <<= 1;
+		}
+		mSlots.resize(size);
+		mMask = size - 1;
+	}
+
+	LogRing(const LogRing&) = delete;
+	LogRing& operator=(const LogRing&) = delete;
+
+	// Producer: returns the next free slot or nullptr if the ring is full
+	T* claim()
+	{
+		size_t head = mHead.load(std::memory_order_relaxed);
+		if (head - mCachedTail > mMask)
+		{
+			mCachedTail = mTail.load(std::memory_order_acquire);
+			if (head - mCachedTail > mMask)
+			{
+				return nullptr;
+			}
+		}
+		return &mSlots[head & mMask];
+	}
+
+	// Producer: makes the claimed slot visible to the consumer
+	void publish()
+	{
+		mHead.store(mHead.load(std::memory_order_relaxed) + 1,
+				std::memory_order_release);
+	}
+
+	// Consumer: returns the oldest slot or nullptr if the ring is empty
+	T* front()
+	{
+		size_t tail = mTail.load(std::memory_order_relaxed);
+		if (tail == mCachedHead)
+		{
+			mCachedHead = mHead.load(std::memory_order_acquire);
+			if (tail == mCachedHead)
+			{
+				return nullptr;
+			}
+		}
+		return &mSlots[tail & mMask];
+	}
+
+	// Consumer: releases the slot returned by front()
+	void pop()
+	{
+		mTail.store(mTail.load(std::memory_order_relaxed) + 1,
+				std::memory_order_release);
+	}
+
+	// Approximate number of used slots (may be read by any thread)
+	size_t size() const
+	{
+		return mHead.load(std::memory_order_acquire)
+				- mTail.load(std::memory_order_acquire);
+	}
+
+	bool empty() const
+	{
+		return size() == 0;
+	}
+
+	size_t capacity() const
+	{
+		return mMask + 1;
+	}
+
+	// Access to all slots, e.g. to reserve buffers before the first use
+	std::vector<T>& getSlots()
+	{
+		return mSlots;
+	}
+
+private:
+	std::vector<T> mSlots;
+	size_t mMask;
+
+	// Head and tail are written by different threads, hence they are kept
+	// on separate cache lines together with the cached copy of the other
+	alignas(64) std::atomic<size_t> mHead
+	{ 0 };
+	size_t mCachedTail = 0;
+
+	alignas(64) std::atomic<size_t> mTail
+	{ 0 };
+	size_t mCachedHead = 0;
+};
+
+#endif /* LOGGING_LOGRING_H_ */
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+// Per thread, the handler thread samples its own counters (constant
+// initialization, hence usable before the construction of the statics)
+thread_local uint64_t allocations = 0;
+thread_local uint64_t deallocations = 0;
+thread_local uint64_t allocatedBytes = 0;
+}
+
+namespace AllocationCounter
+{
+bool isEnabled()
+{
+#ifdef FRASER_COUNT_ALLOCATIONS
+	return true;
+#else
+	return false;
+#endif
+}
+
+uint64_t getAllocations()
+{
+	return allocations;
+}
+
+uint64_t getDeallocations()
+{
+	return deallocations;
+}
+
+uint64_t getAllocatedBytes()
+{
+	return allocatedBytes;
+}
+}
+
+#ifdef FRASER_COUNT_ALLOCATIONS
+
+namespace
+{
+void* countedAllocation(std::size_t size)
+{
+	allocations++;
+	allocatedBytes += size;
+
+	return std::malloc(size == 0 ? 1 : size);
+}
+
+void countedDeallocation(void* ptr)
+{
+	if (ptr != nullptr)
+	{
+		deallocations++;
+		std::free(ptr);
+	}
+}
+}
+
+void* operator new(std::size_t size)
+{
+	void* ptr = countedAllocation(size);
+	if (ptr == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+	void* ptr = countedAllocation(size);
+	if (ptr == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return countedAllocation(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return countedAllocation(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	countedDeallocation(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	countedDeallocation(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	countedDeallocation(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+	countedDeallocation(ptr);
+}
+
+#endif /* FRASER_COUNT_ALLOCATIONS */
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef METRICS_ALLOCATIONCOUNTER_H_
+#define METRICS_ALLOCATIONCOUNTER_H_
+
+#include <cstdint>
+#include <string>
+
+// Counts the heap allocations of the calling thread (no shared counters).
+// The global operator new/delete are only replaced in AllocationCounter.cpp
+// if the model is built with FRASER_COUNT_ALLOCATIONS (DEFINES of its
+// Makefile), otherwise all counters are 0.
+namespace AllocationCounter
+{
+bool isEnabled();
+uint64_t getAllocations();
+uint64_t getDeallocations();
+uint64_t getAllocatedBytes();
+}
+
+// Measures the heap allocations of the event handling path.
+// The first cycles are not taken into account (warm-up phase),
+// because buffers and tables are allowed to grow during this phase.
+class AllocationMonitor
+{
+public:
+	AllocationMonitor(uint64_t warmUpCycles = 10) :
+			mWarmUpCycles(warmUpCycles)
+	{
+	}
+
+	void beginCycle()
+	{
+		mAllocationsAtBegin = AllocationCounter::getAllocations();
+	}
+
+	void endCycle()
+	{
+		uint64_t allocations = AllocationCounter::getAllocations()
+				- mAllocationsAtBegin;
+		mCycles++;
+
+		if (mCycles > mWarmUpCycles)
+		{
+			mLastCycleAllocations = allocations;
+			mSteadyStateCycles++;
+			mSteadyStateAllocations += allocations;
+
+			if (allocations > mMaxAllocationsPerCycle)
+			{
+				mMaxAllocationsPerCycle = allocations;
+			}
+		}
+	}
+
+	uint64_t getSteadyStateCycles() const
+	{
+		return mSteadyStateCycles;
+	}
+
+	uint64_t getSteadyStateAllocations() const
+	{
+		return mSteadyStateAllocations;
+	}
+
+	uint64_t getMaxAllocationsPerCycle() const
+	{
+		return mMaxAllocationsPerCycle;
+	}
+
+	// Allocations of the latest steady-state cycle
+	uint64_t getLastCycleAllocations() const
+	{
+		return mLastCycleAllocations;
+	}
+
+	std::string getSummary() const
+	{
+		if (!AllocationCounter::isEnabled())
+		{
+			return "heap allocations not counted (FRASER_COUNT_ALLOCATIONS)";
+		}
+
+		return std::to_string(mSteadyStateAllocations)
+				+ " heap allocations in " + std::to_string(mSteadyStateCycles)
+				+ " steady-state cycles (max. "
+				+ std::to_string(mMaxAllocationsPerCycle) + " per cycle)";
+	}
+
+private:
+	uint64_t mWarmUpCycles;
+	uint64_t mAllocationsAtBegin = 0;
+	uint64_t mCycles = 0;
+	uint64_t mSteadyStateCycles = 0;
+	uint64_t mSteadyStateAllocations = 0;
+	uint64_t mMaxAllocationsPerCycle = 0;
+	uint64_t mLastCycleAllocations = 0;
+};
+
+// Ends the cycle with the scope, e.g. of an event handler with early returns
+class ScopedAllocationCycle
+{
+public:
+	ScopedAllocationCycle(AllocationMonitor& monitor) :
+			mMonitor(monitor)
+	{
+		mMonitor.beginCycle();
+	}
+
+	~ScopedAllocationCycle()
+	{
+		mMonitor.endCycle();
+	}
+
+	ScopedAllocationCycle(const ScopedAllocationCycle&) = delete;
+	ScopedAllocationCycle& operator=(const ScopedAllocationCycle&) = delete;
+
+private:
+	AllocationMonitor& mMonitor;
+};
+
+#endif /* METRICS_ALLOCATIONCOUNTER_H_ */
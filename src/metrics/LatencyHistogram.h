@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef METRICS_LATENCYHISTOGRAM_H_
+#define METRICS_LATENCYHISTOGRAM_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Latency histogram in the style of HdrHistogram: each power-of-two range
+// (in nanoseconds) is divided into 16 linear sub-buckets, hence the values
+// are accurate to 1/16 (6.25 %) from 1 ns up to 2^40 ns (about 18 min).
+// Recording is lock-free and can be done by several threads at once.
+class LatencyHistogram
+{
+public:
+	static constexpr unsigned SUB_BUCKET_BITS = 5;
+	static constexpr uint64_t SUB_BUCKET_COUNT = uint64_t(1) << SUB_BUCKET_BITS;
+	static constexpr uint64_t SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;
+	static constexpr unsigned MAX_BITS = 40;
+	static constexpr size_t NUM_BUCKETS = (MAX_BITS - SUB_BUCKET_BITS + 2)
+			* SUB_BUCKET_HALF;
+
+	LatencyHistogram()
+	{
+		for (auto& bucket : mBuckets)
+		{
+			bucket.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	void record(uint64_t nanoseconds)
+	{
+		mCount.fetch_add(1, std::memory_order_relaxed);
+		mSum.fetch_add(nanoseconds, std::memory_order_relaxed);
+		mBuckets[getBucket(nanoseconds)].fetch_add(1,
+				std::memory_order_relaxed);
+
+		uint64_t max = mMax.load(std::memory_order_relaxed);
+		while (nanoseconds > max
+				&& !mMax.compare_exchange_weak(max, nanoseconds,
+						std::memory_order_relaxed))
+		{
+		}
+	}
+
+	uint64_t getCount() const
+	{
+		return mCount.load(std::memory_order_relaxed);
+	}
+
+	uint64_t getSum() const
+	{
+		return mSum.load(std::memory_order_relaxed);
+	}
+
+	uint64_t getMean() const
+	{
+		uint64_t count = getCount();
+		return count > 0 ? getSum() / count : 0;
+	}
+
+	uint64_t getMax() const
+	{
+		return mMax.load(std::memory_order_relaxed);
+	}
+
+	uint64_t getBucketCount(size_t bucket) const
+	{
+		return mBuckets[bucket].load(std::memory_order_relaxed);
+	}
+
+	// Upper bound of the bucket which contains the percentile (0-100)
+	uint64_t getPercentile(double percentile) const
+	{
+		uint64_t count = getCount();
+		if (count == 0)
+		{
+			return 0;
+		}
+
+		uint64_t rank = uint64_t(percentile / 100.0 * double(count));
+		uint64_t cumulated = 0;
+		for (size_t bucket = 0; bucket < NUM_BUCKETS; bucket++)
+		{
+			cumulated += getBucketCount(bucket);
+			if (cumulated > rank)
+			{
+				return std::min(getUpperBound(bucket), getMax());
+			}
+		}
+		return getMax();
+	}
+
+	// Values < 32 ns have their own bucket, above each bucket covers
+	// 2^(shift) values: index = shift * 16 + (value >> shift)
+	static size_t getBucket(uint64_t nanoseconds)
+	{
+		if (nanoseconds < SUB_BUCKET_COUNT)
+		{
+			return size_t(nanoseconds);
+		}
+
+		uint64_t value = std::min(nanoseconds,
+				(uint64_t(1) << MAX_BITS) - 1);
+		unsigned msb = 63 - unsigned(__builtin_clzll(value));
+		unsigned shift = msb - (SUB_BUCKET_BITS - 1);
+		return size_t(shift * SUB_BUCKET_HALF + (value >> shift));
+	}
+
+	// Largest value of the bucket
+	static uint64_t getUpperBound(size_t bucket)
+	{
+		if (bucket < SUB_BUCKET_COUNT)
+		{
+			return bucket;
+		}
+
+		unsigned shift = unsigned(bucket / SUB_BUCKET_HALF) - 1;
+		uint64_t subBucket = bucket % SUB_BUCKET_HALF + SUB_BUCKET_HALF;
+		return ((subBucket + 1) << shift) - 1;
+	}
+
+private:
+	std::atomic<uint64_t> mCount
+	{ 0 };
+	std::atomic<uint64_t> mSum
+	{ 0 };
+	std::atomic<uint64_t> mMax
+	{ 0 };
+	std::array<std::atomic<uint64_t>, NUM_BUCKETS> mBuckets;
+};
+
+// Records the time until the end of the scope (e.g. of an event handler)
+class ScopedLatency
+{
+public:
+	ScopedLatency(LatencyHistogram& histogram) :
+			mHistogram(histogram), mStart(std::chrono::steady_clock::now())
+	{
+	}
+
+	~ScopedLatency()
+	{
+		mHistogram.record(
+				uint64_t(
+						std::chrono::duration_cast<std::chrono::nanoseconds>(
+								std::chrono::steady_clock::now() - mStart).count()));
+	}
+
+	ScopedLatency(const ScopedLatency&) = delete;
+	ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+	LatencyHistogram& mHistogram;
+	std::chrono::steady_clock::time_point mStart;
+};
+
+#endif /* METRICS_LATENCYHISTOGRAM_H_ */
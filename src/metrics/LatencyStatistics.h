@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef METRICS_LATENCYSTATISTICS_H_
+#define METRICS_LATENCYSTATISTICS_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Latency statistics, which can be recorded by several threads at once.
+// Percentiles are estimated from power-of-two buckets (in nanoseconds),
+// hence they are accurate to a factor of two.
+class LatencyStatistics
+{
+public:
+	LatencyStatistics()
+	{
+		for (auto& bucket : mBuckets)
+		{
+			bucket.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	void record(uint64_t nanoseconds)
+	{
+		mCount.fetch_add(1, std::memory_order_relaxed);
+		mTotal.fetch_add(nanoseconds, std::memory_order_relaxed);
+		mBuckets[getBucket(nanoseconds)].fetch_add(1,
+				std::memory_order_relaxed);
+
+		uint64_t max = mMax.load(std::memory_order_relaxed);
+		while (nanoseconds > max
+				&& !mMax.compare_exchange_weak(max, nanoseconds,
+						std::memory_order_relaxed))
+		{
+		}
+	}
+
+	uint64_t getCount() const
+	{
+		return mCount.load(std::memory_order_relaxed);
+	}
+
+	uint64_t getMean() const
+	{
+		uint64_t count = getCount();
+		if (count == 0)
+		{
+			return 0;
+		}
+		return mTotal.load(std::memory_order_relaxed) / count;
+	}
+
+	uint64_t getMax() const
+	{
+		return mMax.load(std::memory_order_relaxed);
+	}
+
+	// Upper bound of the bucket which contains the percentile (0-100)
+	uint64_t getPercentile(double percentile) const
+	{
+		uint64_t count = getCount();
+		if (count == 0)
+		{
+			return 0;
+		}
+
+		uint64_t rank = uint64_t(percentile / 100.0 * double(count));
+		uint64_t cumulated = 0;
+		for (size_t bucket = 0; bucket < NUM_BUCKETS; bucket++)
+		{
+			cumulated += mBuckets[bucket].load(std::memory_order_relaxed);
+			if (cumulated > rank)
+			{
+				return uint64_t(1) << bucket;
+			}
+		}
+		return getMax();
+	}
+
+	// Values in microseconds
+	std::string getSummary() const
+	{
+		return "requests=" + std::to_string(getCount()) + " mean_us="
+				+ std::to_string(getMean() / 1000) + " p50_us="
+				+ std::to_string(getPercentile(50) / 1000) + " p99_us="
+				+ std::to_string(getPercentile(99) / 1000) + " max_us="
+				+ std::to_string(getMax() / 1000);
+	}
+
+private:
+	static constexpr size_t NUM_BUCKETS = 64;
+
+	static size_t getBucket(uint64_t nanoseconds)
+	{
+		size_t bucket = 0;
+		while (bucket < NUM_BUCKETS - 1 && (uint64_t(1) << bucket) < nanoseconds)
+		{
+			bucket++;
+		}
+		return bucket;
+	}
+
+	std::atomic<uint64_t> mCount
+	{ 0 };
+	std::atomic<uint64_t> mTotal
+	{ 0 };
+	std::atomic<uint64_t> mMax
+	{ 0 };
+	std::array<std::atomic<uint64_t>, NUM_BUCKETS> mBuckets;
+};
+
+#endif /* METRICS_LATENCYSTATISTICS_H_ */
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef METRICS_METEREDPUBLISHER_H_
+#define METRICS_METEREDPUBLISHER_H_
+
+#include <string>
+#include <utility>
+#include <boost/utility/string_view.hpp>
+#include <zmq.hpp>
+
+#include "communication/Publisher.h"
+#include "metrics/ModelMetrics.h"
+#include "tracing/FlightRecorder.h"
+
+// Publisher which counts the published events and their payload bytes
+// (event name and string data) in the metrics of the model and records
+// them in the flight recorder (optional)
+class MeteredPublisher: public Publisher
+{
+public:
+	MeteredPublisher(zmq::context_t& ctx, ModelMetrics& metrics) :
+			Publisher(ctx), mMetrics(metrics), mFlightRecorder(nullptr)
+	{
+	}
+
+	void setFlightRecorder(FlightRecorder& recorder)
+	{
+		mFlightRecorder = &recorder;
+	}
+
+	// Other overloads of the publisher are not counted
+	using Publisher::publishEvent;
+
+	template<typename Name, typename ... Args>
+	decltype(auto) publishEvent(Name&& name, uint64_t timestamp,
+			Args&&... data)
+	{
+		boost::string_view eventName(name);
+		recordPublished(eventName, timestamp,
+				eventName.size() + getPayloadSize(data...));
+
+		return Publisher::publishEvent(std::forward<Name>(name), timestamp,
+				std::forward<Args>(data)...);
+	}
+
+protected:
+	void recordPublished(boost::string_view eventName, uint64_t timestamp,
+			size_t bytes)
+	{
+		mMetrics.recordPublished(eventName, bytes);
+		if (mFlightRecorder != nullptr)
+		{
+			mFlightRecorder->record(FlightRecorder::Kind::PUBLISHED, eventName,
+					timestamp, uint32_t(bytes));
+		}
+	}
+
+private:
+	static size_t getPayloadSize()
+	{
+		return 0;
+	}
+
+	static size_t getPayloadSize(const std::string& data)
+	{
+		return data.size();
+	}
+
+	static size_t getPayloadSize(const char* data)
+	{
+		return boost::string_view(data).size();
+	}
+
+	static size_t getPayloadSize(boost::string_view data)
+	{
+		return data.size();
+	}
+
+	// Other event data (e.g. flexbuffers) is not counted
+	template<typename Data>
+	static size_t getPayloadSize(const Data&)
+	{
+		return 0;
+	}
+
+	ModelMetrics& mMetrics;
+	FlightRecorder* mFlightRecorder;
+};
+
+#endif /* METRICS_METEREDPUBLISHER_H_ */
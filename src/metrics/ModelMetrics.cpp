@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include "ModelMetrics.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+// Upper bounds of the Prometheus histogram buckets in nanoseconds
+const uint64_t latencyBounds[] =
+{ 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000,
+		2500000, 5000000, 10000000, 25000000, 50000000, 100000000, 250000000,
+		500000000, 1000000000 };
+
+std::string escapeLabel(const std::string& value)
+{
+	std::string escaped;
+	for (char c : value)
+	{
+		if (c == '\\' || c == '"')
+		{
+			escaped.push_back('\\');
+		}
+		escaped.push_back(c == '\n' ? ' ' : c);
+	}
+	return escaped;
+}
+
+std::string toSeconds(uint64_t nanoseconds)
+{
+	char text[32];
+	std::snprintf(text, sizeof(text), "%g", double(nanoseconds) / 1e9);
+	return text;
+}
+
+void appendHeader(std::string& text, const char* name, const char* type,
+		const char* help)
+{
+	text.append("# HELP ").append(name).append(" ").append(help).append("\n");
+	text.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+}
+}
+
+ModelMetrics::ModelMetrics(std::string modelName) :
+		mModelName(modelName), mReportInterval(
+				std::chrono::steady_clock::duration::zero())
+{
+}
+
+ModelMetrics::EventMetrics& ModelMetrics::getEvent(
+		boost::string_view eventName)
+{
+	auto entry = std::lower_bound(mEvents.begin(), mEvents.end(), eventName,
+			[](const std::unique_ptr<EventMetrics>& event,
+					boost::string_view name)
+			{
+				return boost::string_view(event->name) < name;
+			});
+
+	if (entry != mEvents.end() && (*entry)->name == eventName)
+	{
+		return **entry;
+	}
+
+	// First occurrence of the event
+	entry = mEvents.emplace(entry, new EventMetrics(eventName));
+	return **entry;
+}
+
+void ModelMetrics::setReportInterval(uint32_t milliseconds)
+{
+	mReportInterval = std::chrono::milliseconds(milliseconds);
+	mNextReport = std::chrono::steady_clock::now() + mReportInterval;
+}
+
+bool ModelMetrics::isReportDue()
+{
+	if (mReportInterval == std::chrono::steady_clock::duration::zero())
+	{
+		return false;
+	}
+
+	auto now = std::chrono::steady_clock::now();
+	if (now < mNextReport)
+	{
+		return false;
+	}
+
+	mNextReport = now + mReportInterval;
+	return true;
+}
+
+std::string ModelMetrics::getSummary() const
+{
+	std::string summary;
+	for (auto& event : mEvents)
+	{
+		auto& latency = event->handlerLatency;
+		summary.append(mModelName).append(" event=").append(event->name);
+		summary.append(" rx=").append(std::to_string(event->received.get()));
+		summary.append(" rx_bytes=").append(
+				std::to_string(event->receivedBytes.get()));
+		summary.append(" tx=").append(std::to_string(event->published.get()));
+		summary.append(" tx_bytes=").append(
+				std::to_string(event->publishedBytes.get()));
+
+		if (latency.getCount() > 0)
+		{
+			summary.append(" mean_ns=").append(
+					std::to_string(latency.getMean()));
+			summary.append(" p50_ns=").append(
+					std::to_string(latency.getPercentile(50)));
+			summary.append(" p99_ns=").append(
+					std::to_string(latency.getPercentile(99)));
+			summary.append(" max_ns=").append(
+					std::to_string(latency.getMax()));
+		}
+		summary.append("\n");
+	}
+
+	for (auto gauge : mGauges)
+	{
+		summary.append(mModelName).append(" queue=").append(gauge->getName());
+		summary.append(" depth=").append(std::to_string(gauge->get()));
+		summary.append(" max=").append(std::to_string(gauge->getMax()));
+		summary.append("\n");
+	}
+
+	if (mAllocationMonitor != nullptr)
+	{
+		summary.append(mModelName).append(" allocations=").append(
+				std::to_string(mAllocationMonitor->getSteadyStateAllocations()));
+		summary.append(" cycles=").append(
+				std::to_string(mAllocationMonitor->getSteadyStateCycles()));
+		summary.append(" last=").append(
+				std::to_string(mAllocationMonitor->getLastCycleAllocations()));
+		summary.append(" max=").append(
+				std::to_string(mAllocationMonitor->getMaxAllocationsPerCycle()));
+		summary.append("\n");
+	}
+
+	if (!summary.empty())
+	{
+		summary.pop_back();
+	}
+	return summary;
+}
+
+std::string ModelMetrics::toPrometheus() const
+{
+	std::string model = "model=\"" + escapeLabel(mModelName) + "\"";
+	std::string text;
+
+	struct CounterFamily
+	{
+		const char* name;
+		const char* help;
+		const Counter EventMetrics::*counter;
+	};
+	const CounterFamily counters[] =
+	{
+	{ "fraser_events_received_total", "Number of received events",
+			&EventMetrics::received },
+	{ "fraser_event_received_bytes_total",
+			"Payload bytes (name and data) of the received events",
+			&EventMetrics::receivedBytes },
+	{ "fraser_events_published_total", "Number of published events",
+			&EventMetrics::published },
+	{ "fraser_event_published_bytes_total",
+			"Payload bytes (name and data) of the published events",
+			&EventMetrics::publishedBytes } };
+
+	for (auto& family : counters)
+	{
+		appendHeader(text, family.name, "counter", family.help);
+		for (auto& event : mEvents)
+		{
+			text.append(family.name).append("{").append(model).append(
+					",event=\"").append(escapeLabel(event->name)).append(
+					"\"} ").append(
+					std::to_string(((*event).*family.counter).get())).append(
+					"\n");
+		}
+	}
+
+	appendHeader(text, "fraser_handler_latency_seconds", "histogram",
+			"Duration of the event handler");
+	for (auto& event : mEvents)
+	{
+		auto& latency = event->handlerLatency;
+		if (latency.getCount() == 0)
+		{
+			continue;
+		}
+
+		std::string labels = model + ",event=\"" + escapeLabel(event->name)
+				+ "\"";
+
+		// Buckets of the histogram which end below the bound
+		// (accurate to the precision of the histogram)
+		size_t bucket = 0;
+		uint64_t cumulated = 0;
+		for (uint64_t bound : latencyBounds)
+		{
+			while (bucket < LatencyHistogram::NUM_BUCKETS
+					&& LatencyHistogram::getUpperBound(bucket) <= bound)
+			{
+				cumulated += latency.getBucketCount(bucket++);
+			}
+			text.append("fraser_handler_latency_seconds_bucket{").append(
+					labels).append(",le=\"").append(toSeconds(bound)).append(
+					"\"} ").append(std::to_string(cumulated)).append("\n");
+		}
+
+		text.append("fraser_handler_latency_seconds_bucket{").append(labels).append(
+				",le=\"+Inf\"} ").append(std::to_string(latency.getCount())).append(
+				"\n");
+		text.append("fraser_handler_latency_seconds_sum{").append(labels).append(
+				"} ").append(toSeconds(latency.getSum())).append("\n");
+		text.append("fraser_handler_latency_seconds_count{").append(labels).append(
+				"} ").append(std::to_string(latency.getCount())).append("\n");
+	}
+
+	appendHeader(text, "fraser_queue_depth", "gauge",
+			"Number of events in a queue of the model");
+	for (auto gauge : mGauges)
+	{
+		text.append("fraser_queue_depth{").append(model).append(",queue=\"").append(
+				escapeLabel(gauge->getName())).append("\"} ").append(
+				std::to_string(gauge->get())).append("\n");
+	}
+
+	appendHeader(text, "fraser_queue_depth_max", "gauge",
+			"Maximum number of events in a queue of the model");
+	for (auto gauge : mGauges)
+	{
+		text.append("fraser_queue_depth_max{").append(model).append(
+				",queue=\"").append(escapeLabel(gauge->getName())).append(
+				"\"} ").append(std::to_string(gauge->getMax())).append("\n");
+	}
+
+	// Heap allocations of the event handling path (steady-state cycles)
+	if (mAllocationMonitor != nullptr)
+	{
+		const struct
+		{
+			const char* name;
+			const char* type;
+			const char* help;
+			uint64_t value;
+		} allocations[] =
+		{
+		{ "fraser_heap_allocations_total", "counter",
+				"Heap allocations of the event handler",
+				mAllocationMonitor->getSteadyStateAllocations() },
+		{ "fraser_handler_cycles_total", "counter",
+				"Event handler cycles after the warm-up phase",
+				mAllocationMonitor->getSteadyStateCycles() },
+		{ "fraser_heap_allocations_per_cycle", "gauge",
+				"Heap allocations of the latest event handler cycle",
+				mAllocationMonitor->getLastCycleAllocations() },
+		{ "fraser_heap_allocations_per_cycle_max", "gauge",
+				"Maximum heap allocations of an event handler cycle",
+				mAllocationMonitor->getMaxAllocationsPerCycle() } };
+
+		for (auto& family : allocations)
+		{
+			appendHeader(text, family.name, family.type, family.help);
+			text.append(family.name).append("{").append(model).append(
+					"} ").append(std::to_string(family.value)).append("\n");
+		}
+	}
+
+	return text;
+}
+
+bool ModelMetrics::writePrometheusFile() const
+{
+	if (mPrometheusFile.empty())
+	{
+		return false;
+	}
+
+	std::string text = toPrometheus();
+	std::string tempFile = mPrometheusFile + ".tmp";
+
+	std::FILE* file = std::fopen(tempFile.c_str(), "w");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	bool written = std::fwrite(text.data(), 1, text.size(), file)
+			== text.size();
+	written = std::fclose(file) == 0 && written;
+
+	return written && std::rename(tempFile.c_str(), mPrometheusFile.c_str()) == 0;
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef METRICS_MODELMETRICS_H_
+#define METRICS_MODELMETRICS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/utility/string_view.hpp>
+
+#include "metrics/AllocationCounter.h"
+#include "metrics/LatencyHistogram.h"
+
+// Lock-free event counter
+class Counter
+{
+public:
+	void add(uint64_t value = 1)
+	{
+		mValue.fetch_add(value, std::memory_order_relaxed);
+	}
+
+	uint64_t get() const
+	{
+		return mValue.load(std::memory_order_relaxed);
+	}
+
+private:
+	std::atomic<uint64_t> mValue
+	{ 0 };
+};
+
+// Current value and maximum of a queue depth (or similar)
+class Gauge
+{
+public:
+	Gauge(std::string name) :
+			mName(name)
+	{
+	}
+
+	void set(uint64_t value)
+	{
+		mValue.store(value, std::memory_order_relaxed);
+
+		uint64_t max = mMax.load(std::memory_order_relaxed);
+		while (value > max
+				&& !mMax.compare_exchange_weak(max, value,
+						std::memory_order_relaxed))
+		{
+		}
+	}
+
+	uint64_t get() const
+	{
+		return mValue.load(std::memory_order_relaxed);
+	}
+
+	uint64_t getMax() const
+	{
+		return mMax.load(std::memory_order_relaxed);
+	}
+
+	const std::string& getName() const
+	{
+		return mName;
+	}
+
+private:
+	std::string mName;
+	std::atomic<uint64_t> mValue
+	{ 0 };
+	std::atomic<uint64_t> mMax
+	{ 0 };
+};
+
+// Metrics of a model: number and payload bytes (event name and event data)
+// of the received and published events, latency of the event handler per
+// received event, the depth of the model queues and the heap allocations of
+// the event handling path.
+// The metrics of an event are registered by the model thread when the event
+// is seen the first time, the values can be read by any thread.
+class ModelMetrics
+{
+public:
+	struct EventMetrics
+	{
+		EventMetrics(boost::string_view eventName) :
+				name(eventName.data(), eventName.size())
+		{
+		}
+
+		const std::string name;
+		Counter received;
+		Counter receivedBytes;
+		Counter published;
+		Counter publishedBytes;
+		LatencyHistogram handlerLatency;
+	};
+
+	ModelMetrics(std::string modelName);
+
+	ModelMetrics(const ModelMetrics&) = delete;
+	ModelMetrics& operator=(const ModelMetrics&) = delete;
+
+	EventMetrics& getEvent(boost::string_view eventName);
+
+	// The gauge has to live as long as the metrics (e.g. model member)
+	void addGauge(Gauge& gauge)
+	{
+		mGauges.push_back(&gauge);
+	}
+
+	// The monitor has to live as long as the metrics (e.g. model member), its
+	// values are read by the model thread (reports of the run loop)
+	void setAllocationMonitor(const AllocationMonitor& monitor)
+	{
+		mAllocationMonitor = &monitor;
+	}
+
+	// Returns the histogram of the event handler
+	LatencyHistogram& recordReceived(boost::string_view eventName,
+			size_t bytes)
+	{
+		EventMetrics& event = getEvent(eventName);
+		event.received.add();
+		event.receivedBytes.add(bytes);
+		return event.handlerLatency;
+	}
+
+	void recordPublished(boost::string_view eventName, size_t bytes)
+	{
+		EventMetrics& event = getEvent(eventName);
+		event.published.add();
+		event.publishedBytes.add(bytes);
+	}
+
+	// Periodic reports (0: disabled) and Prometheus text file (empty: none)
+	void setReportInterval(uint32_t milliseconds);
+	void setPrometheusFile(std::string filePath)
+	{
+		mPrometheusFile = filePath;
+	}
+	bool isReportDue();
+
+	// Payload of the stats topic: MODEL event=NAME rx=.. ...; one line per
+	// event, latencies in microseconds
+	std::string getSummary() const;
+
+	// Prometheus text exposition format
+	std::string toPrometheus() const;
+
+	// Written to a temporary file and renamed (the Prometheus node exporter
+	// never reads a partially written file)
+	bool writePrometheusFile() const;
+
+private:
+	std::string mModelName;
+
+	// Sorted by name, the lookup does not allocate memory
+	std::vector<std::unique_ptr<EventMetrics>> mEvents;
+	std::vector<Gauge*> mGauges;
+	const AllocationMonitor* mAllocationMonitor = nullptr;
+
+	std::chrono::steady_clock::duration mReportInterval;
+	std::chrono::steady_clock::time_point mNextReport;
+	std::string mPrometheusFile;
+};
+
+#endif /* METRICS_MODELMETRICS_H_ */
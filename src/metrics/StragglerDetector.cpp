@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include "StragglerDetector.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+// Ticks which are not reported by all models are finished, if more ticks
+// are open (e.g. a report was dropped)
+#define MAX_OPEN_TICKS 16
+
+StragglerDetector::StragglerDetector(zmq::context_t& ctx, size_t window) :
+		mSocket(ctx, ZMQ_PULL), mBound(false), mWindow(std::max<size_t>(window,
+				1)), mNumTicks(0)
+{
+	mSocket.setsockopt(ZMQ_LINGER, 0);
+}
+
+bool StragglerDetector::bind(const std::string& port)
+{
+	if (port.empty())
+	{
+		return false;
+	}
+
+	try
+	{
+		mSocket.bind("tcp://*:" + port);
+	} catch (zmq::error_t& e)
+	{
+		return false;
+	}
+
+	mBound = true;
+	return true;
+}
+
+void StragglerDetector::beginTick(uint64_t simTime)
+{
+	getTick(simTime).begin = TickReporter::getRealTime();
+	finishTicks();
+}
+
+void StragglerDetector::receiveReports()
+{
+	if (!mBound)
+	{
+		return;
+	}
+
+	while (mSocket.recv(&mMessage, ZMQ_DONTWAIT))
+	{
+		if (mMessage.size() < sizeof(TickReport))
+		{
+			continue;
+		}
+
+		TickReport report;
+		std::memcpy(&report, mMessage.data(), sizeof(TickReport));
+		addReport(
+				boost::string_view(
+						static_cast<const char*>(mMessage.data())
+								+ sizeof(TickReport),
+						mMessage.size() - sizeof(TickReport)), report);
+	}
+
+	finishTicks();
+}
+
+void StragglerDetector::addReport(boost::string_view modelName,
+		const TickReport& report)
+{
+	size_t model = getModel(modelName);
+
+	// Reports of finished ticks are too late for the critical path
+	if (!mTicks.empty() && report.simTime < mTicks.front().simTime)
+	{
+		return;
+	}
+
+	getTick(report.simTime).reports.emplace_back(model, report);
+}
+
+void StragglerDetector::setExpectedModels(
+		const std::vector<std::string>& modelNames)
+{
+	mExpectedModels.clear();
+	for (auto& modelName : modelNames)
+	{
+		mExpectedModels.push_back(getModel(modelName));
+	}
+
+	// Left models do not block the open ticks
+	finishTicks();
+}
+
+size_t StragglerDetector::getModel(boost::string_view modelName)
+{
+	for (size_t i = 0; i < mModels.size(); i++)
+	{
+		if (mModels[i].name == modelName)
+		{
+			return i;
+		}
+	}
+
+	ModelStatistics statistics = ModelStatistics();
+	statistics.name.assign(modelName.data(), modelName.size());
+	mModels.push_back(statistics);
+	return mModels.size() - 1;
+}
+
+StragglerDetector::Tick& StragglerDetector::getTick(uint64_t simTime)
+{
+	// Ticks are ordered by their simulation time
+	auto tick = std::find_if(mTicks.begin(), mTicks.end(),
+			[simTime](const Tick& openTick)
+			{
+				return openTick.simTime >= simTime;
+			});
+
+	if (tick == mTicks.end() || tick->simTime != simTime)
+	{
+		Tick newTick;
+		newTick.simTime = simTime;
+		newTick.begin = 0;
+		tick = mTicks.insert(tick, newTick);
+	}
+	return *tick;
+}
+
+bool StragglerDetector::isComplete(const Tick& tick) const
+{
+	for (auto model : mExpectedModels)
+	{
+		if (std::find_if(tick.reports.begin(), tick.reports.end(),
+				[model](const std::pair<size_t, TickReport>& report)
+				{
+					return report.first == model;
+				}) == tick.reports.end())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void StragglerDetector::finishTicks()
+{
+	// Complete ticks (all expected models reported) are finished in order
+	while (!mTicks.empty()
+			&& (isComplete(mTicks.front()) || mTicks.size() > MAX_OPEN_TICKS))
+	{
+		if (mTicks.front().reports.empty() && mTicks.size() <= MAX_OPEN_TICKS)
+		{
+			break;
+		}
+
+		finishTick(mTicks.front());
+		mTicks.pop_front();
+	}
+}
+
+void StragglerDetector::finishTick(const Tick& tick)
+{
+	if (tick.reports.empty())
+	{
+		return;
+	}
+
+	// Without the begin of the tick the lags are relative to the first model
+	uint64_t begin = tick.begin;
+	if (begin == 0)
+	{
+		begin = std::min_element(tick.reports.begin(), tick.reports.end(),
+				[](const std::pair<size_t, TickReport>& a,
+						const std::pair<size_t, TickReport>& b)
+				{
+					return a.second.completed < b.second.completed;
+				})->second.completed;
+	}
+
+	size_t straggler = tick.reports.front().first;
+	uint64_t latest = 0;
+	for (auto& report : tick.reports)
+	{
+		auto& statistics = mModels[report.first];
+		uint64_t lag =
+				report.second.completed > begin ?
+						report.second.completed - begin : 0;
+
+		statistics.ticks++;
+		statistics.lagSum += lag;
+		statistics.lagMax = std::max(statistics.lagMax, lag);
+		statistics.busySum += report.second.busy;
+
+		if (report.second.completed >= latest)
+		{
+			latest = report.second.completed;
+			straggler = report.first;
+		}
+	}
+
+	mModels[straggler].critical++;
+	mModels[straggler].recentCritical++;
+	mRecentCritical.push_back(straggler);
+	if (mRecentCritical.size() > mWindow)
+	{
+		mModels[mRecentCritical.front()].recentCritical--;
+		mRecentCritical.pop_front();
+	}
+
+	mNumTicks++;
+}
+
+std::string StragglerDetector::getSummary() const
+{
+	std::vector<const ModelStatistics*> models;
+	for (auto& statistics : mModels)
+	{
+		models.push_back(&statistics);
+	}
+	std::stable_sort(models.begin(), models.end(),
+			[](const ModelStatistics* a, const ModelStatistics* b)
+			{
+				return a->critical > b->critical;
+			});
+
+	std::string summary;
+	char line[320];
+	for (auto statistics : models)
+	{
+		uint64_t ticks = std::max<uint64_t>(statistics->ticks, 1);
+		std::snprintf(line, sizeof(line),
+				"stragglers model=%s ticks=%" PRIu64 " critical=%" PRIu64 " share=%.1f%% recent_share=%.1f%% mean_lag_us=%.1f max_lag_us=%.1f mean_busy_us=%.1f\n",
+				statistics->name.c_str(), statistics->ticks,
+				statistics->critical,
+				100.0 * statistics->critical / std::max<uint64_t>(mNumTicks, 1),
+				100.0 * statistics->recentCritical
+						/ std::max<size_t>(mRecentCritical.size(), 1),
+				statistics->lagSum / 1e3 / ticks, statistics->lagMax / 1e3,
+				statistics->busySum / 1e3 / ticks);
+		summary.append(line);
+	}
+
+	// Without the last line break
+	if (!summary.empty())
+	{
+		summary.pop_back();
+	}
+	return summary;
+}
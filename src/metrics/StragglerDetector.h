@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef METRICS_STRAGGLERDETECTOR_H_
+#define METRICS_STRAGGLERDETECTOR_H_
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+#include <boost/utility/string_view.hpp>
+#include <zmq.hpp>
+
+#include "metrics/TickReporter.h"
+
+// Critical path of the ticks (simulation model): The models report the
+// completion of every tick (see TickReporter), the model which completed a
+// tick last is its straggler. The lag of a model is the time from the
+// begin of the tick (published by the simulation model) to its completion.
+// The statistics are kept over all ticks and over a window of the latest
+// ticks (recent share of the critical path).
+class StragglerDetector
+{
+public:
+	StragglerDetector(zmq::context_t& ctx, size_t window = 1000);
+
+	bool bind(const std::string& port);
+
+	// The simulation model published the tick (SimTimeChanged or horizon)
+	void beginTick(uint64_t simTime);
+
+	// Receives all pending reports without blocking
+	void receiveReports();
+
+	void addReport(boost::string_view modelName, const TickReport& report);
+
+	// Models which report every tick (e.g. from the model list of the
+	// configuration server), a tick is complete if all of them reported
+	void setExpectedModels(const std::vector<std::string>& modelNames);
+
+	uint64_t getNumberOfTicks() const
+	{
+		return mNumTicks;
+	}
+
+	// One line per model, sorted by the number of critical ticks
+	std::string getSummary() const;
+
+private:
+	struct ModelStatistics
+	{
+		std::string name;
+		uint64_t ticks;
+		uint64_t critical;
+		uint64_t recentCritical;
+		uint64_t lagSum;
+		uint64_t lagMax;
+		uint64_t busySum;
+	};
+
+	struct Tick
+	{
+		uint64_t simTime;
+		uint64_t begin; // 0: the begin is unknown
+		std::vector<std::pair<size_t, TickReport>> reports;
+	};
+
+	size_t getModel(boost::string_view modelName);
+	Tick& getTick(uint64_t simTime);
+	bool isComplete(const Tick& tick) const;
+	void finishTicks();
+	void finishTick(const Tick& tick);
+
+	zmq::socket_t mSocket;
+	bool mBound;
+	zmq::message_t mMessage;
+
+	std::vector<ModelStatistics> mModels;
+	std::vector<size_t> mExpectedModels;
+	std::deque<Tick> mTicks; // Open ticks (oldest first)
+	std::deque<size_t> mRecentCritical;
+	size_t mWindow;
+	uint64_t mNumTicks;
+};
+
+#endif /* METRICS_STRAGGLERDETECTOR_H_ */
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef METRICS_TICKREPORTER_H_
+#define METRICS_TICKREPORTER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <zmq.hpp>
+
+// Tick report of a model (followed by the model name): simulation time of
+// the tick, completion time (realtime clock in ns, comparable between
+// synchronized hosts) and the busy time of the model in the tick
+struct TickReport
+{
+	uint64_t simTime;
+	uint64_t completed;
+	uint64_t busy;
+};
+
+// Reports the completion of the ticks to the simulation model (see
+// StragglerDetector). The reports are pushed without blocking and dropped
+// if the simulation model does not receive them.
+class TickReporter
+{
+public:
+	TickReporter(zmq::context_t& ctx, std::string modelName) :
+			mModelName(modelName), mSocket(ctx, ZMQ_PUSH), mConnected(false), mTickBegin(
+					0)
+	{
+		mSocket.setsockopt(ZMQ_LINGER, 0);
+		mSocket.setsockopt(ZMQ_SNDHWM, 1000);
+	}
+
+	// Empty port: reports are disabled
+	bool connect(const std::string& ip, const std::string& port)
+	{
+		if (port.empty())
+		{
+			return true;
+		}
+
+		try
+		{
+			mSocket.connect("tcp://" + ip + ":" + port);
+		} catch (zmq::error_t& e)
+		{
+			return false;
+		}
+
+		mConnected = true;
+		return true;
+	}
+
+	// The model received the event which starts the tick
+	void beginTick()
+	{
+		mTickBegin = getMonotonicTime();
+	}
+
+	// The model completed the tick (e.g. before the barrier)
+	void report(uint64_t simTime)
+	{
+		if (!mConnected)
+		{
+			return;
+		}
+
+		TickReport report;
+		report.simTime = simTime;
+		report.completed = getRealTime();
+		report.busy = mTickBegin > 0 ? getMonotonicTime() - mTickBegin : 0;
+		mTickBegin = 0;
+
+		zmq::message_t message(sizeof(TickReport) + mModelName.size());
+		std::memcpy(message.data(), &report, sizeof(TickReport));
+		std::memcpy(static_cast<char*>(message.data()) + sizeof(TickReport),
+				mModelName.data(), mModelName.size());
+		mSocket.send(message, ZMQ_DONTWAIT);
+	}
+
+	static uint64_t getRealTime()
+	{
+		return uint64_t(
+				std::chrono::duration_cast<std::chrono::nanoseconds>(
+						std::chrono::system_clock::now().time_since_epoch()).count());
+	}
+
+private:
+	static uint64_t getMonotonicTime()
+	{
+		return uint64_t(
+				std::chrono::duration_cast<std::chrono::nanoseconds>(
+						std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	std::string mModelName;
+	zmq::socket_t mSocket;
+	bool mConnected;
+	uint64_t mTickBegin;
+};
+
+#endif /* METRICS_TICKREPORTER_H_ */
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef PDES_CONSERVATIVESYNCHRONIZER_H_
+#define PDES_CONSERVATIVESYNCHRONIZER_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/serialization/nvp.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/utility/string_view.hpp>
+
+// Conservative parallel discrete-event execution (Chandy-Misra-Bryant).
+//
+// The simulation model publishes a horizon ("SimTimeHorizon") instead of
+// every single time step. Each input channel (a model from the dependencies
+// of the model) promises with a "NullMessage" that it will not publish
+// events with a timestamp lower than the promised time. Events up to the
+// minimum of all promises and the horizon are safe and are processed in
+// timestamp order; all other events are buffered.
+//
+// The model itself promises its local time plus its lookahead, i.e. events
+// which are published as reaction to an event at time t get at least the
+// timestamp t + lookahead. The lookahead has to be greater than zero if the
+// dependencies contain cycles, otherwise the models block each other.
+template<typename ID>
+class ConservativeSynchronizer
+{
+public:
+	struct PendingEvent
+	{
+		uint64_t timestamp;
+		uint64_t sequence;
+		ID id;
+
+		template<typename Archive>
+		void serialize(Archive& archive, const unsigned int)
+		{
+			archive & boost::serialization::make_nvp("Timestamp", timestamp);
+			archive & boost::serialization::make_nvp("Sequence", sequence);
+			archive & boost::serialization::make_nvp("ID", id);
+		}
+	};
+
+	ConservativeSynchronizer(uint64_t lookahead = 0) :
+			mLookahead(lookahead)
+	{
+	}
+
+	void setLookahead(uint64_t lookahead)
+	{
+		mLookahead = lookahead;
+	}
+
+	uint64_t getLookahead() const
+	{
+		return mLookahead;
+	}
+
+	void addChannel(const std::string& sourceModel)
+	{
+		mChannels.push_back(std::make_pair(sourceModel, uint64_t(0)));
+	}
+
+	// The promises of a channel are monotonic, older null messages are ignored
+	void updateChannel(boost::string_view sourceModel, uint64_t promise)
+	{
+		for (auto& channel : mChannels)
+		{
+			if (boost::string_view(channel.first) == sourceModel)
+			{
+				channel.second = std::max(channel.second, promise);
+				break;
+			}
+		}
+	}
+
+	// Conservative mode of the hosts-config file: the events are buffered
+	// before the first horizon arrives (the subscriber fair-queues the
+	// publishers, hence the events of other models can arrive earlier)
+	void activate()
+	{
+		mActive = true;
+	}
+
+	// The first horizon activates the conservative mode as well
+	void setHorizon(uint64_t horizon)
+	{
+		mActive = true;
+		mHorizon = horizon;
+		mHorizonReached = false;
+	}
+
+	bool isActive() const
+	{
+		return mActive;
+	}
+
+	uint64_t getHorizon() const
+	{
+		return mHorizon;
+	}
+
+	uint64_t getSafeTime() const
+	{
+		uint64_t safeTime = mHorizon;
+		for (auto& channel : mChannels)
+		{
+			safeTime = std::min(safeTime, channel.second);
+		}
+		return safeTime;
+	}
+
+	void bufferEvent(ID id, uint64_t timestamp)
+	{
+		mPendingEvents.push_back(PendingEvent
+		{ timestamp, mSequence++, id });
+		std::push_heap(mPendingEvents.begin(), mPendingEvents.end(), Later());
+	}
+
+	size_t getNumberOfPendingEvents() const
+	{
+		return mPendingEvents.size();
+	}
+
+	// Returns the next buffered event, if it is safe to process it
+	bool popSafeEvent(PendingEvent& event)
+	{
+		if (mPendingEvents.empty()
+				|| mPendingEvents.front().timestamp > getSafeTime())
+		{
+			return false;
+		}
+
+		event = mPendingEvents.front();
+		std::pop_heap(mPendingEvents.begin(), mPendingEvents.end(), Later());
+		mPendingEvents.pop_back();
+		return true;
+	}
+
+	// Advances the local time to the safe time.
+	// Returns true if the promise of the model changed (a null message is due).
+	bool advanceLocalTime()
+	{
+		uint64_t safeTime = getSafeTime();
+
+		if (safeTime > mLocalTime || !mPromised)
+		{
+			mLocalTime = std::max(mLocalTime, safeTime);
+			mPromised = true;
+			return true;
+		}
+		return false;
+	}
+
+	uint64_t getLocalTime() const
+	{
+		return mLocalTime;
+	}
+
+	uint64_t getPromise() const
+	{
+		return mLocalTime + mLookahead;
+	}
+
+	// Returns true once per horizon, when the local time reached the horizon
+	bool reachedHorizon()
+	{
+		if (mActive && !mHorizonReached && mLocalTime >= mHorizon)
+		{
+			mHorizonReached = true;
+			return true;
+		}
+		return false;
+	}
+
+	// Buffered events beyond the horizon (savepoints of the model)
+	template<typename Archive>
+	void serialize(Archive& archive, const unsigned int)
+	{
+		archive & boost::serialization::make_nvp("Sequence", mSequence);
+		archive
+				& boost::serialization::make_nvp("PendingEvents",
+						mPendingEvents);
+	}
+
+private:
+	struct Later
+	{
+		bool operator()(const PendingEvent& lhs, const PendingEvent& rhs) const
+		{
+			if (lhs.timestamp != rhs.timestamp)
+			{
+				return lhs.timestamp > rhs.timestamp;
+			}
+			return lhs.sequence > rhs.sequence;
+		}
+	};
+
+	uint64_t mLookahead;
+	uint64_t mLocalTime = 0;
+	uint64_t mHorizon = 0;
+	uint64_t mSequence = 0;
+	bool mActive = false;
+	bool mPromised = false;
+	bool mHorizonReached = true;
+
+	std::vector<std::pair<std::string, uint64_t>> mChannels;
+	// Heap of the buffered events (earliest first)
+	std::vector<PendingEvent> mPendingEvents;
+};
+
+#endif /* PDES_CONSERVATIVESYNCHRONIZER_H_ */
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef PERSISTENCE_LAZYSAVEPOINTSTATE_H_
+#define PERSISTENCE_LAZYSAVEPOINTSTATE_H_
+
+#include <istream>
+#include <string>
+#include <boost/archive/archive_exception.hpp>
+#include <boost/archive/xml_iarchive.hpp>
+#include <boost/serialization/nvp.hpp>
+
+#include "persistence/SavepointStream.h"
+
+// Large state of a model, decoded on its first use: loadState only maps the
+// region of the model in the savepoint container (header and index are the
+// only data read before the savepoint barrier) and the kernel reads the
+// region ahead while the federation restores. The model calls load before
+// it accesses the state.
+//
+//   if (!mPendingState.open(filePath, mName)) { ... eager restore ... }
+//   ...
+//   if (mPendingState.isPending()) mPendingState.load("EventSet", mEventSet);
+class LazySavepointState
+{
+public:
+	// False if the state is not in a region of a container (savepoint
+	// directory, overflow file)
+	bool open(const std::string& savepointPath, const std::string& modelName)
+	{
+		close();
+		if (!SavepointContainer::isContainer(savepointPath)
+				|| !mContainer.open(savepointPath)
+				|| !mContainer.findRegion(modelName, mRegion))
+		{
+			close();
+			return false;
+		}
+
+		mModelName = modelName;
+		mContainer.prefetch(mRegion);
+		return true;
+	}
+
+	bool isPending() const
+	{
+		return mContainer.isOpen();
+	}
+
+	// Releases the mapping (archive exception if the region was changed
+	// since the commit)
+	template<typename T>
+	void load(const char* name, T& state)
+	{
+		load([name, &state](boost::archive::xml_iarchive& ia)
+		{
+			ia >> boost::serialization::make_nvp(name, state);
+		});
+	}
+
+	// State of several parts: loadArchive(boost::archive::xml_iarchive&)
+	template<typename LoadArchive>
+	void load(LoadArchive loadArchive)
+	{
+		boost::string_view region;
+		bool intact = mContainer.getRegion(mModelName, region);
+		if (!intact)
+		{
+			close();
+			throw boost::archive::archive_exception(
+					boost::archive::archive_exception::input_stream_error);
+		}
+
+		try
+		{
+			SavepointRegionBuffer buffer;
+			buffer.setRegion(region);
+			std::istream stream(&buffer);
+			boost::archive::xml_iarchive ia(stream, boost::archive::no_header);
+			loadArchive(ia);
+
+		} catch (boost::archive::archive_exception&)
+		{
+			close();
+			throw;
+		}
+		close();
+	}
+
+	void close()
+	{
+		mContainer.close();
+		mRegion = boost::string_view();
+	}
+
+private:
+	SavepointContainer mContainer;
+	boost::string_view mRegion;
+	std::string mModelName;
+};
+
+#endif /* PERSISTENCE_LAZYSAVEPOINTSTATE_H_ */
@@ -0,0 +1,403 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include "SavepointContainer.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "utilities/Hash.h"
+
+// Size of the header, the index starts behind it
+#define HEADER_SIZE 512
+#define PAGE_SIZE 4096
+
+static_assert(sizeof(SavepointContainer::Header) <= HEADER_SIZE,
+		"The header fits into one sector");
+static_assert(sizeof(SavepointContainer::IndexEntry) == 96,
+		"Fixed size of the index entries");
+
+namespace
+{
+const char magic[8] =
+{ 'F', 'R', 'S', 'A', 'V', 'E', 'P', 'T' };
+
+uint64_t alignToPage(uint64_t size)
+{
+	return (size + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+}
+
+bool readAll(int fd, void* data, size_t size, off_t offset)
+{
+	char* next = static_cast<char*>(data);
+	while (size > 0)
+	{
+		ssize_t read = pread(fd, next, size, offset);
+		if (read < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (read <= 0)
+		{
+			return false;
+		}
+		next += read;
+		size -= size_t(read);
+		offset += read;
+	}
+	return true;
+}
+
+bool writeAll(int fd, const void* data, size_t size, off_t offset)
+{
+	const char* next = static_cast<const char*>(data);
+	while (size > 0)
+	{
+		ssize_t written = pwrite(fd, next, size, offset);
+		if (written < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (written <= 0)
+		{
+			return false;
+		}
+		next += written;
+		size -= size_t(written);
+		offset += written;
+	}
+	return true;
+}
+
+bool hasName(const SavepointContainer::IndexEntry& entry,
+		boost::string_view modelName)
+{
+	return modelName.size() < sizeof(entry.name)
+			&& std::strncmp(entry.name, modelName.data(), modelName.size()) == 0
+			&& entry.name[modelName.size()] == '\0';
+}
+
+// The index entries as written by the models
+uint64_t hashIndex(const SavepointContainer::IndexEntry* entries,
+		uint32_t numRegions)
+{
+	return Hash::fnv1a(reinterpret_cast<const char*>(entries),
+			numRegions * sizeof(SavepointContainer::IndexEntry));
+}
+
+// The overflow file is durable before the model passes the barrier, hence
+// before the simulation model commits the header
+bool writeFile(const std::string& filePath, const std::string& data)
+{
+	int fd = ::open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+			0644);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	bool written = writeAll(fd, data.data(), data.size(), 0)
+			&& fsync(fd) == 0;
+	::close(fd);
+	return written;
+}
+}
+
+bool SavepointContainer::isContainer(const std::string& path)
+{
+	std::string suffix = getSuffix();
+	return path.size() > suffix.size()
+			&& path.compare(path.size() - suffix.size(), suffix.size(), suffix)
+					== 0;
+}
+
+bool SavepointContainer::create(const std::string& path, uint64_t simTime,
+		const std::vector<std::string>& modelNames, uint64_t regionSize)
+{
+	// Names which do not fit into the index use the overflow file
+	std::vector<IndexEntry> entries;
+	for (auto& modelName : modelNames)
+	{
+		IndexEntry entry = IndexEntry();
+		if (modelName.size() < sizeof(entry.name))
+		{
+			modelName.copy(entry.name, modelName.size());
+			entries.push_back(entry);
+		}
+	}
+
+	Header header = Header();
+	std::memcpy(header.magic, magic, sizeof(magic));
+	header.version = 1;
+	header.state = WRITING;
+	header.simTime = simTime;
+	header.numRegions = uint32_t(entries.size());
+	header.regionsOffset = alignToPage(
+			HEADER_SIZE + entries.size() * sizeof(IndexEntry));
+	header.regionSize = alignToPage(regionSize);
+
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		entries[i].offset = header.regionsOffset + i * header.regionSize;
+		entries[i].capacity = header.regionSize;
+	}
+
+	int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+			0644);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	// The regions are holes until the models write their states
+	bool created = writeAll(fd, &header, sizeof(header), 0)
+			&& (entries.empty()
+					|| writeAll(fd, entries.data(),
+							entries.size() * sizeof(IndexEntry), HEADER_SIZE))
+			&& ftruncate(fd,
+					off_t(header.regionsOffset
+							+ entries.size() * header.regionSize)) == 0;
+	::close(fd);
+	return created;
+}
+
+bool SavepointContainer::writeRegion(const std::string& path,
+		boost::string_view modelName, const std::string& data)
+{
+	int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	Header header;
+	std::vector<IndexEntry> entries;
+	bool valid = readAll(fd, &header, sizeof(header), 0)
+			&& std::memcmp(header.magic, magic, sizeof(magic)) == 0
+			&& header.state == WRITING;
+	if (valid)
+	{
+		entries.resize(header.numRegions);
+		valid = entries.empty()
+				|| readAll(fd, entries.data(),
+						entries.size() * sizeof(IndexEntry), HEADER_SIZE);
+	}
+
+	if (!valid)
+	{
+		::close(fd);
+		return false;
+	}
+
+	size_t index = 0;
+	while (index < entries.size() && !hasName(entries[index], modelName))
+	{
+		index++;
+	}
+
+	// Models which joined after the creation or larger states
+	bool written = true;
+	IndexEntry* entry = index < entries.size() ? &entries[index] : nullptr;
+	if (entry == nullptr || data.size() > entry->capacity)
+	{
+		written = writeFile(getOverflowFile(path, modelName), data);
+		if (entry != nullptr)
+		{
+			entry->flags = WRITTEN | OVERFLOW;
+		}
+	} else
+	{
+		written = writeAll(fd, data.data(), data.size(), off_t(entry->offset));
+		entry->flags = WRITTEN;
+	}
+
+	// Only the own index entry is written (the models write in parallel)
+	if (entry != nullptr)
+	{
+		entry->size = data.size();
+		entry->hash = Hash::fnv1a(data);
+		written = written
+				&& writeAll(fd, entry, sizeof(IndexEntry),
+						off_t(HEADER_SIZE + index * sizeof(IndexEntry)));
+	}
+
+	::close(fd);
+	return written;
+}
+
+bool SavepointContainer::commit(const std::string& path)
+{
+	int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	Header header;
+	std::vector<IndexEntry> entries;
+	bool committed = readAll(fd, &header, sizeof(header), 0)
+			&& std::memcmp(header.magic, magic, sizeof(magic)) == 0;
+	if (committed)
+	{
+		entries.resize(header.numRegions);
+		committed = entries.empty()
+				|| readAll(fd, entries.data(),
+						entries.size() * sizeof(IndexEntry), HEADER_SIZE);
+	}
+
+	// A model which did not write its state leaves the savepoint incomplete
+	// (it stays in the state WRITING and cannot be restored)
+	for (size_t i = 0; committed && i < entries.size(); i++)
+	{
+		committed = (entries[i].flags & WRITTEN) != 0;
+	}
+
+	// The regions of all models are durable before the header is written
+	committed = committed && fsync(fd) == 0;
+	if (committed)
+	{
+		header.state = COMMITTED;
+		header.indexHash = hashIndex(entries.data(), header.numRegions);
+		committed = writeAll(fd, &header, sizeof(header), 0) && fsync(fd) == 0;
+	}
+
+	::close(fd);
+	return committed;
+}
+
+SavepointContainer::SavepointContainer() :
+		mMap(nullptr), mSize(0)
+{
+}
+
+SavepointContainer::~SavepointContainer()
+{
+	close();
+}
+
+bool SavepointContainer::open(const std::string& path)
+{
+	close();
+
+	int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	struct stat status;
+	if (fstat(fd, &status) != 0 || size_t(status.st_size) < HEADER_SIZE)
+	{
+		::close(fd);
+		return false;
+	}
+
+	void* map = mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_SHARED,
+			fd, 0);
+	::close(fd);
+	if (map == MAP_FAILED)
+	{
+		return false;
+	}
+
+	mMap = map;
+	mSize = size_t(status.st_size);
+
+	// Only committed savepoints with the index of the commit are restored
+	const Header* header = getHeader();
+	const auto* entries = reinterpret_cast<const IndexEntry*>(
+			static_cast<const char*>(mMap) + HEADER_SIZE);
+	if (std::memcmp(header->magic, magic, sizeof(magic)) != 0
+			|| header->version != 1 || header->state != COMMITTED
+			|| HEADER_SIZE + header->numRegions * sizeof(IndexEntry) > mSize
+			|| hashIndex(entries, header->numRegions) != header->indexHash)
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+void SavepointContainer::close()
+{
+	if (mMap != nullptr)
+	{
+		munmap(mMap, mSize);
+		mMap = nullptr;
+		mSize = 0;
+	}
+}
+
+uint64_t SavepointContainer::getSimTime() const
+{
+	return isOpen() ? getHeader()->simTime : 0;
+}
+
+const SavepointContainer::IndexEntry* SavepointContainer::findEntry(
+		boost::string_view modelName) const
+{
+	const auto* entries = reinterpret_cast<const IndexEntry*>(
+			static_cast<const char*>(mMap) + HEADER_SIZE);
+	for (uint32_t i = 0; i < getHeader()->numRegions; i++)
+	{
+		if (hasName(entries[i], modelName))
+		{
+			return &entries[i];
+		}
+	}
+	return nullptr;
+}
+
+bool SavepointContainer::getRegion(boost::string_view modelName,
+		boost::string_view& region) const
+{
+	return findRegion(modelName, region)
+			&& Hash::fnv1a(region.data(), region.size())
+					== findEntry(modelName)->hash;
+}
+
+bool SavepointContainer::findRegion(boost::string_view modelName,
+		boost::string_view& region) const
+{
+	if (!isOpen())
+	{
+		return false;
+	}
+
+	const IndexEntry* entry = findEntry(modelName);
+	if (entry == nullptr || !(entry->flags & WRITTEN)
+			|| (entry->flags & OVERFLOW) || entry->size > entry->capacity
+			|| entry->offset + entry->size > mSize)
+	{
+		return false;
+	}
+
+	region = boost::string_view(static_cast<const char*>(mMap) + entry->offset,
+			entry->size);
+	return true;
+}
+
+void SavepointContainer::prefetch(boost::string_view region) const
+{
+	auto begin = reinterpret_cast<uintptr_t>(region.data()) / PAGE_SIZE
+			* PAGE_SIZE;
+	auto end = reinterpret_cast<uintptr_t>(region.data()) + region.size();
+	if (isOpen() && end > begin)
+	{
+		madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+	}
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef PERSISTENCE_SAVEPOINTCONTAINER_H_
+#define PERSISTENCE_SAVEPOINTCONTAINER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <boost/utility/string_view.hpp>
+
+// Savepoint of all models in a single file (PATH.fsp):
+//
+//   header    magic, state (writing or committed), simulation time, hash of
+//             the index (512 bytes)
+//   index     one entry per model: name, offset and capacity of the
+//             region, size and hash of the written state
+//   regions   page aligned, reserved for each model (sparse file)
+//
+// The simulation model creates the container, the models write their state
+// in parallel into their regions (pwrite) and update their index entries.
+// After the barrier, the simulation model commits the savepoint with one
+// header write (after a single fsync of the file). A state which does not
+// fit into its region is written to PATH.MODEL.config (flagged in the
+// index). The restore maps the container and hands each model its region.
+class SavepointContainer
+{
+public:
+	static const char* getSuffix()
+	{
+		return ".fsp";
+	}
+
+	static bool isContainer(const std::string& path);
+
+	// Reserves a region of regionSize bytes (rounded up to pages) per model
+	static bool create(const std::string& path, uint64_t simTime,
+			const std::vector<std::string>& modelNames, uint64_t regionSize);
+
+	// Region of the model or PATH.MODEL.config
+	static bool writeRegion(const std::string& path,
+			boost::string_view modelName, const std::string& data);
+
+	// Single atomic header write (after all models wrote their regions),
+	// false if a model of the index did not write its state
+	static bool commit(const std::string& path);
+
+	static std::string getOverflowFile(const std::string& path,
+			boost::string_view modelName)
+	{
+		return path + "." + std::string(modelName.data(), modelName.size())
+				+ ".config";
+	}
+
+	SavepointContainer();
+	~SavepointContainer();
+
+	SavepointContainer(const SavepointContainer&) = delete;
+	SavepointContainer& operator=(const SavepointContainer&) = delete;
+
+	// Maps a committed container (read only)
+	bool open(const std::string& path);
+	void close();
+
+	bool isOpen() const
+	{
+		return mMap != nullptr;
+	}
+
+	uint64_t getSimTime() const;
+
+	// False if the model is not part of the container or its state is in
+	// the overflow file (or was changed since the commit)
+	bool getRegion(boost::string_view modelName,
+			boost::string_view& region) const;
+
+	// Region without reading (and checking) the state
+	bool findRegion(boost::string_view modelName,
+			boost::string_view& region) const;
+
+	// Reads the region ahead (asynchronously)
+	void prefetch(boost::string_view region) const;
+
+	struct Header
+	{
+		char magic[8]; // FRSAVEPT
+		uint32_t version;
+		uint32_t state;
+		uint64_t simTime;
+		uint32_t numRegions;
+		uint32_t reserved;
+		uint64_t regionsOffset;
+		uint64_t regionSize;
+		uint64_t indexHash;
+	};
+
+	struct IndexEntry
+	{
+		char name[56];
+		uint32_t flags;
+		uint32_t reserved;
+		uint64_t offset;
+		uint64_t capacity;
+		uint64_t size;
+		uint64_t hash; // FNV-1a of the state
+	};
+
+	enum State : uint32_t
+	{
+		WRITING = 0, COMMITTED = 1
+	};
+
+	enum Flags : uint32_t
+	{
+		WRITTEN = 1, OVERFLOW = 2
+	};
+
+private:
+	const Header* getHeader() const
+	{
+		return static_cast<const Header*>(mMap);
+	}
+
+	const IndexEntry* findEntry(boost::string_view modelName) const;
+
+	void* mMap;
+	size_t mSize;
+};
+
+#endif /* PERSISTENCE_SAVEPOINTCONTAINER_H_ */
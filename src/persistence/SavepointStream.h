@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef PERSISTENCE_SAVEPOINTSTREAM_H_
+#define PERSISTENCE_SAVEPOINTSTREAM_H_
+
+#include <fstream>
+#include <istream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+
+#include "persistence/SavepointContainer.h"
+
+// Input buffer on a mapped region (read only)
+class SavepointRegionBuffer: public std::streambuf
+{
+public:
+	void setRegion(boost::string_view region)
+	{
+		char* begin = const_cast<char*>(region.data());
+		setg(begin, begin, begin + region.size());
+	}
+};
+
+// Streams of the archives of a model (saveState and loadState). The
+// savepoint path is a directory (PATH/NAME.config, e.g. the initial
+// configuration files) or a container (PATH.fsp, see SavepointContainer).
+class SavepointWriter
+{
+public:
+	SavepointWriter(const std::string& savepointPath,
+			const std::string& modelName) :
+			mSavepointPath(savepointPath), mModelName(modelName)
+	{
+	}
+
+	std::ostream& getStream()
+	{
+		return mStream;
+	}
+
+	// Writes the archive (after the archive is destroyed)
+	bool commit()
+	{
+		if (SavepointContainer::isContainer(mSavepointPath))
+		{
+			return SavepointContainer::writeRegion(mSavepointPath, mModelName,
+					mStream.str());
+		}
+
+		std::ofstream file(mSavepointPath + mModelName + ".config");
+		file << mStream.rdbuf();
+		return bool(file);
+	}
+
+private:
+	std::string mSavepointPath;
+	std::string mModelName;
+	std::ostringstream mStream;
+};
+
+class SavepointReader
+{
+public:
+	SavepointReader(const std::string& savepointPath,
+			const std::string& modelName) :
+			mStream(nullptr)
+	{
+		if (!SavepointContainer::isContainer(savepointPath))
+		{
+			openFile(savepointPath + modelName + ".config");
+			return;
+		}
+
+		// The archive reads the mapped region of the model (no copy)
+		boost::string_view region;
+		if (mContainer.open(savepointPath)
+				&& mContainer.getRegion(modelName, region))
+		{
+			mBuffer.setRegion(region);
+			mStream.rdbuf(&mBuffer);
+		} else if (mContainer.isOpen())
+		{
+			openFile(SavepointContainer::getOverflowFile(savepointPath,
+					modelName));
+		} else
+		{
+			mStream.setstate(std::ios::badbit);
+		}
+	}
+
+	// Not readable: the archive throws an archive exception
+	std::istream& getStream()
+	{
+		return mStream;
+	}
+
+private:
+	void openFile(const std::string& filePath)
+	{
+		mFile.open(filePath);
+		mStream.rdbuf(mFile.rdbuf());
+		if (!mFile.is_open())
+		{
+			mStream.setstate(std::ios::badbit);
+		}
+	}
+
+	SavepointContainer mContainer;
+	SavepointRegionBuffer mBuffer;
+	std::ifstream mFile;
+	std::istream mStream;
+};
+
+#endif /* PERSISTENCE_SAVEPOINTSTREAM_H_ */
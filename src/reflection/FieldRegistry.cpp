@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include "FieldRegistry.h"
+
+#include "utilities/Hash.h"
+
+namespace
+{
+template<typename T>
+void append(std::string& data, T value)
+{
+	data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+bool consume(const char*& data, const char* end, T& value)
+{
+	if (size_t(end - data) < sizeof(T))
+	{
+		return false;
+	}
+	std::memcpy(&value, data, sizeof(T));
+	data += sizeof(T);
+	return true;
+}
+
+// Count, hash and size of a field
+const size_t countSize = sizeof(uint32_t);
+const size_t entryHeaderSize = sizeof(uint64_t) + sizeof(uint32_t);
+}
+
+int FieldRegistry::find(boost::string_view name) const
+{
+	for (size_t i = 0; i < mEntries.size(); i++)
+	{
+		if (mEntries[i].name == name)
+		{
+			return int(i);
+		}
+	}
+	return -1;
+}
+
+bool FieldRegistry::getValueAsString(boost::string_view name,
+		std::string& value) const
+{
+	int index = find(name);
+	if (index < 0)
+	{
+		return false;
+	}
+	value = mEntries[index].toString(mEntries[index].field);
+	return true;
+}
+
+bool FieldRegistry::setValueFromString(boost::string_view name,
+		const std::string& value)
+{
+	int index = find(name);
+	if (index < 0)
+	{
+		return false;
+	}
+	return mEntries[index].fromString(mEntries[index].field, value);
+}
+
+size_t FieldRegistry::getBinarySize() const
+{
+	size_t size = countSize;
+	for (auto& entry : mEntries)
+	{
+		size += entryHeaderSize + entry.size;
+	}
+	return size;
+}
+
+void FieldRegistry::writeBinary(std::string& data) const
+{
+	size_t offset = data.size();
+	data.resize(offset + getBinarySize());
+
+	char* next = &data[offset];
+	uint32_t count = uint32_t(mEntries.size());
+	std::memcpy(next, &count, sizeof(count));
+	next += sizeof(count);
+
+	for (auto& entry : mEntries)
+	{
+		std::memcpy(next, &entry.hash, sizeof(entry.hash));
+		next += sizeof(entry.hash);
+		std::memcpy(next, &entry.size, sizeof(entry.size));
+		next += sizeof(entry.size);
+		entry.load(entry.field, next);
+		next += entry.size;
+	}
+}
+
+bool FieldRegistry::readBinary(const char* data, size_t size)
+{
+	const char* end = data + size;
+	uint32_t count;
+	if (!consume(data, end, count))
+	{
+		return false;
+	}
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint64_t hash;
+		uint32_t valueSize;
+		if (!consume(data, end, hash) || !consume(data, end, valueSize)
+				|| size_t(end - data) < valueSize)
+		{
+			return false;
+		}
+
+		// Usually the fields are in the same order
+		const Entry* entry = nullptr;
+		if (i < mEntries.size() && mEntries[i].hash == hash)
+		{
+			entry = &mEntries[i];
+		} else
+		{
+			for (auto& other : mEntries)
+			{
+				if (other.hash == hash)
+				{
+					entry = &other;
+					break;
+				}
+			}
+		}
+
+		// Unknown fields or fields with another type are skipped
+		if (entry != nullptr && entry->size == valueSize)
+		{
+			entry->store(entry->field, data);
+		}
+		data += valueSize;
+	}
+	return true;
+}
+
+void FieldRegistry::markClean()
+{
+	size_t size = 0;
+	for (auto& entry : mEntries)
+	{
+		entry.cleanOffset = size;
+		size += entry.size;
+	}
+
+	mClean.resize(size);
+	for (auto& entry : mEntries)
+	{
+		entry.load(entry.field, &mClean[entry.cleanOffset]);
+	}
+}
+
+bool FieldRegistry::isChanged(size_t index) const
+{
+	auto& entry = mEntries[index];
+	return !entry.equals(entry.field, &mClean[entry.cleanOffset]);
+}
+
+bool FieldRegistry::hasChanges() const
+{
+	for (size_t i = 0; i < mEntries.size(); i++)
+	{
+		if (isChanged(i))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+std::vector<std::string> FieldRegistry::getChangedFields() const
+{
+	std::vector<std::string> names;
+	for (size_t i = 0; i < mEntries.size(); i++)
+	{
+		if (isChanged(i))
+		{
+			names.push_back(mEntries[i].name);
+		}
+	}
+	return names;
+}
+
+void FieldRegistry::writeChanges(std::string& data) const
+{
+	size_t countOffset = data.size();
+	append(data, uint32_t(0));
+
+	uint32_t count = 0;
+	for (size_t i = 0; i < mEntries.size(); i++)
+	{
+		if (!isChanged(i))
+		{
+			continue;
+		}
+
+		auto& entry = mEntries[i];
+		append(data, entry.hash);
+		append(data, entry.size);
+		data.resize(data.size() + entry.size);
+		entry.load(entry.field, &data[data.size() - entry.size]);
+		count++;
+	}
+	std::memcpy(&data[countOffset], &count, sizeof(count));
+}
+
+uint64_t FieldRegistry::hashName(const std::string& name)
+{
+	return Hash::fnv1a(name);
+}
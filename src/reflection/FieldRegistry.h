@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef REFLECTION_FIELDREGISTRY_H_
+#define REFLECTION_FIELDREGISTRY_H_
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <boost/archive/xml_iarchive.hpp>
+#include <boost/archive/xml_oarchive.hpp>
+#include <boost/serialization/nvp.hpp>
+#include <boost/utility/string_view.hpp>
+
+#include "data-types/Field.h"
+
+// Fields of a model, declared once after the fields:
+//
+//   Field<uint32_t> mLookahead;
+//   FieldRegistry mFields { mLookahead };
+//
+// The functions of each field type are generated when the registry is
+// constructed: binary serialization (snapshots, savepoint files), boost XML
+// archives (one element per field, tagged with the field name), lookup by
+// name (values as strings, e.g. parameters) and change tracking.
+// The field names have to be unique and valid XML element names.
+class FieldRegistry
+{
+public:
+	template<typename ... T>
+	FieldRegistry(Field<T>&... fields)
+	{
+		mEntries.reserve(sizeof...(T));
+		int expand[] =
+		{ 0, (add(fields), 0)... };
+		(void) expand;
+		markClean();
+	}
+
+	// Points to the fields of its owner
+	FieldRegistry(const FieldRegistry&) = delete;
+	FieldRegistry& operator=(const FieldRegistry&) = delete;
+
+	size_t size() const
+	{
+		return mEntries.size();
+	}
+
+	const std::string& getName(size_t index) const
+	{
+		return mEntries[index].name;
+	}
+
+	// Index of the field (-1: unknown)
+	int find(boost::string_view name) const;
+
+	// False if the field is unknown or has another type
+	template<typename T>
+	bool getValue(boost::string_view name, T& value) const
+	{
+		int index = find(name);
+		if (index < 0 || mEntries[index].type != getTypeTag<T>())
+		{
+			return false;
+		}
+		value = static_cast<const Field<T>*>(mEntries[index].field)->getValue();
+		return true;
+	}
+
+	template<typename T>
+	bool setValue(boost::string_view name, const T& value)
+	{
+		int index = find(name);
+		if (index < 0 || mEntries[index].type != getTypeTag<T>())
+		{
+			return false;
+		}
+		static_cast<Field<T>*>(mEntries[index].field)->setValue(value);
+		return true;
+	}
+
+	// Values as text (e.g. parameters of the hosts-config file)
+	bool getValueAsString(boost::string_view name, std::string& value) const;
+	bool setValueFromString(boost::string_view name, const std::string& value);
+
+	// Binary format: COUNT (uint32), per field NAME-HASH (uint64), SIZE
+	// (uint32) and the value in the byte order of the host. Unknown fields
+	// are skipped, missing fields keep their value (e.g. older snapshots).
+	size_t getBinarySize() const;
+	void writeBinary(std::string& data) const;
+	bool readBinary(const char* data, size_t size);
+
+	// Changes since the last markClean (e.g. the last savepoint)
+	void markClean();
+	bool isChanged(size_t index) const;
+	bool hasChanges() const;
+	std::vector<std::string> getChangedFields() const;
+
+	// Binary format with the changed fields only (read by readBinary)
+	void writeChanges(std::string& data) const;
+
+	template<typename Archive>
+	void serialize(Archive& archive)
+	{
+		for (auto& entry : mEntries)
+		{
+			serializeEntry(archive, entry);
+		}
+	}
+
+private:
+	struct Entry
+	{
+		std::string name;
+		uint64_t hash;
+		void* field;
+		const void* type;
+		uint32_t size;
+		size_t cleanOffset;
+
+		void (*load)(const void* field, char* value);
+		void (*store)(void* field, const char* value);
+		bool (*equals)(const void* field, const char* value);
+		std::string (*toString)(const void* field);
+		bool (*fromString)(void* field, const std::string& value);
+		void (*saveXml)(boost::archive::xml_oarchive& archive,
+				const void* field, const char* tag);
+		void (*loadXml)(boost::archive::xml_iarchive& archive, void* field,
+				const char* tag);
+	};
+
+	template<typename T>
+	static const void* getTypeTag()
+	{
+		static const char tag = 0;
+		return &tag;
+	}
+
+	template<typename T>
+	void add(Field<T>& field)
+	{
+		static_assert(std::is_arithmetic<T>::value,
+				"The values are copied (binary) and parsed (text)");
+
+		Entry entry;
+		entry.name = field.getName();
+		entry.hash = hashName(entry.name);
+		entry.field = &field;
+		entry.type = getTypeTag<T>();
+		entry.size = sizeof(T);
+		entry.cleanOffset = 0;
+
+		entry.load = [](const void* field, char* value)
+		{
+			T fieldValue = static_cast<const Field<T>*>(field)->getValue();
+			std::memcpy(value, &fieldValue, sizeof(T));
+		};
+		entry.store = [](void* field, const char* value)
+		{
+			T fieldValue;
+			std::memcpy(&fieldValue, value, sizeof(T));
+			static_cast<Field<T>*>(field)->setValue(fieldValue);
+		};
+		entry.equals = [](const void* field, const char* value)
+		{
+			T fieldValue = static_cast<const Field<T>*>(field)->getValue();
+			return std::memcmp(&fieldValue, value, sizeof(T)) == 0;
+		};
+		entry.toString = [](const void* field)
+		{
+			return formatValue(static_cast<const Field<T>*>(field)->getValue());
+		};
+		entry.fromString = [](void* field, const std::string& text)
+		{
+			T value;
+			if (!parseValue(text, value))
+			{
+				return false;
+			}
+			static_cast<Field<T>*>(field)->setValue(value);
+			return true;
+		};
+		entry.saveXml = [](boost::archive::xml_oarchive& archive,
+				const void* field, const char* tag)
+		{
+			archive
+					<< boost::serialization::make_nvp(tag,
+							*static_cast<const Field<T>*>(field));
+		};
+		entry.loadXml = [](boost::archive::xml_iarchive& archive, void* field,
+				const char* tag)
+		{
+			archive
+					>> boost::serialization::make_nvp(tag,
+							*static_cast<Field<T>*>(field));
+		};
+
+		mEntries.push_back(entry);
+	}
+
+	void serializeEntry(boost::archive::xml_oarchive& archive,
+			const Entry& entry) const
+	{
+		entry.saveXml(archive, entry.field, entry.name.c_str());
+	}
+
+	void serializeEntry(boost::archive::xml_iarchive& archive,
+			const Entry& entry)
+	{
+		entry.loadXml(archive, entry.field, entry.name.c_str());
+	}
+
+	static uint64_t hashName(const std::string& name);
+
+	static std::string formatValue(bool value)
+	{
+		return value ? "true" : "false";
+	}
+
+	template<typename T>
+	static std::string formatValue(const T& value)
+	{
+		std::ostringstream text;
+		text.precision(std::numeric_limits<T>::max_digits10);
+		text << +value;
+		return text.str();
+	}
+
+	static bool parseValue(const std::string& text, bool& value)
+	{
+		if (text == "true" || text == "1")
+		{
+			value = true;
+		} else if (text == "false" || text == "0")
+		{
+			value = false;
+		} else
+		{
+			return false;
+		}
+		return true;
+	}
+
+	// Integers of any width (without wrap around) and floating points
+	template<typename T>
+	static bool parseValue(const std::string& text, T& value)
+	{
+		typename std::conditional<std::is_floating_point<T>::value, T,
+				typename std::conditional<std::is_signed<T>::value, long long,
+						unsigned long long>::type>::type parsed;
+		std::istringstream stream(text);
+		stream >> parsed;
+		if (stream.fail() || !stream.eof()
+				|| (!std::is_signed<T>::value && text.find('-') != text.npos)
+				|| parsed < std::numeric_limits<T>::lowest()
+				|| parsed > std::numeric_limits<T>::max())
+		{
+			return false;
+		}
+		value = T(parsed);
+		return true;
+	}
+
+	std::vector<Entry> mEntries;
+	std::string mClean; // Values at the last markClean
+};
+
+#endif /* REFLECTION_FIELDREGISTRY_H_ */
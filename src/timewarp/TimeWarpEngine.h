@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef TIMEWARP_TIMEWARPENGINE_H_
+#define TIMEWARP_TIMEWARPENGINE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Optimistic execution (Time Warp).
+//
+// Received events are processed immediately in timestamp order. Before an
+// event is processed, the state of the model is stored as in-memory snapshot
+// (same serialize() function as for the savepoints). If an event arrives
+// with a timestamp lower than an already processed event (straggler), the
+// model rolls back to the snapshot before the first affected event and
+// cancels the events it published since then with anti-messages.
+//
+// Every published event carries a unique message ID ("<model>#<sequence>")
+// as event data, anti-messages carry the ID of the cancelled event.
+//
+// The simulation model computes the global virtual time (GVT) from the
+// reports of all models. Events, snapshots and outputs older than the GVT
+// can never be rolled back and are removed (fossil collection).
+template<typename ID>
+class TimeWarpEngine
+{
+public:
+	typedef std::function<std::string()> SaveFunction;
+	typedef std::function<void(const std::string& snapshot)> RestoreFunction;
+	typedef std::function<
+			void(const std::string& eventName, uint64_t timestamp,
+					const std::string& messageID)> CancelFunction;
+
+	struct Statistics
+	{
+		uint64_t processedEvents = 0;
+		uint64_t rolledBackEvents = 0;
+		uint64_t rollbacks = 0;
+		uint64_t antiMessages = 0;
+		uint64_t committedEvents = 0;
+
+		double getRollbackRate() const
+		{
+			if (processedEvents == 0)
+			{
+				return 0.0;
+			}
+			return double(rolledBackEvents) / double(processedEvents);
+		}
+	};
+
+	TimeWarpEngine(std::string ownerName) :
+			mOwnerName(ownerName)
+	{
+	}
+
+	// The state of the model is stored before each processed event
+	void setSnapshotFunctions(SaveFunction save, RestoreFunction restore)
+	{
+		mSave = save;
+		mRestore = restore;
+	}
+
+	// Publishes the anti-message of a cancelled event
+	void setCancelFunction(CancelFunction cancel)
+	{
+		mCancel = cancel;
+	}
+
+	// The first horizon activates the optimistic mode
+	void setHorizon(uint64_t horizon)
+	{
+		mActive = true;
+		mHorizon = horizon;
+	}
+
+	bool isActive() const
+	{
+		return mActive;
+	}
+
+	void receive(ID id, uint64_t timestamp, const std::string& messageID)
+	{
+		Message message;
+		message.timestamp = timestamp;
+		message.sequence = mReceiveSequence++;
+		message.id = id;
+		message.messageID = messageID;
+
+		auto position = std::upper_bound(mMessages.begin(), mMessages.end(),
+				message, earlier);
+		size_t index = position - mMessages.begin();
+
+		if (index < mNumProcessed)
+		{
+			// Straggler
+			rollback(index);
+		}
+
+		mMessages.insert(mMessages.begin() + index, message);
+	}
+
+	void receiveAntiMessage(const std::string& messageID)
+	{
+		for (size_t index = 0; index < mMessages.size(); index++)
+		{
+			if (mMessages[index].messageID == messageID)
+			{
+				if (index < mNumProcessed)
+				{
+					rollback(index);
+				}
+
+				mMessages.erase(mMessages.begin() + index);
+				break;
+			}
+		}
+	}
+
+	// Processes all pending events up to the horizon in timestamp order
+	template<typename Handler>
+	void processEvents(Handler handler)
+	{
+		while (mNumProcessed < mMessages.size()
+				&& mMessages[mNumProcessed].timestamp <= mHorizon)
+		{
+			mCurrentMessage = mNumProcessed;
+			mMessages[mCurrentMessage].snapshot = mSave();
+
+			mNumProcessed++;
+			mStatistics.processedEvents++;
+
+			handler(mMessages[mCurrentMessage].id,
+					mMessages[mCurrentMessage].timestamp);
+		}
+	}
+
+	// Registers an event, which is published while processing an event.
+	// Returns the message ID, which has to be published as event data.
+	std::string recordOutput(const std::string& eventName, uint64_t timestamp)
+	{
+		std::string messageID = mOwnerName + "#"
+				+ std::to_string(mSendSequence++);
+
+		if (mCurrentMessage < mNumProcessed)
+		{
+			mMessages[mCurrentMessage].outputs.push_back(Output
+			{ eventName, timestamp, messageID });
+		}
+
+		mMinSentTimestamp = std::min(mMinSentTimestamp, timestamp);
+		return messageID;
+	}
+
+	// Earliest timestamp of an event which is not processed yet
+	// (horizon + 1, if all events up to the horizon are processed)
+	uint64_t getLocalVirtualTime() const
+	{
+		if (mNumProcessed < mMessages.size())
+		{
+			return std::min(mMessages[mNumProcessed].timestamp, mHorizon + 1);
+		}
+		return mHorizon + 1;
+	}
+
+	// Value of the GVT report: The local virtual time or the lowest timestamp
+	// of the events published since the last report (could be in transit)
+	uint64_t getReportTime()
+	{
+		uint64_t reportTime = std::min(getLocalVirtualTime(),
+				mMinSentTimestamp);
+		mMinSentTimestamp = std::numeric_limits<uint64_t>::max();
+		return reportTime;
+	}
+
+	void collectFossils(uint64_t gvt)
+	{
+		size_t committed = 0;
+		while (committed < mNumProcessed
+				&& mMessages[committed].timestamp < gvt)
+		{
+			committed++;
+		}
+
+		mMessages.erase(mMessages.begin(), mMessages.begin() + committed);
+		mNumProcessed -= committed;
+		mCurrentMessage = mNumProcessed;
+		mStatistics.committedEvents += committed;
+	}
+
+	const Statistics& getStatistics() const
+	{
+		return mStatistics;
+	}
+
+	std::string getSummary() const
+	{
+		return std::to_string(mStatistics.processedEvents)
+				+ " processed events, " + std::to_string(mStatistics.rollbacks)
+				+ " rollbacks, " + std::to_string(mStatistics.rolledBackEvents)
+				+ " rolled back events (rate "
+				+ std::to_string(mStatistics.getRollbackRate()) + "), "
+				+ std::to_string(mStatistics.antiMessages) + " anti-messages, "
+				+ std::to_string(mStatistics.committedEvents)
+				+ " committed events";
+	}
+
+private:
+	struct Output
+	{
+		std::string eventName;
+		uint64_t timestamp;
+		std::string messageID;
+	};
+
+	struct Message
+	{
+		uint64_t timestamp;
+		uint64_t sequence;
+		ID id;
+		std::string messageID;
+
+		// State before the event was processed and the events published
+		// while it was processed (only for processed events)
+		std::string snapshot;
+		std::vector<Output> outputs;
+	};
+
+	static bool earlier(const Message& lhs, const Message& rhs)
+	{
+		if (lhs.timestamp != rhs.timestamp)
+		{
+			return lhs.timestamp < rhs.timestamp;
+		}
+		return lhs.sequence < rhs.sequence;
+	}
+
+	void rollback(size_t index)
+	{
+		mRestore(mMessages[index].snapshot);
+
+		for (size_t i = index; i < mNumProcessed; i++)
+		{
+			for (auto& output : mMessages[i].outputs)
+			{
+				// Anti-messages could be in transit as well (GVT report)
+				mCancel(output.eventName, output.timestamp, output.messageID);
+				mMinSentTimestamp = std::min(mMinSentTimestamp,
+						output.timestamp);
+				mStatistics.antiMessages++;
+			}
+
+			mMessages[i].outputs.clear();
+			mMessages[i].snapshot.clear();
+		}
+
+		mStatistics.rollbacks++;
+		mStatistics.rolledBackEvents += mNumProcessed - index;
+		mNumProcessed = index;
+		mCurrentMessage = index;
+	}
+
+	std::string mOwnerName;
+	SaveFunction mSave;
+	RestoreFunction mRestore;
+	CancelFunction mCancel;
+
+	bool mActive = false;
+	uint64_t mHorizon = 0;
+	uint64_t mReceiveSequence = 0;
+	uint64_t mSendSequence = 0;
+	uint64_t mMinSentTimestamp = std::numeric_limits<uint64_t>::max();
+
+	// Sorted by timestamp, the first mNumProcessed messages are processed
+	std::vector<Message> mMessages;
+	size_t mNumProcessed = 0;
+	size_t mCurrentMessage = 0;
+
+	Statistics mStatistics;
+};
+
+#endif /* TIMEWARP_TIMEWARPENGINE_H_ */
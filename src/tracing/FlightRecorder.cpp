@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include "FlightRecorder.h"
+
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+
+static_assert(sizeof(FlightRecorder::Record) == 64,
+		"The records of the dump file have 64 bytes");
+
+namespace
+{
+// Recorder of the process (dumped by the signal handler)
+std::atomic<FlightRecorder*> activeRecorder(nullptr);
+
+const int dumpSignals[] =
+{ SIGINT, SIGTERM, SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT };
+
+struct sigaction previousActions[NSIG];
+
+uint64_t getClock(clockid_t clock)
+{
+	struct timespec time;
+	clock_gettime(clock, &time);
+	return uint64_t(time.tv_sec) * 1000000000 + uint64_t(time.tv_nsec);
+}
+
+bool writeAll(int fd, const void* data, size_t size)
+{
+	const char* next = static_cast<const char*>(data);
+	while (size > 0)
+	{
+		ssize_t written = write(fd, next, size);
+		if (written < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (written <= 0)
+		{
+			return false;
+		}
+		next += written;
+		size -= size_t(written);
+	}
+	return true;
+}
+
+void chainSignal(int signal, siginfo_t* info, void* context)
+{
+	const struct sigaction& previous = previousActions[signal];
+	if (previous.sa_flags & SA_SIGINFO)
+	{
+		previous.sa_sigaction(signal, info, context);
+	} else if (previous.sa_handler == SIG_DFL)
+	{
+		// Terminates the process (with a core dump of fatal signals) after
+		// the handler returns
+		sigaction(signal, &previous, nullptr);
+		raise(signal);
+	} else if (previous.sa_handler != SIG_IGN)
+	{
+		// e.g. the interrupt handler of the model (registerInterruptSignal)
+		previous.sa_handler(signal);
+	}
+}
+
+void handleDumpSignal(int signal, siginfo_t* info, void* context)
+{
+	int savedErrno = errno;
+
+	FlightRecorder* recorder = activeRecorder.load();
+	if (recorder != nullptr)
+	{
+		recorder->dump(signal);
+	}
+
+	chainSignal(signal, info, context);
+	errno = savedErrno;
+}
+}
+
+FlightRecorder::FlightRecorder(std::string modelName) :
+		mModelName(modelName), mCapacity(0), mWritten(0), mHeader()
+{
+}
+
+FlightRecorder::~FlightRecorder()
+{
+	FlightRecorder* recorder = this;
+	activeRecorder.compare_exchange_strong(recorder, nullptr);
+}
+
+void FlightRecorder::enable(size_t capacity, const std::string& dumpFile)
+{
+	mDumpFile = dumpFile;
+	mCapacity = 0;
+	mRecords.reset();
+
+	if (capacity == 0)
+	{
+		return;
+	}
+
+	size_t size = 1;
+	while (size < capacity)
+	{
+		size <<= 1;
+	}
+
+	// Records with sequence 0 are empty
+	mRecords.reset(new Record[size]());
+	mCapacity = size;
+
+	std::memcpy(mHeader.magic, "FRFLIGHT", sizeof(mHeader.magic));
+	mHeader.version = 1;
+	mHeader.recordSize = sizeof(Record);
+	mHeader.capacity = mCapacity;
+	mHeader.pid = int32_t(getpid());
+	mModelName.copy(mHeader.modelName, sizeof(mHeader.modelName) - 1);
+}
+
+void FlightRecorder::installSignalHandlers()
+{
+	if (mCapacity == 0)
+	{
+		return;
+	}
+
+	activeRecorder.store(this);
+
+	for (int signal : dumpSignals)
+	{
+		struct sigaction action;
+		std::memset(&action, 0, sizeof(action));
+		action.sa_sigaction = handleDumpSignal;
+		action.sa_flags = SA_SIGINFO;
+		sigemptyset(&action.sa_mask);
+
+		// Installed again (e.g. by the model of a branch): the handler
+		// chains to the handler before the first installation
+		struct sigaction previous;
+		sigaction(signal, &action, &previous);
+		if (!(previous.sa_flags & SA_SIGINFO)
+				|| previous.sa_sigaction != handleDumpSignal)
+		{
+			previousActions[signal] = previous;
+		}
+	}
+}
+
+bool FlightRecorder::dump(int32_t reason) const
+{
+	if (mCapacity == 0 || mDumpFile.empty())
+	{
+		return false;
+	}
+
+	DumpHeader header = mHeader;
+	header.written = mWritten.load(std::memory_order_relaxed);
+	header.reason = reason;
+	header.realTime = getClock(CLOCK_REALTIME);
+	header.monotonicTime = getClock(CLOCK_MONOTONIC);
+
+	int fd = open(mDumpFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+			0644);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	// Records are written as they are, incomplete ones have sequence 0
+	bool written = writeAll(fd, &header, sizeof(header))
+			&& writeAll(fd, mRecords.get(), mCapacity * sizeof(Record));
+	close(fd);
+	return written;
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef TRACING_FLIGHTRECORDER_H_
+#define TRACING_FLIGHTRECORDER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <boost/utility/string_view.hpp>
+
+#include "tracing/Tracer.h"
+
+// Flight recorder of a model: the latest received and published events and
+// the handler durations in a fixed-size ring buffer, which is always on.
+// Recording is lock-free and does not allocate memory. The ring buffer is
+// dumped to a binary file (DUMP-PATH/MODEL.flight, see
+// scripts/decode_flight.py) on SIGINT, SIGTERM, a fatal signal or a
+// critical simulation cycle. The dump is async-signal-safe.
+class FlightRecorder
+{
+public:
+	enum class Kind : uint8_t
+	{
+		RECEIVED = 1, PUBLISHED, HANDLER
+	};
+
+	// Reasons of a dump without a signal
+	enum Reason : int32_t
+	{
+		REQUESTED = 0, CRITICAL_SIM_CYCLE = -1
+	};
+
+	// 64 bytes, written as it is to the dump file
+	struct Record
+	{
+		std::atomic<uint64_t> sequence; // 0: empty or being written
+		uint64_t time; // ns of the monotonic clock
+		uint64_t simTime;
+		uint32_t value; // payload bytes or handler duration in ns
+		Kind kind;
+		uint8_t nameLength;
+		char name[34];
+	};
+
+	// File header (version 1), followed by the records of the ring buffer
+	struct DumpHeader
+	{
+		char magic[8]; // FRFLIGHT
+		uint32_t version;
+		uint32_t recordSize;
+		uint64_t capacity;
+		uint64_t written; // Number of records since the start
+		int32_t reason; // Signal number or Reason
+		int32_t pid;
+		uint64_t realTime; // ns of the realtime clock at the dump
+		uint64_t monotonicTime; // ns of the monotonic clock at the dump
+		char modelName[64];
+	};
+
+	FlightRecorder(std::string modelName);
+	~FlightRecorder();
+
+	FlightRecorder(const FlightRecorder&) = delete;
+	FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+	// Allocates the ring buffer (rounded up to a power of two, 0: disabled)
+	void enable(size_t capacity, const std::string& dumpFile);
+
+	bool isEnabled() const
+	{
+		return mCapacity > 0;
+	}
+
+	// Dumps the ring buffer on SIGINT, SIGTERM and fatal signals (one
+	// recorder per process). Has to be called after registerInterruptSignal,
+	// the previous handlers are called after the dump.
+	void installSignalHandlers();
+
+	void record(Kind kind, boost::string_view name, uint64_t simTime,
+			uint32_t value)
+	{
+		if (mCapacity == 0)
+		{
+			return;
+		}
+
+		uint64_t sequence = mWritten.fetch_add(1, std::memory_order_relaxed)
+				+ 1;
+		Record& record = mRecords[(sequence - 1) & (mCapacity - 1)];
+
+		// A dump during the write (signal) skips the record
+		record.sequence.store(0, std::memory_order_relaxed);
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+
+		record.time = Tracer::now();
+		record.simTime = simTime;
+		record.value = value;
+		record.kind = kind;
+		record.nameLength = uint8_t(
+				name.size() < sizeof(record.name) ?
+						name.size() : sizeof(record.name));
+		std::memcpy(record.name, name.data(), record.nameLength);
+
+		record.sequence.store(sequence, std::memory_order_release);
+	}
+
+	uint64_t getWritten() const
+	{
+		return mWritten.load(std::memory_order_relaxed);
+	}
+
+	// Async-signal-safe (open, write and close only)
+	bool dump(int32_t reason) const;
+
+private:
+	std::string mModelName;
+	std::string mDumpFile;
+	std::unique_ptr<Record[]> mRecords;
+	size_t mCapacity;
+	std::atomic<uint64_t> mWritten;
+	DumpHeader mHeader; // Prepared (the dump fills in the times)
+};
+
+// Records the received event and the duration of its handler
+class ScopedFlightRecord
+{
+public:
+	ScopedFlightRecord(FlightRecorder& recorder, boost::string_view name,
+			uint64_t simTime, size_t bytes) :
+			mRecorder(recorder), mName(name), mSimTime(simTime), mBegin(0)
+	{
+		if (mRecorder.isEnabled())
+		{
+			mRecorder.record(FlightRecorder::Kind::RECEIVED, mName, mSimTime,
+					uint32_t(bytes));
+			mBegin = Tracer::now();
+		}
+	}
+
+	~ScopedFlightRecord()
+	{
+		if (mRecorder.isEnabled())
+		{
+			uint64_t duration = Tracer::now() - mBegin;
+			mRecorder.record(FlightRecorder::Kind::HANDLER, mName, mSimTime,
+					uint32_t(duration < UINT32_MAX ? duration : UINT32_MAX));
+		}
+	}
+
+	ScopedFlightRecord(const ScopedFlightRecord&) = delete;
+	ScopedFlightRecord& operator=(const ScopedFlightRecord&) = delete;
+
+private:
+	FlightRecorder& mRecorder;
+	boost::string_view mName;
+	uint64_t mSimTime;
+	uint64_t mBegin;
+};
+
+#endif /* TRACING_FLIGHTRECORDER_H_ */
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include "Timeline.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+namespace
+{
+const char* getCategory(Timeline::Kind kind)
+{
+	switch (kind)
+	{
+	case Timeline::Kind::HANDLER:
+		return "handler";
+	case Timeline::Kind::PUBLISH:
+		return "publish";
+	case Timeline::Kind::SYNC:
+		return "sync";
+	case Timeline::Kind::TICK:
+		return "tick";
+	}
+	return "";
+}
+
+void appendEscaped(std::string& json, const char* text)
+{
+	for (; *text != '\0'; text++)
+	{
+		if (*text == '"' || *text == '\\')
+		{
+			json.push_back('\\');
+		}
+		json.push_back(uint8_t(*text) < 0x20 ? ' ' : *text);
+	}
+}
+}
+
+Timeline::Timeline(std::string modelName) :
+		mModelName(modelName), mNext(0), mSize(0), mOverwritten(0)
+{
+}
+
+void Timeline::enable(size_t capacity)
+{
+	mSpans.assign(std::max<size_t>(capacity, 1), Entry());
+	mNext = 0;
+	mSize = 0;
+	mOverwritten = 0;
+}
+
+void Timeline::record(Kind kind, boost::string_view name, uint64_t simTime,
+		uint64_t begin, uint64_t end)
+{
+	if (mSpans.empty())
+	{
+		return;
+	}
+
+	Entry& entry = mSpans[mNext];
+	entry.begin = begin;
+	entry.duration = end >= begin ? end - begin : 0;
+	entry.simTime = simTime;
+	entry.kind = kind;
+
+	// Long names are truncated
+	size_t length = std::min(name.size(), sizeof(entry.name) - 1);
+	std::memcpy(entry.name, name.data(), length);
+	entry.name[length] = '\0';
+
+	mNext = (mNext + 1) % mSpans.size();
+	if (mSize < mSpans.size())
+	{
+		mSize++;
+	} else
+	{
+		mOverwritten++;
+	}
+}
+
+std::string Timeline::toChromeTrace() const
+{
+	// Oldest span first
+	std::vector<const Entry*> spans;
+	spans.reserve(mSize);
+	size_t first = (mNext + mSpans.size() - mSize) % std::max<size_t>(
+			mSpans.size(), 1);
+	for (size_t i = 0; i < mSize; i++)
+	{
+		spans.push_back(&mSpans[(first + i) % mSpans.size()]);
+	}
+	std::stable_sort(spans.begin(), spans.end(),
+			[](const Entry* a, const Entry* b)
+			{
+				return a->begin < b->begin;
+			});
+
+	unsigned pid = unsigned(getpid());
+	char buffer[160];
+	std::string json = "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"model\":\"";
+	appendEscaped(json, mModelName.c_str());
+	std::snprintf(buffer, sizeof(buffer),
+			"\",\"clock\":\"monotonic\",\"overwritten\":%" PRIu64 "},\n\"traceEvents\":[\n",
+			mOverwritten);
+	json.append(buffer);
+
+	// The process is named after the model
+	std::snprintf(buffer, sizeof(buffer),
+			"{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":0,\"args\":{\"name\":\"",
+			pid);
+	json.append(buffer);
+	appendEscaped(json, mModelName.c_str());
+	json.append("\"}}");
+
+	for (auto span : spans)
+	{
+		json.append(",\n{\"name\":\"");
+		appendEscaped(json, span->name);
+
+		// Chrome traces are in microseconds
+		if (span->kind == Kind::PUBLISH)
+		{
+			std::snprintf(buffer, sizeof(buffer),
+					"\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"p\",\"ts\":%.3f",
+					getCategory(span->kind), double(span->begin) / 1000.0);
+		} else
+		{
+			std::snprintf(buffer, sizeof(buffer),
+					"\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f",
+					getCategory(span->kind), double(span->begin) / 1000.0,
+					double(span->duration) / 1000.0);
+		}
+		json.append(buffer);
+
+		std::snprintf(buffer, sizeof(buffer),
+				",\"pid\":%u,\"tid\":0,\"args\":{\"sim_time\":%" PRIu64 "}}",
+				pid, span->simTime);
+		json.append(buffer);
+	}
+
+	json.append("\n]}\n");
+	return json;
+}
+
+bool Timeline::writeChromeTrace(const std::string& filePath) const
+{
+	std::string json = toChromeTrace();
+
+	// Readers never see a partially written file
+	std::string tmpPath = filePath + ".tmp";
+	std::FILE* file = std::fopen(tmpPath.c_str(), "w");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	bool written = std::fwrite(json.data(), 1, json.size(), file)
+			== json.size();
+	written = std::fclose(file) == 0 && written;
+	return written && std::rename(tmpPath.c_str(), filePath.c_str()) == 0;
+}
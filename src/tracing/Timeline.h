@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef TRACING_TIMELINE_H_
+#define TRACING_TIMELINE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <boost/utility/string_view.hpp>
+
+#include "tracing/Tracer.h"
+
+// Timeline of a model: handler durations, published events and
+// synchronization phases with their simulation time. The spans are kept in
+// a ring buffer (the latest spans overwrite the oldest ones) and exported
+// in the Chrome trace event format (chrome://tracing, ui.perfetto.dev).
+// The files of all models are merged by scripts/merge_traces.py.
+// Recording does not allocate memory, the timeline is used by the model
+// thread only.
+class Timeline
+{
+public:
+	enum class Kind : uint8_t
+	{
+		HANDLER, PUBLISH, SYNC, TICK
+	};
+
+	Timeline(std::string modelName);
+
+	// Allocates the ring buffer (disabled before)
+	void enable(size_t capacity = 1 << 16);
+
+	bool isEnabled() const
+	{
+		return !mSpans.empty();
+	}
+
+	// Span with a duration (begin and end in ns of the monotonic clock)
+	void record(Kind kind, boost::string_view name, uint64_t simTime,
+			uint64_t begin, uint64_t end);
+
+	// Instant (e.g. a published event)
+	void mark(Kind kind, boost::string_view name, uint64_t simTime)
+	{
+		uint64_t now = Tracer::now();
+		record(kind, name, simTime, now, now);
+	}
+
+	size_t size() const
+	{
+		return mSize;
+	}
+
+	uint64_t getOverwritten() const
+	{
+		return mOverwritten;
+	}
+
+	// Chrome trace event JSON (spans in the order of their begin)
+	std::string toChromeTrace() const;
+	bool writeChromeTrace(const std::string& filePath) const;
+
+private:
+	struct Entry
+	{
+		uint64_t begin;
+		uint64_t duration;
+		uint64_t simTime;
+		Kind kind;
+		char name[39];
+	};
+
+	std::string mModelName;
+	std::vector<Entry> mSpans;
+	size_t mNext;
+	size_t mSize;
+	uint64_t mOverwritten;
+};
+
+// Records the duration of the scope (e.g. of an event handler)
+class ScopedSpan
+{
+public:
+	ScopedSpan(Timeline& timeline, Timeline::Kind kind,
+			boost::string_view name, uint64_t simTime) :
+			mTimeline(timeline), mKind(kind), mName(name), mSimTime(simTime), mBegin(
+					timeline.isEnabled() ? Tracer::now() : 0)
+	{
+	}
+
+	~ScopedSpan()
+	{
+		if (mTimeline.isEnabled())
+		{
+			mTimeline.record(mKind, mName, mSimTime, mBegin, Tracer::now());
+		}
+	}
+
+	ScopedSpan(const ScopedSpan&) = delete;
+	ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+private:
+	Timeline& mTimeline;
+	Timeline::Kind mKind;
+	boost::string_view mName;
+	uint64_t mSimTime;
+	uint64_t mBegin;
+};
+
+#endif /* TRACING_TIMELINE_H_ */
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include "Tracer.h"
+
+#include <chrono>
+#include <cinttypes>
+
+#include "utilities/Hash.h"
+
+Tracer::Tracer(std::string modelName) :
+		mModelName(modelName), mFile(nullptr), mSampling(1), mNumChains(0), mReceiveTime(
+				0)
+{
+	// The IDs of all models have to be unique
+	std::random_device device;
+	mRandom.seed(
+			Hash::fnv1a(mModelName) ^ now()
+					^ (uint64_t(device()) << 32 | device()));
+}
+
+Tracer::~Tracer()
+{
+	close();
+}
+
+bool Tracer::open(const std::string& filePath)
+{
+	close();
+
+	mFile = std::fopen(filePath.c_str(), "a");
+	if (mFile == nullptr)
+	{
+		return false;
+	}
+
+	std::setvbuf(mFile, nullptr, _IOFBF, 1 << 16);
+	return true;
+}
+
+void Tracer::close()
+{
+	if (mFile != nullptr)
+	{
+		std::fclose(mFile);
+		mFile = nullptr;
+	}
+}
+
+bool Tracer::startTrace()
+{
+	mCurrent = Span();
+	if (!isEnabled() || mNumChains++ % mSampling != 0)
+	{
+		return false;
+	}
+
+	mCurrent.traceId = createID();
+	return true;
+}
+
+void Tracer::endTrace()
+{
+	mCurrent = Span();
+}
+
+void Tracer::beginHandler(const event::Event* receivedEvent)
+{
+	mCurrent = Span();
+	if (!isEnabled() || receivedEvent->trace_id() == 0)
+	{
+		return;
+	}
+
+	mReceiveTime = now();
+	mCurrent.traceId = receivedEvent->trace_id();
+	mCurrent.spanId = receivedEvent->span_id();
+	mCurrent.parentId = receivedEvent->parent_id();
+	mCurrent.sendTime = receivedEvent->send_time();
+
+	auto eventName = receivedEvent->name();
+	if (eventName != nullptr)
+	{
+		mEventName.assign(eventName->c_str(), eventName->size());
+	} else
+	{
+		mEventName.clear();
+	}
+}
+
+void Tracer::endHandler()
+{
+	if (!isActive())
+	{
+		return;
+	}
+
+	uint64_t end = now();
+	std::fprintf(mFile,
+			"R %016" PRIx64 " %016" PRIx64 " %016" PRIx64 " %s %s %" PRIu64 " %" PRIu64 " %" PRIu64 "\n",
+			mCurrent.traceId, mCurrent.spanId, mCurrent.parentId,
+			mModelName.c_str(), mEventName.c_str(), mCurrent.sendTime,
+			mReceiveTime, end - mReceiveTime);
+
+	mCurrent = Span();
+}
+
+bool Tracer::isTracedEvent(boost::string_view eventName)
+{
+	return !eventName.starts_with("Log") && eventName != "Stats"
+			&& eventName != "NullMessage" && eventName != "LvtReport"
+			&& eventName != "AntiMessage";
+}
+
+Span Tracer::createSpan(boost::string_view eventName)
+{
+	// The received span is the parent of the published span
+	Span span;
+	span.traceId = mCurrent.traceId;
+	span.spanId = createID();
+	span.parentId = mCurrent.spanId;
+	span.sendTime = now();
+
+	std::fprintf(mFile,
+			"S %016" PRIx64 " %016" PRIx64 " %016" PRIx64 " %s %.*s %" PRIu64 "\n",
+			span.traceId, span.spanId, span.parentId, mModelName.c_str(),
+			int(eventName.size()), eventName.data(), span.sendTime);
+
+	return span;
+}
+
+uint64_t Tracer::now()
+{
+	return uint64_t(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint64_t Tracer::createID()
+{
+	uint64_t id;
+	do
+	{
+		id = mRandom();
+	} while (id == 0);
+	return id;
+}
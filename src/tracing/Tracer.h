@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef TRACING_TRACER_H_
+#define TRACING_TRACER_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <boost/utility/string_view.hpp>
+
+#include "resources/idl/event_generated.h"
+
+// Trace context of a published event
+struct Span
+{
+	uint64_t traceId = 0;
+	uint64_t spanId = 0;
+	uint64_t parentId = 0;
+	uint64_t sendTime = 0;
+};
+
+// End-to-end tracing of causal chains (e.g. FirstEvent -> SubsequentEvent
+// -> ReturnEvent). The root of a chain (e.g. an event of the queue) gets a
+// new trace ID, the events published by a handler of a traced event belong
+// to the same trace and refer to the received span as their parent.
+//
+// The sent and received spans are appended to the span file of the model
+// (TRACE-PATH/MODEL.spans), which is evaluated by scripts/trace_collector.py:
+//   S TRACE SPAN PARENT MODEL EVENT SEND-TIME
+//   R TRACE SPAN PARENT MODEL EVENT SEND-TIME RECEIVE-TIME HANDLER-TIME
+// The times are nanoseconds of the monotonic clock, which is shared by the
+// processes of a host (latencies between hosts include the clock offset).
+class Tracer
+{
+public:
+	Tracer(std::string modelName);
+	~Tracer();
+
+	Tracer(const Tracer&) = delete;
+	Tracer& operator=(const Tracer&) = delete;
+
+	bool open(const std::string& filePath);
+	void close();
+
+	bool isEnabled() const
+	{
+		return mFile != nullptr;
+	}
+
+	// Every n-th chain is traced (1: all chains)
+	void setSampling(uint32_t interval)
+	{
+		mSampling = interval > 0 ? interval : 1;
+	}
+
+	// Root of a causal chain: The events published until endTrace() belong
+	// to a new trace (if the chain is sampled)
+	bool startTrace();
+	void endTrace();
+
+	// Received event: The events published by the handler belong to the
+	// trace of the event (if it is traced)
+	void beginHandler(const event::Event* receivedEvent);
+	void endHandler();
+
+	bool isActive() const
+	{
+		return mCurrent.traceId != 0;
+	}
+
+	// Control events, log messages and metrics are not part of a chain
+	static bool isTracedEvent(boost::string_view eventName);
+
+	// Span of an event which is published now (only if isActive())
+	Span createSpan(boost::string_view eventName);
+
+	// Monotonic clock in nanoseconds
+	static uint64_t now();
+
+private:
+	uint64_t createID();
+
+	std::string mModelName;
+	std::FILE* mFile;
+	uint32_t mSampling;
+	uint64_t mNumChains;
+	std::mt19937_64 mRandom;
+
+	// Trace of the current handler (or root) and the received span
+	Span mCurrent;
+	uint64_t mReceiveTime;
+	std::string mEventName;
+};
+
+// Trace context of an event handler (end of the scope: end of the handler)
+class TraceScope
+{
+public:
+	TraceScope(Tracer& tracer, const event::Event* receivedEvent) :
+			mTracer(tracer)
+	{
+		mTracer.beginHandler(receivedEvent);
+	}
+
+	~TraceScope()
+	{
+		mTracer.endHandler();
+	}
+
+	TraceScope(const TraceScope&) = delete;
+	TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+	Tracer& mTracer;
+};
+
+#endif /* TRACING_TRACER_H_ */
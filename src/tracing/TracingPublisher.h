@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef TRACING_TRACINGPUBLISHER_H_
+#define TRACING_TRACINGPUBLISHER_H_
+
+#include <string>
+#include <utility>
+#include <boost/utility/string_view.hpp>
+#include <flatbuffers/flatbuffers.h>
+#include <flatbuffers/flexbuffers.h>
+#include <zmq.hpp>
+
+#include "metrics/MeteredPublisher.h"
+#include "tracing/Tracer.h"
+
+#include "resources/idl/event_generated.h"
+
+// Publisher which attaches the trace context to the events published
+// during a traced handler (or root, see Tracer). Traced events are built
+// here (with the trace fields) and sent as a buffer by the publisher,
+// all other events are published unchanged.
+class TracingPublisher: public MeteredPublisher
+{
+public:
+	TracingPublisher(zmq::context_t& ctx, ModelMetrics& metrics,
+			Tracer& tracer) :
+			MeteredPublisher(ctx, metrics), mTracer(tracer)
+	{
+	}
+
+	using MeteredPublisher::publishEvent;
+
+	template<typename Name, typename ... Args>
+	void publishEvent(Name&& name, uint64_t timestamp, Args&&... data)
+	{
+		boost::string_view eventName(name);
+		if (mTracer.isActive() && Tracer::isTracedEvent(eventName)
+				&& publishTraced(eventName, timestamp, data...))
+		{
+			return;
+		}
+
+		MeteredPublisher::publishEvent(std::forward<Name>(name), timestamp,
+				std::forward<Args>(data)...);
+	}
+
+private:
+	bool publishTraced(boost::string_view eventName, uint64_t timestamp)
+	{
+		buildEvent(eventName, timestamp, nullptr);
+		return true;
+	}
+
+	bool publishTraced(boost::string_view eventName, uint64_t timestamp,
+			const std::string& data)
+	{
+		boost::string_view payload(data);
+		buildEvent(eventName, timestamp, &payload);
+		return true;
+	}
+
+	bool publishTraced(boost::string_view eventName, uint64_t timestamp,
+			const char* data)
+	{
+		boost::string_view payload(data);
+		buildEvent(eventName, timestamp, &payload);
+		return true;
+	}
+
+	// Other event data is published without trace context
+	template<typename ... Data>
+	bool publishTraced(boost::string_view, uint64_t, const Data&...)
+	{
+		return false;
+	}
+
+	void buildEvent(boost::string_view eventName, uint64_t timestamp,
+			const boost::string_view* payload)
+	{
+		Span span = mTracer.createSpan(eventName);
+
+		mBuilder.Clear();
+		auto name = mBuilder.CreateString(eventName.data(), eventName.size());
+
+		// Same encoding of the event data as the publisher (flexbuffer string)
+		flatbuffers::Offset<flatbuffers::Vector<uint8_t>> eventData;
+		if (payload != nullptr)
+		{
+			mFlexBuilder.Clear();
+			mFlexBuilder.String(payload->data(), payload->size());
+			mFlexBuilder.Finish();
+			eventData = mBuilder.CreateVector(mFlexBuilder.GetBuffer());
+		}
+
+		event::EventBuilder eventBuilder(mBuilder);
+		eventBuilder.add_name(name);
+		eventBuilder.add_timestamp(timestamp);
+		if (payload != nullptr)
+		{
+			eventBuilder.add_event_data(eventData);
+		}
+		eventBuilder.add_trace_id(span.traceId);
+		eventBuilder.add_span_id(span.spanId);
+		eventBuilder.add_parent_id(span.parentId);
+		eventBuilder.add_send_time(span.sendTime);
+		mBuilder.Finish(eventBuilder.Finish());
+
+		recordPublished(eventName, timestamp,
+				eventName.size() + (payload != nullptr ? payload->size() : 0));
+
+		Publisher::publishEvent(std::string(eventName.data(), eventName.size()),
+				mBuilder.GetBufferPointer(), int(mBuilder.GetSize()));
+	}
+
+	Tracer& mTracer;
+	flatbuffers::FlatBufferBuilder mBuilder;
+	flexbuffers::Builder mFlexBuilder;
+};
+
+#endif /* TRACING_TRACINGPUBLISHER_H_ */
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef UTILITIES_EVENTNAMETABLE_H_
+#define UTILITIES_EVENTNAMETABLE_H_
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/utility/string_view.hpp>
+#include <flatbuffers/flatbuffers.h>
+
+// Maps the event names a model is interested in to model specific IDs.
+// The names are interned once (e.g. in the constructor of the model),
+// the lookup of a received name does not allocate memory.
+template<typename ID>
+class EventNameTable
+{
+public:
+	EventNameTable(ID unknownID) :
+			mUnknownID(unknownID)
+	{
+	}
+
+	void add(const std::string& name, ID id)
+	{
+		auto entry = std::lower_bound(mEntries.begin(), mEntries.end(), name,
+				compare);
+		mEntries.insert(entry, std::make_pair(name, id));
+	}
+
+	ID lookup(boost::string_view name) const
+	{
+		auto entry = std::lower_bound(mEntries.begin(), mEntries.end(), name,
+				compare);
+
+		if (entry != mEntries.end() && entry->first == name)
+		{
+			return entry->second;
+		}
+
+		return mUnknownID;
+	}
+
+	ID lookup(const flatbuffers::String* name) const
+	{
+		if (name == nullptr)
+		{
+			return mUnknownID;
+		}
+
+		return lookup(boost::string_view(name->c_str(), name->size()));
+	}
+
+	// All interned names (e.g. to subscribe to them)
+	std::vector<std::string> getNames() const
+	{
+		std::vector<std::string> names;
+		for (auto& entry : mEntries)
+		{
+			names.push_back(entry.first);
+		}
+		return names;
+	}
+
+private:
+	static bool compare(const std::pair<std::string, ID>& entry,
+			boost::string_view name)
+	{
+		return boost::string_view(entry.first) < name;
+	}
+
+	ID mUnknownID;
+	std::vector<std::pair<std::string, ID>> mEntries;
+};
+
+#endif /* UTILITIES_EVENTNAMETABLE_H_ */
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef UTILITIES_HASH_H_
+#define UTILITIES_HASH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 64 bit FNV-1a hash (not cryptographic, only used to detect changes)
+namespace Hash
+{
+inline uint64_t fnv1a(const char* data, size_t size,
+		uint64_t hash = 14695981039346656037ULL)
+{
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= static_cast<uint8_t>(data[i]);
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+inline uint64_t fnv1a(const std::string& data)
+{
+	return fnv1a(data.data(), data.size());
+}
+
+// Fixed length (16 digits)
+inline std::string toHex(uint64_t hash)
+{
+	static const char digits[] = "0123456789abcdef";
+
+	std::string hex(16, '0');
+	for (int i = 15; i >= 0; i--)
+	{
+		hex[i] = digits[hash & 0xf];
+		hash >>= 4;
+	}
+	return hex;
+}
+}
+
+#endif /* UTILITIES_HASH_H_ */
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef UTILITIES_MESSAGEBUFFER_H_
+#define UTILITIES_MESSAGEBUFFER_H_
+
+#include <cstdint>
+#include <string>
+#include <boost/utility/string_view.hpp>
+
+// Reusable buffer to compose (log) messages without temporary strings.
+// The capacity is reserved once, afterwards the buffer only allocates
+// if a message exceeds the reserved capacity.
+class MessageBuffer
+{
+public:
+	MessageBuffer(size_t capacity = 256)
+	{
+		mBuffer.reserve(capacity);
+	}
+
+	MessageBuffer& clear()
+	{
+		mBuffer.clear();
+		return *this;
+	}
+
+	MessageBuffer& append(boost::string_view text)
+	{
+		mBuffer.append(text.data(), text.size());
+		return *this;
+	}
+
+	MessageBuffer& append(uint64_t value)
+	{
+		char digits[20];
+		int pos = sizeof(digits);
+
+		do
+		{
+			digits[--pos] = static_cast<char>('0' + value % 10);
+			value /= 10;
+		} while (value != 0);
+
+		mBuffer.append(digits + pos, sizeof(digits) - pos);
+		return *this;
+	}
+
+	MessageBuffer& compose()
+	{
+		return *this;
+	}
+
+	// Appends the parts (strings and unsigned numbers) one after another
+	template<typename Part, typename ... Parts>
+	MessageBuffer& compose(const Part& part, const Parts&... parts)
+	{
+		append(part);
+		return compose(parts...);
+	}
+
+	const std::string& str() const
+	{
+		return mBuffer;
+	}
+
+private:
+	std::string mBuffer;
+};
+
+#endif /* UTILITIES_MESSAGEBUFFER_H_ */
@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2019, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2019, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include <ctime>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "logging/BinaryLogFormat.h"
+
+// Decodes binary log files (*.flog) of the logger
+namespace
+{
+void printRecord(const BinaryLogRecord& record, bool printSimTime)
+{
+	// Same format as the text log files
+	std::time_t second = std::time_t(record.wallTime / 1000000);
+	std::tm localTime;
+	localtime_r(&second, &localTime);
+
+	char timeStamp[48];
+	size_t length = std::strftime(timeStamp, sizeof(timeStamp),
+			"%Y-%b-%d %H:%M:%S", &localTime);
+	std::snprintf(timeStamp + length, sizeof(timeStamp) - length, ".%06u",
+			unsigned(record.wallTime % 1000000));
+
+	std::cout << "[" << timeStamp << "] ";
+	if (printSimTime)
+	{
+		std::cout << "[" << record.simTime << "] ";
+	}
+	std::cout << "[" << toString(record.severity) << "] " << record.message
+			<< "\n";
+}
+
+// Records of the logger instances (shards) are ordered by sim time
+// and then by wall time
+bool isLater(const BinaryLogRecord& a, const BinaryLogRecord& b)
+{
+	return a.simTime != b.simTime ? a.simTime > b.simTime :
+			a.wallTime > b.wallTime;
+}
+
+// Prints the records of all files as one time-ordered view. The files are
+// merged by their next record; within a file the sim time of records of
+// different models may go back a little, therefore the merged records pass
+// a reorder buffer of the given size.
+bool mergeFiles(std::vector<std::unique_ptr<BinaryLogReader>>& readers,
+		size_t window, bool printSimTime)
+{
+	struct Head
+	{
+		const BinaryLogRecord* record;
+		size_t reader;
+	};
+
+	auto laterHead = [](const Head& a, const Head& b)
+	{
+		return isLater(*a.record, *b.record);
+	};
+	std::priority_queue<Head, std::vector<Head>, decltype(laterHead)> heads(
+			laterHead);
+
+	std::priority_queue<BinaryLogRecord, std::vector<BinaryLogRecord>,
+			std::function<bool(const BinaryLogRecord&, const BinaryLogRecord&)>> pending(
+			isLater);
+
+	for (size_t i = 0; i < readers.size(); i++)
+	{
+		if (const BinaryLogRecord* record = readers[i]->next())
+		{
+			heads.push(Head { record, i });
+		}
+	}
+
+	while (!heads.empty())
+	{
+		Head head = heads.top();
+		heads.pop();
+		pending.push(*head.record);
+
+		// The record is valid until the next call of next()
+		if (const BinaryLogRecord* record = readers[head.reader]->next())
+		{
+			heads.push(Head { record, head.reader });
+		}
+
+		if (pending.size() > window)
+		{
+			printRecord(pending.top(), printSimTime);
+			pending.pop();
+		}
+	}
+
+	while (!pending.empty())
+	{
+		printRecord(pending.top(), printSimTime);
+		pending.pop();
+	}
+
+	bool complete = true;
+	for (auto& reader : readers)
+	{
+		complete = complete && reader->isComplete();
+	}
+	return complete;
+}
+
+void printHelp()
+{
+	std::cout << "<< Help >>" << std::endl;
+	std::cout << "fraser-logcat [OPTIONS] FILE... >> "
+			<< "Print the records of binary log files" << std::endl;
+	std::cout << "  --model NAME       >> only records of the model "
+			<< "(repeatable)" << std::endl;
+	std::cout << "  --severity LEVEL   >> only records with LEVEL or higher "
+			<< "(trace, debug, info, warning, error, fatal)" << std::endl;
+	std::cout << "  --from SIM-TIME    >> only records at or after SIM-TIME"
+			<< std::endl;
+	std::cout << "  --to SIM-TIME      >> only records at or before SIM-TIME"
+			<< std::endl;
+	std::cout << "  --sim-time         >> print the sim time of the records"
+			<< std::endl;
+	std::cout << "  --merge            >> print the records of all files "
+			<< "ordered by sim time and wall time (sharded logger)"
+			<< std::endl;
+	std::cout << "  --window N         >> size of the reorder buffer of "
+			<< "--merge (default: 100000 records)" << std::endl;
+	std::cout << "  --stats            >> print the number of read and "
+			<< "skipped blocks (stderr)" << std::endl;
+}
+}
+
+int main(int argc, const char * argv[])
+{
+	BinaryLogFilter filter;
+	std::vector<std::string> files;
+	bool printSimTime = false;
+	bool printStats = false;
+	bool merge = false;
+	size_t window = 100000;
+
+	try
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			std::string option = static_cast<std::string>(argv[i]);
+			bool hasValue = i + 1 < argc;
+
+			if (option == "--help")
+			{
+				printHelp();
+				return 0;
+			} else if (option == "--model" && hasValue)
+			{
+				filter.sources.insert(argv[++i]);
+			} else if (option == "--severity" && hasValue)
+			{
+				if (!parseSeverity(argv[++i], filter.minSeverity))
+				{
+					std::cout << " Invalid severity: --help" << std::endl;
+					return 1;
+				}
+			} else if (option == "--from" && hasValue)
+			{
+				filter.fromSimTime = std::stoull(argv[++i]);
+			} else if (option == "--to" && hasValue)
+			{
+				filter.toSimTime = std::stoull(argv[++i]);
+			} else if (option == "--sim-time")
+			{
+				printSimTime = true;
+			} else if (option == "--merge")
+			{
+				merge = true;
+			} else if (option == "--window" && hasValue)
+			{
+				window = std::stoull(argv[++i]);
+			} else if (option == "--stats")
+			{
+				printStats = true;
+			} else if (!option.empty() && option[0] != '-')
+			{
+				files.push_back(option);
+			} else
+			{
+				std::cout << " Invalid argument/s: --help" << std::endl;
+				return 1;
+			}
+		}
+	} catch (std::exception& e)
+	{
+		std::cout << " Invalid argument/s: --help" << std::endl;
+		return 1;
+	}
+
+	if (files.empty())
+	{
+		std::cout << " Invalid or missing argument/s: --help" << std::endl;
+		return 1;
+	}
+
+	int result = 0;
+	std::vector<std::unique_ptr<BinaryLogReader>> readers;
+	std::vector<std::string> readerFiles;
+	for (auto& file : files)
+	{
+		std::unique_ptr<BinaryLogReader> reader(new BinaryLogReader());
+		if (!reader->open(file))
+		{
+			std::cerr << file << ": Not a binary log file" << std::endl;
+			result = 1;
+			continue;
+		}
+		reader->setFilter(filter);
+		readers.push_back(std::move(reader));
+		readerFiles.push_back(file);
+	}
+
+	if (merge)
+	{
+		if (!mergeFiles(readers, window, printSimTime))
+		{
+			std::cerr << "Corrupt block" << std::endl;
+			result = 1;
+		}
+	}
+
+	for (size_t i = 0; i < readers.size(); i++)
+	{
+		auto& reader = *readers[i];
+		if (!merge)
+		{
+			while (const BinaryLogRecord* record = reader.next())
+			{
+				printRecord(*record, printSimTime);
+			}
+
+			if (!reader.isComplete())
+			{
+				std::cerr << readerFiles[i] << ": Corrupt block" << std::endl;
+				result = 1;
+			}
+		}
+
+		if (printStats)
+		{
+			std::cerr << readerFiles[i] << ": " << reader.getBlocksRead()
+					<< " blocks read, " << reader.getBlocksSkipped()
+					<< " blocks skipped"
+					<< (reader.hasIndex() ? "" : " (no index)") << std::endl;
+		}
+	}
+
+	std::cout.flush();
+	return result;
+}